@@ -0,0 +1,265 @@
+// SPI Benchmark - ESP32 Side
+// Sweeps SPI clock, bit width, transfer size and API path and prints one
+// CSV row per configuration, so runs can be diffed between library releases.
+//
+// Columns:
+//   path        single = transfer8/16/32 per word (CS per word)
+//               frame  = one Transaction, put8/16/32 per word
+//               burst  = transferBurst / transferBurst16 / transferBurst32
+//               async  = submit()/poll(), queue kept full
+//   width       word size in bits (async moves bytes and runs at 8 only)
+//   speed_hz    requested SPI clock
+//   size        bytes per transaction
+//   iters       transactions measured
+//   mbps        payload throughput, MB/s (10^6 bytes)
+//   p50/p90/p99/max_us  per-transaction latency (async: submit to callback)
+//   cpu_pct     share of wall time the caller spent inside library calls
+//
+// Data is not verified - load any bitstream (see platformio.ini).
+#include <Arduino.h>
+#include <SPI.h>
+#include <PapilioSPI.h>
+
+// SPI Configuration
+#define SPI_CLK   1
+#define SPI_MOSI  2
+#define SPI_MISO  4
+#define SPI_CS    3
+
+// =========================================================================
+// Sweep configuration
+// =========================================================================
+#define BENCH_MODE        SPI_MODE1
+#define BENCH_MAX_ITERS   64        // Latency samples per configuration
+#define BENCH_BUDGET_MS   200       // Stop a configuration after this long
+#define BENCH_MAX_WIRE_MS 1000      // Skip configurations slower than this per transaction
+
+static const uint32_t SPEEDS[] = { 100000, 250000, 500000, 1000000, 2000000,
+                                   4000000, 8000000, 16000000, 20000000 };
+static const uint8_t WIDTHS[] = { 8, 16, 32 };
+static const size_t SIZES[] = { 1, 4, 16, 64, 256, 1024, 4096, 16384, 65536 };
+static const size_t MAX_SIZE = 65536;
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+enum BenchPath { PATH_SINGLE, PATH_FRAME, PATH_BURST, PATH_ASYNC };
+static const char* PATH_NAMES[] = { "single", "frame", "burst", "async" };
+
+SPIClass fpgaSPI(HSPI);
+PapilioSPI spi;
+
+static uint8_t* txBuf;
+static uint8_t* rxBuf;
+
+// Per-configuration measurements (CPU cycles)
+static uint32_t samples[BENCH_MAX_ITERS];
+static int sampleCount;
+static uint32_t busyCycles;
+
+static inline uint32_t cycles() {
+  return ESP.getCycleCount();
+}
+
+static float cyclesToUs(uint32_t c) {
+  return (float)c / ESP.getCpuFreqMHz();
+}
+
+// =========================================================================
+// One transaction per path
+// =========================================================================
+static void runSingle(uint8_t width, size_t size) {
+  if (width == 8) {
+    for (size_t i = 0; i < size; i++) rxBuf[i] = spi.transfer8(txBuf[i]);
+  } else if (width == 16) {
+    uint16_t* tx = (uint16_t*)txBuf;
+    uint16_t* rx = (uint16_t*)rxBuf;
+    for (size_t i = 0; i < size / 2; i++) rx[i] = spi.transfer16(tx[i]);
+  } else {
+    uint32_t* tx = (uint32_t*)txBuf;
+    uint32_t* rx = (uint32_t*)rxBuf;
+    for (size_t i = 0; i < size / 4; i++) rx[i] = spi.transfer32(tx[i]);
+  }
+}
+
+static void runFrame(uint8_t width, size_t size) {
+  PapilioSPI::Transaction t(spi);
+  if (width == 8) {
+    for (size_t i = 0; i < size; i++) rxBuf[i] = t.put8(txBuf[i]);
+  } else if (width == 16) {
+    uint16_t* tx = (uint16_t*)txBuf;
+    uint16_t* rx = (uint16_t*)rxBuf;
+    for (size_t i = 0; i < size / 2; i++) rx[i] = t.put16(tx[i]);
+  } else {
+    uint32_t* tx = (uint32_t*)txBuf;
+    uint32_t* rx = (uint32_t*)rxBuf;
+    for (size_t i = 0; i < size / 4; i++) rx[i] = t.put32(tx[i]);
+  }
+}
+
+// Synchronous paths: every cycle of the transaction is spent in the library
+static int benchSync(BenchPath path, uint8_t width, size_t size) {
+  uint32_t budget = (uint32_t)BENCH_BUDGET_MS * 1000 * ESP.getCpuFreqMHz();
+  uint32_t begin = cycles();
+  int iters = 0;
+  
+  while (iters < BENCH_MAX_ITERS && (iters == 0 || cycles() - begin < budget)) {
+    uint32_t t0 = cycles();
+    if (path == PATH_SINGLE) {
+      runSingle(width, size);
+    } else if (path == PATH_FRAME) {
+      runFrame(width, size);
+    } else if (width == 16) {
+      spi.transferBurst16((const uint16_t*)txBuf, (uint16_t*)rxBuf, size / 2);
+    } else if (width == 32) {
+      spi.transferBurst32((const uint32_t*)txBuf, (uint32_t*)rxBuf, size / 4);
+    } else {
+      spi.transferBurst(txBuf, rxBuf, size);
+    }
+    uint32_t dt = cycles() - t0;
+    samples[sampleCount++] = dt;
+    busyCycles += dt;
+    iters++;
+  }
+  return iters;
+}
+
+// Async path: keep the queue full, latency is submit to callback
+struct AsyncSlot {
+  PapilioTransaction txn;
+  uint32_t submitted;
+};
+static AsyncSlot slots[PAPILIO_SPI_QUEUE_DEPTH];
+
+static void onAsyncDone(PapilioTransaction* txn) {
+  AsyncSlot* slot = (AsyncSlot*)txn->user;
+  if (sampleCount < BENCH_MAX_ITERS) {
+    samples[sampleCount++] = cycles() - slot->submitted;
+  }
+}
+
+static int benchAsync(size_t size) {
+  uint32_t budget = (uint32_t)BENCH_BUDGET_MS * 1000 * ESP.getCpuFreqMHz();
+  uint32_t begin = cycles();
+  int issued = 0;
+  
+  while (issued < BENCH_MAX_ITERS && (issued == 0 || cycles() - begin < budget)) {
+    if (spi.pending() < PAPILIO_SPI_QUEUE_DEPTH) {
+      AsyncSlot* slot = &slots[issued % PAPILIO_SPI_QUEUE_DEPTH];
+      slot->txn.txBuf = txBuf;
+      slot->txn.rxBuf = rxBuf;
+      slot->txn.len = size;
+      slot->txn.user = slot;
+      
+      uint32_t t0 = cycles();
+      slot->submitted = t0;
+      spi.submit(&slot->txn, onAsyncDone);
+      busyCycles += cycles() - t0;
+      issued++;
+    } else {
+      uint32_t t0 = cycles();
+      spi.poll();
+      busyCycles += cycles() - t0;
+      delayMicroseconds(1);  // Stand-in for application work
+    }
+  }
+  
+  uint32_t t0 = cycles();
+  spi.wait();
+  busyCycles += cycles() - t0;
+  return issued;
+}
+
+// =========================================================================
+// Reporting
+// =========================================================================
+static void sortSamples() {
+  for (int i = 1; i < sampleCount; i++) {
+    uint32_t v = samples[i];
+    int j = i - 1;
+    while (j >= 0 && samples[j] > v) {
+      samples[j + 1] = samples[j];
+      j--;
+    }
+    samples[j + 1] = v;
+  }
+}
+
+static float percentileUs(int pct) {
+  int idx = (sampleCount * pct + 99) / 100 - 1;
+  if (idx < 0) idx = 0;
+  return cyclesToUs(samples[idx]);
+}
+
+static void runConfig(BenchPath path, uint8_t width, uint32_t speed, size_t size) {
+  // Wire time alone, to skip hopeless combinations (64 KB at 100 kHz)
+  float wireMs = size * 8000.0f / speed;
+  if (wireMs > BENCH_MAX_WIRE_MS) {
+    Serial.printf("# skip %s,%u,%lu,%u (%.0f ms on the wire)\n",
+                  PATH_NAMES[path], width, (unsigned long)speed, (unsigned)size, wireMs);
+    return;
+  }
+  
+  spi.setSpeed(speed);
+  sampleCount = 0;
+  busyCycles = 0;
+  
+  uint32_t begin = cycles();
+  int iters = (path == PATH_ASYNC) ? benchAsync(size) : benchSync(path, width, size);
+  uint32_t wall = cycles() - begin;
+  
+  sortSamples();
+  float wallUs = cyclesToUs(wall);
+  float mbps = (float)size * iters / wallUs;  // bytes/us == MB/s
+  float cpu = 100.0f * busyCycles / wall;
+  
+  Serial.printf("%s,%u,%lu,%u,%d,%.4f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                PATH_NAMES[path], width, (unsigned long)speed, (unsigned)size, iters, mbps,
+                percentileUs(50), percentileUs(90), percentileUs(99),
+                cyclesToUs(samples[sampleCount - 1]), cpu);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  
+  txBuf = (uint8_t*)malloc(MAX_SIZE);
+  rxBuf = (uint8_t*)malloc(MAX_SIZE);
+  if (!txBuf || !rxBuf) {
+    Serial.println("# ERROR: out of memory");
+    while (1) delay(1000);
+  }
+  for (size_t i = 0; i < MAX_SIZE; i++) txBuf[i] = i & 0xFF;
+  
+  fpgaSPI.begin(SPI_CLK, SPI_MISO, SPI_MOSI, SPI_CS);
+  if (!spi.begin(&fpgaSPI, SPI_CS, 1000000, BENCH_MODE)) {
+    Serial.println("# ERROR: Failed to initialize SPI");
+    while (1) delay(1000);
+  }
+  
+  Serial.println("# papilio_spi_slave benchmark");
+  Serial.printf("# cpu_mhz=%lu queue_depth=%d\n",
+                (unsigned long)ESP.getCpuFreqMHz(), PAPILIO_SPI_QUEUE_DEPTH);
+  Serial.println("path,width,speed_hz,size,iters,mbps,p50_us,p90_us,p99_us,max_us,cpu_pct");
+  
+  for (size_t s = 0; s < COUNT_OF(SPEEDS); s++) {
+    for (int p = PATH_SINGLE; p <= PATH_ASYNC; p++) {
+      BenchPath path = (BenchPath)p;
+      for (size_t w = 0; w < COUNT_OF(WIDTHS); w++) {
+        uint8_t width = WIDTHS[w];
+        if (path == PATH_ASYNC && width != 8) continue;
+        
+        spi.setBitWidth(width);
+        for (size_t z = 0; z < COUNT_OF(SIZES); z++) {
+          if (SIZES[z] % (width / 8)) continue;  // Whole words only
+          runConfig(path, width, SPEEDS[s], SIZES[z]);
+        }
+      }
+    }
+  }
+  
+  Serial.println("# done");
+}
+
+void loop() {
+  delay(1000);
+}
@@ -1,10 +1,13 @@
 // BRAM Interface Example - FPGA Top Module
 // Demonstrates SPI slave with Block RAM (BRAM) memory access
 //
-// Protocol:
+// Protocol (see spi_bram_controller.v):
 //   - 0xFF: Reset address to 0 (write mode)
 //   - 0xFE: Enter read mode
+//   - 0xFD: Set address from the next byte (write mode)
 //   - Other bytes: Write to current address (auto-increment) or read in read mode
+//   - Whole blocks stream in one CS frame: [0xFD][ADDR][data...] or
+//     [0xFD][ADDR][0xFE][dummy...]
 //
 // Hardware: Gowin FPGA with 256-byte BRAM
 // Test: ESP32 writes data, reads back, verifies
@@ -33,93 +36,56 @@ module top (
     end
     
     // Configuration
-    localparam RX_FIFO_DEPTH = 256;
-    localparam TX_FIFO_DEPTH = 256;
     localparam MEM_DEPTH = 256;      // 256 bytes of BRAM
-    localparam ADDR_WIDTH = 8;       // 8-bit address for 256 bytes
     
     // SPI Slave signals
-    wire [7:0] rx_fifo_data;
-    wire rx_fifo_valid;
-    wire rx_fifo_ready;
-    wire [7:0] tx_fifo_data;
-    wire tx_fifo_valid;
-    wire tx_fifo_ready;
+    wire [7:0] rx_data;
+    wire rx_valid;
+    wire rx_ready;
+    wire [7:0] tx_data;
+    wire tx_valid;
+    wire tx_ready;
+    wire cs_active;
     
-    // SPI Slave with FIFO
-    spi_slave_fifo #(
-        .TRANSFER_WIDTH(8),
-        .RX_FIFO_DEPTH(RX_FIFO_DEPTH),
-        .TX_FIFO_DEPTH(TX_FIFO_DEPTH)
+    // SPI Slave - connected directly so the BRAM read register feeds MISO
+    spi_slave #(
+        .TRANSFER_WIDTH(8)
     ) spi_inst (
         .clk(clk),
-        .rst_n(!rst),
+        .rst(rst),
         
         .spi_sclk(spi_sclk),
         .spi_mosi(spi_mosi),
         .spi_miso(spi_miso),
         .spi_cs_n(spi_cs_n),
         
-        .rx_fifo_data(rx_fifo_data),
-        .rx_fifo_valid(rx_fifo_valid),
-        .rx_fifo_ready(rx_fifo_ready),
+        .rx_data(rx_data),
+        .rx_valid(rx_valid),
+        .rx_ready(rx_ready),
         
-        .tx_fifo_data(tx_fifo_data),
-        .tx_fifo_valid(tx_fifo_valid),
-        .tx_fifo_ready(tx_fifo_ready)
+        .tx_data(tx_data),
+        .tx_valid(tx_valid),
+        .tx_ready(tx_ready),
+        
+        .cs_active(cs_active)
     );
     
     // BRAM with auto-increment protocol
-    reg [7:0] memory [0:MEM_DEPTH-1];
-    reg [ADDR_WIDTH-1:0] address;
-    reg read_mode;
-    
-    // Initialize memory
-    integer init_i;
-    initial begin
-        for (init_i = 0; init_i < MEM_DEPTH; init_i = init_i + 1) begin
-            memory[init_i] = 0;
-        end
-    end
-    
-    // Address and mode control
-    always @(posedge clk or posedge rst) begin
-        if (rst) begin
-            address <= 0;
-            read_mode <= 0;
-        end else if (rx_fifo_valid && rx_fifo_ready) begin
-            if (rx_fifo_data == 8'hFF) begin
-                // 0xFF: Reset address to 0 (enter write mode)
-                address <= 0;
-                read_mode <= 0;
-            end else if (rx_fifo_data == 8'hFE) begin
-                // 0xFE: Enter read mode, reset address
-                read_mode <= 1;
-                address <= 0;
-            end else begin
-                // Normal data: increment address after access
-                address <= address + 1;
-            end
-        end
-    end
-    
-    // BRAM write (synchronous for proper inference)
-    always @(posedge clk) begin
-        if (rx_fifo_valid && rx_fifo_ready && 
-            rx_fifo_data != 8'hFF && rx_fifo_data != 8'hFE && !read_mode) begin
-            memory[address] <= rx_fifo_data;
-        end
-    end
-    
-    // BRAM read (synchronous, 1-cycle latency for BRAM primitive inference)
-    reg [7:0] read_data_reg;
-    always @(posedge clk) begin
-        read_data_reg <= memory[address];
-    end
-    
-    // Connect FIFO interface
-    assign tx_fifo_data = read_data_reg;
-    assign tx_fifo_valid = 1'b1;      // Always have data ready
-    assign rx_fifo_ready = 1'b1;      // Always ready to accept
+    spi_bram_controller #(
+        .DATA_WIDTH(8),
+        .MEM_DEPTH(MEM_DEPTH)
+    ) bram_inst (
+        .clk(clk),
+        .rst(rst),
+        
+        .rx_data(rx_data),
+        .rx_valid(rx_valid),
+        .rx_ready(rx_ready),
+        
+        .tx_data(tx_data),
+        .tx_valid(tx_valid),
+        .tx_ready(tx_ready),
+        .cs_active(cs_active)
+    );
     
 endmodule
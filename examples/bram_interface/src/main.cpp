@@ -4,6 +4,7 @@
 
 #include <Arduino.h>
 #include <PapilioSPI.h>
+#include <PapilioBram.h>
 
 // SPI Configuration
 #define SPI_CLK   1
@@ -12,6 +13,7 @@
 #define SPI_CS    3
 
 PapilioSPI spi;
+PapilioBram bram;
 
 void setup() {
   Serial.begin(115200);
@@ -24,6 +26,7 @@ void setup() {
   fpgaSPI.begin(SPI_CLK, SPI_MISO, SPI_MOSI, SPI_CS);
   spi.begin(&fpgaSPI, SPI_CS, 1000000, SPI_MODE1);
   
+  bram.begin(&spi);
   Serial.println("SPI initialized at 1 MHz");
   delay(100);
   
@@ -35,49 +38,41 @@ void setup() {
   // Generate test pattern
   for (int i = 0; i < TEST_SIZE; i++) {
     uint8_t val = i;
-    // Avoid command bytes
-    if (val == 0xFE || val == 0xFF) {
-      val = 0xFD;
+    // Avoid command bytes (0xFD-0xFF)
+    if (val >= 0xFD) {
+      val = 0xFC;
     }
     writeData[i] = val;
   }
   
   Serial.println("\n--- Phase 1: Write to BRAM ---");
   
-  // Reset address to 0 (write mode)
-  spi.transfer8(0xFF);
-  Serial.println("Sent 0xFF to reset address");
-  delay(10);
-  
-  // Write data
+  // Whole block in one CS frame: [0xFD][0x00][data...]
   Serial.println("Writing 256 bytes...");
+  uint32_t start = micros();
+  if (!bram.writeBlock(0, writeData, TEST_SIZE)) {
+    Serial.println("  writeBlock failed");
+  }
+  uint32_t elapsed = micros() - start;
   for (int i = 0; i < TEST_SIZE; i++) {
-    spi.transfer8(writeData[i]);
-    delayMicroseconds(50);  // CS high time for FIFO to settle
     if (i < 4 || i >= TEST_SIZE - 4) {
       Serial.printf("  [%3d] Wrote 0x%02X\n", i, writeData[i]);
     } else if (i == 4) {
       Serial.println("  ...");
     }
   }
-  Serial.println("Write complete");
-  delay(10);
+  Serial.printf("Write complete (%lu us)\n", (unsigned long)elapsed);
   
   Serial.println("\n--- Phase 2: Read from BRAM ---");
   
-  // Reset address and enter read mode
-  spi.transfer8(0xFF);  // Reset address
-  delayMicroseconds(50);
-  spi.transfer8(0xFE);  // Enter read mode
-  delayMicroseconds(50);
-  Serial.println("Sent 0xFE to enter read mode");
-  delay(10);
-  
-  // Read data (send dummy bytes)
+  // [0xFD][0x00][0xFE] then dummy bytes clock the data out
   Serial.println("Reading 256 bytes...");
+  start = micros();
+  if (!bram.readBlock(0, readData, TEST_SIZE)) {
+    Serial.println("  readBlock failed");
+  }
+  elapsed = micros() - start;
   for (int i = 0; i < TEST_SIZE; i++) {
-    readData[i] = spi.transfer8(0x00);
-    delayMicroseconds(50);  // CS high time for FIFO to settle
     if (i < 4 || i >= TEST_SIZE - 4) {
       Serial.printf("  [%3d] Read 0x%02X (expected 0x%02X)\n", 
                     i, readData[i], writeData[i]);
@@ -85,7 +80,7 @@ void setup() {
       Serial.println("  ...");
     }
   }
-  Serial.println("Read complete");
+  Serial.printf("Read complete (%lu us)\n", (unsigned long)elapsed);
   
   Serial.println("\n--- Phase 3: Verify ---");
   
@@ -112,7 +107,7 @@ void setup() {
     Serial.println("\n✓ ALL TESTS PASSED!");
     Serial.println("  • 256-byte BRAM working correctly");
     Serial.println("  • Auto-increment addressing working");
-    Serial.println("  • Command protocol working (0xFF reset, 0xFE read)");
+    Serial.println("  • Block protocol working (0xFD address, 0xFE read)");
   } else {
     Serial.println("\n✗ SOME TESTS FAILED");
   }
@@ -1,6 +1,10 @@
-// Burst Transfer FPGA Top - Simple loopback with FIFO buffering
+// Burst Transfer FPGA Top - Frame loopback with FIFO buffering
 // Demonstrates high-throughput data transfers at 8/16/32-bit widths
 //
+// Each burst frame is held in the RX FIFO and queued for transmission once
+// CS rises, so the next frame reads the previous burst back intact from its
+// first word (up to 256 words per frame).
+//
 // To change bit width, modify TRANSFER_WIDTH parameter below
 // Valid values: 8, 16, or 32
 //
@@ -79,19 +83,21 @@ module top (
     // =========================================================================
     // Loopback Logic - Works for any bit width
     // =========================================================================
-    reg [TRANSFER_WIDTH-1:0] loopback_reg;
+    // Received words stay in the RX FIFO while CS is low and move to the TX
+    // FIFO (one per clock) once it is high again. The TX FIFO is only popped
+    // inside a frame, so they all go out in order in the next frame.
+    reg spi_cs_n_d1, spi_cs_n_d2;
     
     always @(posedge clk) begin
-        if (rst) begin
-            loopback_reg <= {TRANSFER_WIDTH{1'b0}};
-        end else if (rx_fifo_valid && rx_fifo_ready) begin
-            loopback_reg <= rx_fifo_data;
-        end
+        spi_cs_n_d1 <= spi_cs_n;
+        spi_cs_n_d2 <= spi_cs_n_d1;
     end
     
-    assign tx_fifo_data = loopback_reg;
-    assign tx_fifo_valid = 1'b1;
-    assign rx_fifo_ready = 1'b1;
+    wire move = spi_cs_n_d2;  // Between frames
+    
+    assign tx_fifo_data = rx_fifo_data;
+    assign tx_fifo_valid = rx_fifo_valid && move;
+    assign rx_fifo_ready = tx_fifo_ready && move;
     
 endmodule
 
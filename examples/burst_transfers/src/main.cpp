@@ -1,6 +1,8 @@
 // Burst Transfer Test - ESP32 Side
 // Tests high-throughput burst transfers at various speeds and bit widths
 // Demonstrates the loopback performance of the FPGA
+// Each burst is one CS frame. The FPGA queues it while CS is high, and the
+// next frame reads all of it back intact, starting with its first word.
 //
 // IMPORTANT: The FPGA top.v TRANSFER_WIDTH must match the test mode below
 // For 16-bit tests: Set FPGA TRANSFER_WIDTH = 16
@@ -33,6 +35,10 @@ void testBurstAtSpeed_32bit(uint32_t speed_hz, const char* label);
 int total_passed = 0;
 int total_failed = 0;
 
+// CS high time between the write and read frames: the FPGA moves one word
+// per clock from its RX to its TX FIFO (256 words take ~10 us at 27 MHz)
+const int QUEUE_DELAY_US = 20;
+
 void setup() {
   Serial.begin(115200);
   delay(1000);
@@ -103,36 +109,37 @@ void loop() {
 // =========================================================================
 void testBurstAtSpeed_8bit(uint32_t speed_hz, const char* label) {
   const int BURST_SIZE = 256;
-  uint8_t tx_data[BURST_SIZE + 1];  // +1 to prime the pump
-  uint8_t rx_data[BURST_SIZE + 1];
+  uint8_t tx_data[BURST_SIZE];
+  uint8_t rx_data[BURST_SIZE];
   
   spi.setSpeed(speed_hz);
   Serial.printf("=== Testing at %s (8-bit) ===\n", label);
   
   // Generate test pattern
-  for (int i = 0; i <= BURST_SIZE; i++) {
+  for (int i = 0; i < BURST_SIZE; i++) {
     tx_data[i] = i & 0xFF;
   }
   
+  // Write frame: the FPGA queues the burst once CS rises
+  spi.transferBurst(tx_data, nullptr, BURST_SIZE);
+  delayMicroseconds(QUEUE_DELAY_US);
+  
   unsigned long start_time = micros();
   
-  // Transfer all bytes
-  for (int i = 0; i <= BURST_SIZE; i++) {
-    rx_data[i] = spi.transfer8(tx_data[i]);
-    delayMicroseconds(50);
-  }
+  // Read frame: the queued words come back to back from word 0
+  spi.transferBurst(nullptr, rx_data, BURST_SIZE);
   
   unsigned long elapsed = micros() - start_time;
   
-  // Verify loopback
+  // Verify loopback: word i of the read frame is word i of the burst
   int passed = 0, failed = 0;
-  for (int i = 1; i <= BURST_SIZE; i++) {
-    if (rx_data[i] == tx_data[i-1]) {
+  for (int i = 0; i < BURST_SIZE; i++) {
+    if (rx_data[i] == tx_data[i]) {
       passed++;
     } else {
       if (failed == 0) {
         Serial.printf("  First error at [%3d]: Got 0x%02X (expected 0x%02X)\n",
-                      i, rx_data[i], tx_data[i-1]);
+                      i, rx_data[i], tx_data[i]);
       }
       failed++;
     }
@@ -155,36 +162,37 @@ void testBurstAtSpeed_8bit(uint32_t speed_hz, const char* label) {
 // =========================================================================
 void testBurstAtSpeed_16bit(uint32_t speed_hz, const char* label) {
   const int BURST_SIZE = 256;
-  uint16_t tx_data[BURST_SIZE + 1];  // +1 to prime the pump
-  uint16_t rx_data[BURST_SIZE + 1];
+  uint16_t tx_data[BURST_SIZE];
+  uint16_t rx_data[BURST_SIZE];
   
   spi.setSpeed(speed_hz);
   Serial.printf("=== Testing at %s (16-bit) ===\n", label);
   
   // Generate test pattern
-  for (int i = 0; i <= BURST_SIZE; i++) {
+  for (int i = 0; i < BURST_SIZE; i++) {
     tx_data[i] = 0xA000 + i;  // Recognizable pattern
   }
   
+  // Write frame: the FPGA queues the burst once CS rises
+  spi.transferBurst16(tx_data, nullptr, BURST_SIZE);
+  delayMicroseconds(QUEUE_DELAY_US);
+  
   unsigned long start_time = micros();
   
-  // Transfer all words
-  for (int i = 0; i <= BURST_SIZE; i++) {
-    rx_data[i] = spi.transfer16(tx_data[i]);
-    delayMicroseconds(50);
-  }
+  // Read frame: the queued words come back to back from word 0
+  spi.transferBurst16(nullptr, rx_data, BURST_SIZE);
   
   unsigned long elapsed = micros() - start_time;
   
-  // Verify loopback
+  // Verify loopback: word i of the read frame is word i of the burst
   int passed = 0, failed = 0;
-  for (int i = 1; i <= BURST_SIZE; i++) {
-    if (rx_data[i] == tx_data[i-1]) {
+  for (int i = 0; i < BURST_SIZE; i++) {
+    if (rx_data[i] == tx_data[i]) {
       passed++;
     } else {
       if (failed == 0) {
         Serial.printf("  First error at [%3d]: Got 0x%04X (expected 0x%04X)\n",
-                      i, rx_data[i], tx_data[i-1]);
+                      i, rx_data[i], tx_data[i]);
       }
       failed++;
     }
@@ -207,36 +215,37 @@ void testBurstAtSpeed_16bit(uint32_t speed_hz, const char* label) {
 // =========================================================================
 void testBurstAtSpeed_32bit(uint32_t speed_hz, const char* label) {
   const int BURST_SIZE = 256;
-  uint32_t tx_data[BURST_SIZE + 1];  // +1 to prime the pump
-  uint32_t rx_data[BURST_SIZE + 1];
+  uint32_t tx_data[BURST_SIZE];
+  uint32_t rx_data[BURST_SIZE];
   
   spi.setSpeed(speed_hz);
   Serial.printf("=== Testing at %s (32-bit) ===\n", label);
   
   // Generate test pattern
-  for (int i = 0; i <= BURST_SIZE; i++) {
+  for (int i = 0; i < BURST_SIZE; i++) {
     tx_data[i] = 0xDEAD0000 + i;  // Recognizable pattern
   }
   
+  // Write frame: the FPGA queues the burst once CS rises
+  spi.transferBurst32(tx_data, nullptr, BURST_SIZE);
+  delayMicroseconds(QUEUE_DELAY_US);
+  
   unsigned long start_time = micros();
   
-  // Transfer all words
-  for (int i = 0; i <= BURST_SIZE; i++) {
-    rx_data[i] = spi.transfer32(tx_data[i]);
-    delayMicroseconds(50);
-  }
+  // Read frame: the queued words come back to back from word 0
+  spi.transferBurst32(nullptr, rx_data, BURST_SIZE);
   
   unsigned long elapsed = micros() - start_time;
   
-  // Verify loopback
+  // Verify loopback: word i of the read frame is word i of the burst
   int passed = 0, failed = 0;
-  for (int i = 1; i <= BURST_SIZE; i++) {
-    if (rx_data[i] == tx_data[i-1]) {
+  for (int i = 0; i < BURST_SIZE; i++) {
+    if (rx_data[i] == tx_data[i]) {
       passed++;
     } else {
       if (failed == 0) {
         Serial.printf("  First error at [%3d]: Got 0x%08X (expected 0x%08X)\n",
-                      i, rx_data[i], tx_data[i-1]);
+                      i, rx_data[i], tx_data[i]);
       }
       failed++;
     }
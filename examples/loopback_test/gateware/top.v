@@ -60,19 +60,12 @@ module top (
         .tx_fifo_count()
     );
     
-    // Simple loopback with register
-    reg [TRANSFER_WIDTH-1:0] loopback_reg;
-    
-    always @(posedge clk) begin
-        if (rst) begin
-            loopback_reg <= 0;
-        end else if (rx_valid && rx_ready) begin
-            loopback_reg <= rx_data;
-        end
-    end
-    
-    assign tx_data = loopback_reg;
-    assign tx_valid = 1'b1;
-    assign rx_ready = 1'b1;
+    // Loopback: every received word is queued for transmission once. The
+    // TX FIFO is only popped inside a frame, so each word goes out at the
+    // next word boundary - the start of the next frame for single-word
+    // transfers (PapilioSPI::calibrate() relies on that echo)
+    assign tx_data = rx_data;
+    assign tx_valid = rx_valid;
+    assign rx_ready = tx_ready;
 
 endmodule
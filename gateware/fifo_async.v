@@ -0,0 +1,205 @@
+// =============================================================================
+// Asynchronous (Dual-Clock) FIFO with Block RAM Inference
+// Part of papilio_hdl_blocks library
+// =============================================================================
+//
+// Dual-clock counterpart of fifo_sync for crossing between unrelated clocks,
+// e.g. an SPI slave on one PLL output and application logic on another.
+// Read and write pointers cross domains as Gray code through two-register
+// synchronizers, so only one pointer bit changes per increment.
+//
+// Features:
+// - Independent write (wr_clk) and read (rd_clk) clocks
+// - Block RAM inference (simple dual-port, one port per clock)
+// - Ready/valid handshaking on both interfaces, same as fifo_sync
+// - Full/almost_full/wr_count in the write domain
+// - Empty/almost_empty/rd_count in the read domain
+//
+// Flags and counts are conservative: the write side sees reads up to three
+// wr_clk cycles late and the read side sees writes up to three rd_clk cycles
+// late, so full never under-reports and empty never over-reports.
+//
+// Parameters:
+// - DATA_WIDTH: Width of each FIFO entry (default: 8)
+// - DEPTH: Number of entries in FIFO (default: 256, must be power of 2)
+// - ALMOST_FULL_THRESHOLD: Entries remaining before almost_full asserts
+// - ALMOST_EMPTY_THRESHOLD: Entries remaining before almost_empty asserts
+//
+// Reset: rst_n clears both domains asynchronously; release it while both
+// clocks are running.
+//
+// =============================================================================
+
+module fifo_async #(
+    parameter DATA_WIDTH = 8,
+    parameter DEPTH = 256,
+    parameter ALMOST_FULL_THRESHOLD = 4,
+    parameter ALMOST_EMPTY_THRESHOLD = 4,
+    parameter ADDR_WIDTH = $clog2(DEPTH)
+) (
+    input wire rst_n,
+    
+    // Write Interface (wr_clk domain)
+    input wire wr_clk,
+    input wire [DATA_WIDTH-1:0] wr_data,
+    input wire wr_valid,
+    output wire wr_ready,
+    output wire full,
+    output wire almost_full,
+    output wire [ADDR_WIDTH:0] wr_count,
+    
+    // Read Interface (rd_clk domain)
+    input wire rd_clk,
+    output wire [DATA_WIDTH-1:0] rd_data,
+    output wire rd_valid,
+    input wire rd_ready,
+    output wire empty,
+    output wire almost_empty,
+    output wire [ADDR_WIDTH:0] rd_count
+);
+    
+    // =========================================================================
+    // Gray Code Helpers
+    // =========================================================================
+    
+    function [ADDR_WIDTH:0] bin2gray;
+        input [ADDR_WIDTH:0] bin;
+        begin
+            bin2gray = bin ^ (bin >> 1);
+        end
+    endfunction
+    
+    function [ADDR_WIDTH:0] gray2bin;
+        input [ADDR_WIDTH:0] gray;
+        integer i;
+        begin
+            gray2bin[ADDR_WIDTH] = gray[ADDR_WIDTH];
+            for (i = ADDR_WIDTH - 1; i >= 0; i = i - 1)
+                gray2bin[i] = gray2bin[i + 1] ^ gray[i];
+        end
+    endfunction
+    
+    // =========================================================================
+    // Internal Signals
+    // =========================================================================
+    
+    // Memory array - should infer block RAM
+    reg [DATA_WIDTH-1:0] memory [0:DEPTH-1];
+    
+    // Binary pointers (local domain) and their Gray copies (cross domains)
+    reg [ADDR_WIDTH:0] wr_ptr;
+    reg [ADDR_WIDTH:0] wr_ptr_gray;
+    reg [ADDR_WIDTH:0] rd_ptr;
+    reg [ADDR_WIDTH:0] rd_ptr_gray;
+    
+    // Two-register synchronizers
+    reg [ADDR_WIDTH:0] rd_ptr_gray_w1, rd_ptr_gray_w2;  // Read pointer in wr_clk
+    reg [ADDR_WIDTH:0] wr_ptr_gray_r1, wr_ptr_gray_r2;  // Write pointer in rd_clk
+    
+    // Internal registered outputs
+    reg [DATA_WIDTH-1:0] rd_data_reg;
+    reg rd_valid_reg;
+    
+    // =========================================================================
+    // Write Domain
+    // =========================================================================
+    
+    wire [ADDR_WIDTH:0] wr_ptr_next = wr_ptr + 1'b1;
+    wire [ADDR_WIDTH:0] rd_ptr_sync = gray2bin(rd_ptr_gray_w2);
+    wire [ADDR_WIDTH:0] wr_fifo_count = wr_ptr - rd_ptr_sync;
+    
+    assign full = (wr_fifo_count == DEPTH);
+    assign almost_full = (wr_fifo_count >= (DEPTH - ALMOST_FULL_THRESHOLD));
+    assign wr_count = wr_fifo_count;
+    
+    assign wr_ready = !full;
+    
+    wire wr_enable = wr_valid && wr_ready;
+    
+    // Separate memory write for block RAM inference
+    always @(posedge wr_clk) begin
+        if (wr_enable) begin
+            memory[wr_ptr[ADDR_WIDTH-1:0]] <= wr_data;
+        end
+    end
+    
+    // Pointer update
+    always @(posedge wr_clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_ptr <= {(ADDR_WIDTH+1){1'b0}};
+            wr_ptr_gray <= {(ADDR_WIDTH+1){1'b0}};
+        end else if (wr_enable) begin
+            wr_ptr <= wr_ptr_next;
+            wr_ptr_gray <= bin2gray(wr_ptr_next);
+        end
+    end
+    
+    // Bring the read pointer into the write domain
+    always @(posedge wr_clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rd_ptr_gray_w1 <= {(ADDR_WIDTH+1){1'b0}};
+            rd_ptr_gray_w2 <= {(ADDR_WIDTH+1){1'b0}};
+        end else begin
+            rd_ptr_gray_w1 <= rd_ptr_gray;
+            rd_ptr_gray_w2 <= rd_ptr_gray_w1;
+        end
+    end
+    
+    // =========================================================================
+    // Read Domain
+    // =========================================================================
+    
+    wire [ADDR_WIDTH:0] rd_ptr_next = rd_ptr + 1'b1;
+    wire [ADDR_WIDTH:0] wr_ptr_sync = gray2bin(wr_ptr_gray_r2);
+    wire [ADDR_WIDTH:0] rd_fifo_count = wr_ptr_sync - rd_ptr;
+    
+    assign empty = (wr_ptr_sync == rd_ptr);
+    assign almost_empty = (rd_fifo_count <= ALMOST_EMPTY_THRESHOLD);
+    assign rd_count = rd_fifo_count;
+    
+    assign rd_valid = rd_valid_reg;
+    assign rd_data = rd_data_reg;
+    
+    wire rd_enable = rd_ready && rd_valid;
+    wire rd_fetch = !empty && (!rd_valid || rd_enable);
+    
+    // Synchronous read for block RAM inference
+    always @(posedge rd_clk) begin
+        if (rd_fetch) begin
+            rd_data_reg <= memory[rd_ptr[ADDR_WIDTH-1:0]];
+        end
+    end
+    
+    // Control logic
+    always @(posedge rd_clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rd_ptr <= {(ADDR_WIDTH+1){1'b0}};
+            rd_ptr_gray <= {(ADDR_WIDTH+1){1'b0}};
+            rd_valid_reg <= 1'b0;
+        end else begin
+            // Handle data consumption
+            if (rd_enable) begin
+                rd_valid_reg <= 1'b0;
+            end
+            
+            // Fetch new data if available and needed
+            if (rd_fetch) begin
+                rd_valid_reg <= 1'b1;
+                rd_ptr <= rd_ptr_next;
+                rd_ptr_gray <= bin2gray(rd_ptr_next);
+            end
+        end
+    end
+    
+    // Bring the write pointer into the read domain
+    always @(posedge rd_clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_ptr_gray_r1 <= {(ADDR_WIDTH+1){1'b0}};
+            wr_ptr_gray_r2 <= {(ADDR_WIDTH+1){1'b0}};
+        end else begin
+            wr_ptr_gray_r1 <= wr_ptr_gray;
+            wr_ptr_gray_r2 <= wr_ptr_gray_r1;
+        end
+    end
+
+endmodule
@@ -0,0 +1,177 @@
+// =============================================================================
+// Transactional Synchronous FIFO with Block RAM Inference
+// Part of papilio_hdl_blocks library
+// =============================================================================
+//
+// fifo_sync with commit/rollback on both sides, for link layers that only
+// keep a frame once its CRC has been checked.
+//
+// - Writes are tentative until wr_commit; the reader cannot see them and
+//   wr_rollback drops every write since the last commit.
+// - Reads are tentative until rd_commit; the slots stay allocated (the
+//   writer cannot reuse them) and rd_rollback makes the words readable
+//   again, in the same order.
+// - Tie wr_commit (or rd_commit) high for a side that never rolls back.
+// - A commit includes a write/read in the same cycle; a rollback drops it.
+//
+// Parameters:
+// - DATA_WIDTH: Width of each FIFO entry (default: 8)
+// - DEPTH: Number of entries in FIFO (default: 256, must be power of 2)
+// - ALMOST_FULL_THRESHOLD: Entries remaining before almost_full asserts
+// - ALMOST_EMPTY_THRESHOLD: Entries remaining before almost_empty asserts
+//
+// =============================================================================
+
+module fifo_frame #(
+    parameter DATA_WIDTH = 8,
+    parameter DEPTH = 256,
+    parameter ALMOST_FULL_THRESHOLD = 4,
+    parameter ALMOST_EMPTY_THRESHOLD = 4,
+    parameter ADDR_WIDTH = $clog2(DEPTH)
+) (
+    input wire clk,
+    input wire rst_n,
+    
+    // Write Interface
+    input wire [DATA_WIDTH-1:0] wr_data,
+    input wire wr_valid,
+    output wire wr_ready,
+    input wire wr_commit,              // Make writes so far visible to the reader
+    input wire wr_rollback,            // Drop writes since the last commit
+    
+    // Read Interface
+    output wire [DATA_WIDTH-1:0] rd_data,
+    output wire rd_valid,
+    input wire rd_ready,
+    input wire rd_commit,              // Free the slots of words read so far
+    input wire rd_rollback,            // Rewind to the last committed read
+    
+    // Status Flags
+    output wire full,
+    output wire empty,
+    output wire almost_full,
+    output wire almost_empty,
+    output wire [ADDR_WIDTH:0] count   // Committed words not yet read (incl. rd_data)
+);
+    
+    // =========================================================================
+    // Internal Signals
+    // =========================================================================
+    
+    // Memory array - should infer block RAM
+    reg [DATA_WIDTH-1:0] memory [0:DEPTH-1];
+    
+    // Write pointers: tentative and committed
+    reg [ADDR_WIDTH:0] wr_ptr;
+    reg [ADDR_WIDTH:0] wr_ptr_commit;
+    
+    // Read pointers: fetch (RAM address), taken by the reader, committed
+    reg [ADDR_WIDTH:0] rd_ptr;
+    reg [ADDR_WIDTH:0] rd_taken;
+    reg [ADDR_WIDTH:0] rd_ptr_commit;
+    
+    // Internal registered outputs
+    reg [DATA_WIDTH-1:0] rd_data_reg;
+    reg rd_valid_reg;
+    
+    // =========================================================================
+    // Status Flags
+    // =========================================================================
+    
+    // Writer: slots are busy until the read side commits
+    wire [ADDR_WIDTH:0] used = wr_ptr - rd_ptr_commit;
+    
+    // Reader: committed words not yet taken
+    wire [ADDR_WIDTH:0] fifo_count = wr_ptr_commit - rd_taken;
+    
+    assign full = (used == DEPTH);
+    assign empty = (wr_ptr_commit == rd_ptr);  // Nothing left to fetch
+    
+    assign almost_full = (used >= (DEPTH - ALMOST_FULL_THRESHOLD));
+    assign almost_empty = (fifo_count <= ALMOST_EMPTY_THRESHOLD);
+    
+    assign count = fifo_count;
+    
+    // =========================================================================
+    // Write Interface Logic
+    // =========================================================================
+    
+    assign wr_ready = !full;
+    
+    wire wr_enable = wr_valid && wr_ready;
+    wire [ADDR_WIDTH:0] wr_ptr_next = wr_ptr + 1'b1;
+    
+    // Separate memory write for block RAM inference
+    always @(posedge clk) begin
+        if (wr_enable) begin
+            memory[wr_ptr[ADDR_WIDTH-1:0]] <= wr_data;
+        end
+    end
+    
+    // Pointer update
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_ptr <= {(ADDR_WIDTH+1){1'b0}};
+            wr_ptr_commit <= {(ADDR_WIDTH+1){1'b0}};
+        end else if (wr_rollback) begin
+            wr_ptr <= wr_ptr_commit;
+        end else begin
+            if (wr_enable) begin
+                wr_ptr <= wr_ptr_next;
+            end
+            if (wr_commit) begin
+                wr_ptr_commit <= wr_enable ? wr_ptr_next : wr_ptr;
+            end
+        end
+    end
+    
+    // =========================================================================
+    // Read Interface Logic
+    // =========================================================================
+    
+    assign rd_valid = rd_valid_reg;
+    assign rd_data = rd_data_reg;
+    
+    wire rd_enable = rd_ready && rd_valid;
+    wire rd_fetch = !empty && (!rd_valid || rd_enable);
+    wire [ADDR_WIDTH:0] rd_taken_next = rd_taken + 1'b1;
+    
+    // Synchronous read for block RAM inference
+    always @(posedge clk) begin
+        if (rd_fetch) begin
+            rd_data_reg <= memory[rd_ptr[ADDR_WIDTH-1:0]];
+        end
+    end
+    
+    // Control logic
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rd_ptr <= {(ADDR_WIDTH+1){1'b0}};
+            rd_taken <= {(ADDR_WIDTH+1){1'b0}};
+            rd_ptr_commit <= {(ADDR_WIDTH+1){1'b0}};
+            rd_valid_reg <= 1'b0;
+        end else if (rd_rollback) begin
+            // Discard the staged word; it is fetched again from the commit point
+            rd_ptr <= rd_ptr_commit;
+            rd_taken <= rd_ptr_commit;
+            rd_valid_reg <= 1'b0;
+        end else begin
+            // Handle data consumption
+            if (rd_enable) begin
+                rd_valid_reg <= 1'b0;
+                rd_taken <= rd_taken_next;
+            end
+            
+            // Fetch new data if available and needed
+            if (rd_fetch) begin
+                rd_valid_reg <= 1'b1;
+                rd_ptr <= rd_ptr + 1'b1;
+            end
+            
+            if (rd_commit) begin
+                rd_ptr_commit <= rd_enable ? rd_taken_next : rd_taken;
+            end
+        end
+    end
+
+endmodule
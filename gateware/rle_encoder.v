@@ -0,0 +1,114 @@
+// =============================================================================
+// Run-Length Encoder for Capture Streams
+// Part of papilio_hdl_blocks library
+// =============================================================================
+//
+// Sits in front of a FIFO write port and compresses repeated sample words.
+// Every word is passed through unchanged, except that a word equal to the
+// one before it is followed by a count word:
+//
+//   A A n    2 + n copies of A (n = 0 .. 2^DATA_WIDTH - 1)
+//
+// The word after a count always starts afresh, so a long run is sent as
+// A A max A A max ... Data without repeats costs nothing extra; idle
+// signals shrink to 3 words per 2^DATA_WIDTH + 1 samples.
+// PapilioRleDecoder (PapilioSPI::setStreamRle()) expands the stream.
+//
+// A run is only sent when it ends, so a pending run is closed (its count
+// word sent) when:
+// - a different word arrives, or the count is at its maximum
+// - no input has arrived for FLUSH_CYCLES clocks (0: never)
+// - flush is high
+//
+// Parameters:
+// - DATA_WIDTH: Sample and count word width (default: 8)
+// - FLUSH_CYCLES: Idle clocks before a pending run is sent (default: 64)
+//
+// =============================================================================
+
+module rle_encoder #(
+    parameter DATA_WIDTH = 8,
+    parameter FLUSH_CYCLES = 64
+) (
+    input wire clk,
+    input wire rst_n,
+    
+    // Samples in
+    input wire [DATA_WIDTH-1:0] in_data,
+    input wire in_valid,
+    output wire in_ready,
+    
+    // Encoded words out (to the FIFO write side)
+    output reg [DATA_WIDTH-1:0] out_data,
+    output reg out_valid,
+    input wire out_ready,
+    
+    // Close the pending run now (end of capture)
+    input wire flush
+);
+
+    localparam [DATA_WIDTH-1:0] COUNT_MAX = {DATA_WIDTH{1'b1}};
+    localparam IDLE_BITS = (FLUSH_CYCLES > 1) ? $clog2(FLUSH_CYCLES + 1) : 1;
+    
+    // =========================================================================
+    // Run State
+    // =========================================================================
+    
+    reg [DATA_WIDTH-1:0] prev;       // Last literal sent
+    reg have_prev;                   // prev can start a run
+    reg run_active;                  // A A sent, counting further copies
+    reg [DATA_WIDTH-1:0] count;
+    reg [IDLE_BITS-1:0] idle;        // Clocks without input during a run
+    
+    wire out_free = !out_valid || out_ready;
+    wire in_match = have_prev && (in_data == prev);
+    wire absorb = run_active && in_match && (count != COUNT_MAX);
+    wire idle_flush = (FLUSH_CYCLES > 0) && (idle >= FLUSH_CYCLES);
+    
+    // A run only takes input while it absorbs copies; any other word waits
+    // one clock while the count goes out
+    assign in_ready = run_active ? absorb : out_free;
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            out_data <= 0;
+            out_valid <= 1'b0;
+            prev <= 0;
+            have_prev <= 1'b0;
+            run_active <= 1'b0;
+            count <= 0;
+            idle <= 0;
+        end else begin
+            if (out_valid && out_ready)
+                out_valid <= 1'b0;
+            
+            if (run_active) begin
+                if (in_valid && absorb) begin
+                    count <= count + 1'b1;
+                    idle <= 0;
+                end else if ((in_valid || idle_flush || flush) && out_free) begin
+                    // Close the run: send its count
+                    out_data <= count;
+                    out_valid <= 1'b1;
+                    run_active <= 1'b0;
+                    have_prev <= 1'b0;
+                end else if (!in_valid && !idle_flush) begin
+                    idle <= idle + 1'b1;
+                end
+            end else if (in_valid && out_free) begin
+                out_data <= in_data;
+                out_valid <= 1'b1;
+                if (in_match) begin
+                    // Second copy: a count word follows
+                    run_active <= 1'b1;
+                    count <= 0;
+                    idle <= 0;
+                end else begin
+                    prev <= in_data;
+                    have_prev <= 1'b1;
+                end
+            end
+        end
+    end
+
+endmodule
@@ -6,9 +6,34 @@
 // Protocol:
 //   - Each data byte written advances address by 1
 //   - Special commands:
-//     * 0xFF: Reset address to 0 without writing
+//     * 0xFF: Reset address to 0 and enter WRITE mode
 //     * 0xFE: Switch to READ mode (stop writing)
-//   - Normal operation: write bytes sequentially, read them back
+//     * 0xFD: Set address - the next ADDR_WORDS words (MSB first) are the
+//             new address, then WRITE mode; any value is allowed here
+//   - Data values 0xFD-0xFF are reserved for commands
+//   - In READ mode each non-command word received advances the address and
+//     the next word is shifted out of the BRAM read register
+//
+// Block transfers (one CS frame, no gaps between words):
+//   Write: [0xFD][ADDR][D0][D1]...[Dn-1]
+//   Read:  [0xFD][ADDR][0xFE][0x00 x n]  -> MISO returns D0..Dn-1 during the
+//          dummy words. The synchronous BRAM read prefetches the next word
+//          while the current one is shifting, so spi_slave can reload at
+//          every word boundary.
+//   The controller stays in read mode after CS rises: the next word is
+//   loaded during CS high, so a following frame of dummy words carries on
+//   with Dn, Dn+1, ... without a new header.
+//
+// Prefetch (PREFETCH > 0):
+//   In read mode a look-ahead FIFO of PREFETCH words is kept staged from
+//   the read address, one BRAM read per clock, and spi_slave pops it at
+//   each word boundary. MISO then no longer depends on when the previous
+//   dummy word was received, which removes the race between rx_valid and
+//   the next reload at high SCLK rates. D0 is staged 3 clocks after 0xFE is
+//   received. Any command flushes the FIFO.
+//   While CS is high spi_slave keeps reloading the head word, so it is not
+//   popped there: once it has been loaded, it is popped when the next frame
+//   starts (cs_active rises). This needs cs_active from spi_slave.
 //
 // Features:
 //   - Configurable memory depth and data width
@@ -17,8 +42,10 @@
 //   - BRAM-inferred storage (synchronous read for efficient resource usage)
 //
 // Integration:
-//   Connect rx_data/valid/ready to SPI slave's RX FIFO interface
-//   Connect tx_data/valid/ready to SPI slave's TX FIFO interface
+//   Connect rx_data/valid/ready, tx_data/valid/ready and cs_active directly
+//   to spi_slave (cs_active is only used with PREFETCH > 0). Going through
+//   spi_slave_fifo adds a FIFO of stale read data between the BRAM and
+//   MISO, so reads would lag the address.
 //
 // Author: Generated for Papilio SPI Slave Library
 // Date: January 4, 2026
@@ -26,7 +53,9 @@
 module spi_bram_controller #(
     parameter DATA_WIDTH = 8,       // Data width (8, 16, or 32)
     parameter MEM_DEPTH = 256,      // Memory depth (number of entries)
-    parameter ADDR_WIDTH = $clog2(MEM_DEPTH)
+    parameter ADDR_WIDTH = $clog2(MEM_DEPTH),
+    parameter ADDR_WORDS = (ADDR_WIDTH + DATA_WIDTH - 1) / DATA_WIDTH,  // Words in the 0xFD header
+    parameter PREFETCH = 0          // Read look-ahead words (0 = read on demand, else power of 2)
 )(
     input wire clk,
     input wire rst,
@@ -39,7 +68,8 @@ module spi_bram_controller #(
     // Interface to SPI slave (TX path)
     output wire [DATA_WIDTH-1:0] tx_data,
     output wire tx_valid,
-    input wire tx_ready
+    input wire tx_ready,
+    input wire cs_active            // spi_slave cs_active (PREFETCH > 0)
 );
 
     // =========================================================================
@@ -60,18 +90,33 @@ module spi_bram_controller #(
     // =========================================================================
     reg [ADDR_WIDTH-1:0] address;
     reg read_mode;  // 1 = read only, 0 = write
+    reg [$clog2(ADDR_WORDS+1)-1:0] addr_words_left;  // Address header words still expected
+    
+    wire is_command = (addr_words_left == 0) &&
+                      (rx_data == 8'hFF || rx_data == 8'hFE || rx_data == 8'hFD);
     
     always @(posedge clk) begin
         if (rst) begin
             address <= 0;
             read_mode <= 0;
+            addr_words_left <= 0;
         end else if (rx_valid && rx_ready) begin
-            if (rx_data == 8'hFF) begin
-                // 0xFF: Reset address without writing
+            if (addr_words_left != 0) begin
+                // Address header word (MSB first)
+                address <= (address << DATA_WIDTH) | rx_data;
+                addr_words_left <= addr_words_left - 1;
+            end else if (rx_data == 8'hFF) begin
+                // 0xFF: Reset address, back to write mode
                 address <= 0;
+                read_mode <= 0;
             end else if (rx_data == 8'hFE) begin
                 // 0xFE: Enter read mode (don't increment for command byte)
                 read_mode <= 1;
+            end else if (rx_data == 8'hFD) begin
+                // 0xFD: Address header follows, then write mode
+                address <= 0;
+                read_mode <= 0;
+                addr_words_left <= ADDR_WORDS;
             end else begin
                 // Normal data byte: increment address AFTER write
                 // (write happens in same cycle, uses current address)
@@ -86,8 +131,8 @@ module spi_bram_controller #(
     // Write uses CURRENT address before increment
     always @(posedge clk) begin
         // Write happens when rx_valid and rx_ready and not in read mode
-        // Don't write command bytes (0xFF, 0xFE)
-        if (rx_valid && rx_ready && rx_data != 8'hFF && rx_data != 8'hFE && !read_mode) begin
+        // Don't write command or address header words
+        if (rx_valid && rx_ready && !is_command && addr_words_left == 0 && !read_mode) begin
             memory[address] <= rx_data;
         end
     end
@@ -98,15 +143,106 @@ module spi_bram_controller #(
     // Synchronous read allows synthesis to use actual BRAM primitives
     // instead of LUTs, preventing resource exhaustion
     reg [DATA_WIDTH-1:0] read_data_reg;
-    always @(posedge clk) begin
-        read_data_reg <= memory[address];
-    end
+    
+    generate
+        if (PREFETCH == 0) begin : g_on_demand
+            always @(posedge clk) begin
+                read_data_reg <= memory[address];
+            end
+            
+            assign tx_data = read_data_reg;
+            assign tx_valid = 1'b1;  // Always have data to send
+        end else begin : g_prefetch
+            // =================================================================
+            // Look-ahead FIFO, filled from fetch_addr while in read mode
+            // =================================================================
+            localparam PF_AW = $clog2(PREFETCH);
+            
+            initial begin
+                if (PREFETCH < 2 || (1 << PF_AW) != PREFETCH) begin
+                    $error("PREFETCH must be 0 or a power of 2 (>= 2)");
+                    $finish;
+                end
+            end
+            
+            reg [DATA_WIDTH-1:0] pf_mem [0:PREFETCH-1];
+            reg [PF_AW:0] pf_wr;
+            reg [PF_AW:0] pf_rd;
+            reg [ADDR_WIDTH-1:0] fetch_addr;
+            reg fetch_pending;      // read_data_reg holds a fetched word to push
+            reg pf_idle_taken;      // spi_slave loaded the head word during this CS high
+            reg cs_active_d;
+            
+            wire [PF_AW:0] pf_count = pf_wr - pf_rd;
+            wire pf_empty = (pf_count == 0);
+            
+            // A command restarts the look-ahead: 0xFE from the current address,
+            // 0xFF/0xFD leave read mode
+            wire pf_restart = !read_mode || (rx_valid && rx_ready && is_command);
+            wire pf_fetch = !pf_restart && (pf_count + fetch_pending < PREFETCH);
+            
+            // Inside a frame pop at each word boundary; the word loaded while
+            // CS was high is popped once, when its frame starts
+            wire pf_frame_start = cs_active && !cs_active_d;
+            wire pf_pop = read_mode && !pf_empty && cs_active &&
+                          (tx_ready || (pf_frame_start && pf_idle_taken));
+            
+            always @(posedge clk) begin
+                read_data_reg <= memory[fetch_addr];
+            end
+            
+            always @(posedge clk) begin
+                if (rst) begin
+                    cs_active_d <= 0;
+                    pf_idle_taken <= 0;
+                end else begin
+                    cs_active_d <= cs_active;
+                    if (cs_active || pf_restart)
+                        pf_idle_taken <= 0;
+                    else if (tx_ready && tx_valid)
+                        pf_idle_taken <= 1;  // Head is stable: no pops while CS is high
+                end
+            end
+            
+            always @(posedge clk) begin
+                if (rst) begin
+                    pf_wr <= 0;
+                    pf_rd <= 0;
+                    fetch_addr <= 0;
+                    fetch_pending <= 0;
+                end else if (pf_restart) begin
+                    // Track the address so D0 is fetched as soon as 0xFE lands
+                    pf_wr <= 0;
+                    pf_rd <= 0;
+                    fetch_addr <= address;
+                    fetch_pending <= 0;
+                end else begin
+                    if (fetch_pending) begin
+                        pf_mem[pf_wr[PF_AW-1:0]] <= read_data_reg;
+                        pf_wr <= pf_wr + 1;
+                    end
+                    if (pf_pop) begin
+                        pf_rd <= pf_rd + 1;
+                    end
+                    if (pf_fetch) begin
+                        fetch_addr <= fetch_addr + 1;
+                    end
+                    fetch_pending <= pf_fetch;
+                end
+            end
+            
+            // Outside read mode MISO echoes the word at the address, as for
+            // PREFETCH = 0. With the FIFO empty in read mode tx_valid drops, so
+            // the load during CS high waits for the next word instead of
+            // repeating one.
+            assign tx_data = (read_mode && !pf_empty) ? pf_mem[pf_rd[PF_AW-1:0]] : read_data_reg;
+            assign tx_valid = !(read_mode && pf_empty);
+        end
+    endgenerate
     
     // =========================================================================
     // Output Assignments
     // =========================================================================
-    assign tx_data = read_data_reg;
-    assign tx_valid = 1'b1;      // Always have data to send
     assign rx_ready = 1'b1;      // Always ready to accept data
 
 endmodule
@@ -0,0 +1,395 @@
+// Command-Framed SPI BRAM Controller
+// Protocol: [CMD][ADDR x ADDR_BYTES][LEN_HI][LEN_LO][PAYLOAD]...
+//   CMD=0x00: Read   - one turnaround byte, then LEN words on MISO
+//   CMD=0x01: Write  - LEN words on MOSI, stored at ADDR, ADDR+1, ...
+//   CMD=0x02: Fill   - one value word; ADDR..ADDR+LEN-1 are set to it
+//   CMD=0x03: Copy   - source address (ADDR_BYTES); LEN words are copied
+//                      from it to ADDR (overlapping ranges are safe, also
+//                      across the wrap at MEM_DEPTH, unless they overlap
+//                      at both ends)
+// Address and length are MSB first; addresses count DATA_WIDTH words and
+// wrap at MEM_DEPTH, LEN is 1-65535 (0 does nothing). Words go MSB first,
+// DATA_WIDTH/8 bytes each. Nothing is sent in-band, so every data value
+// can be stored.
+//
+// Fill and copy run inside the FPGA, one word per clock, once their last
+// payload byte has arrived. The first MISO byte of every frame is a status
+// byte (bit 0: fill/copy still running) and the rest of MISO is 0xFF
+// outside read data. Frames that start while busy are ignored, so the
+// host polls with a one-byte frame (e.g. 0xFF, not a command) until bit 0
+// clears.
+//
+// Reads run ahead of the SPI side into a FIFO_DEPTH-word FIFO, one word
+// per clock, starting when the header completes. A word that has not
+// arrived by its first byte boundary goes out as 0xFF and is dropped when
+// it does, so later words stay aligned.
+//
+// SPI Mode 0: CPOL=0, CPHA=0, through the spi_slave byte engine
+
+module spi_bram_framed #(
+    parameter DATA_WIDTH = 8,      // Memory word width: 8, 16, or 32 bits
+    parameter MEM_DEPTH = 1024,    // Words, power of 2
+    parameter ADDR_WIDTH = $clog2(MEM_DEPTH),
+    parameter ADDR_BYTES = (ADDR_WIDTH + 7) / 8,   // Address bytes in the header
+    parameter FIFO_DEPTH = 4       // Read-ahead words, power of 2
+)(
+    input wire clk,
+    input wire rst,
+    
+    // SPI Interface
+    input wire spi_sclk,
+    input wire spi_mosi,
+    output wire spi_miso,
+    input wire spi_cs_n,
+    
+    // Status
+    output wire busy              // Fill or copy running
+);
+
+    // =========================================================================
+    // Parameter Validation
+    // =========================================================================
+    initial begin
+        if (DATA_WIDTH != 8 && DATA_WIDTH != 16 && DATA_WIDTH != 32) begin
+            $error("DATA_WIDTH must be 8, 16, or 32");
+            $finish;
+        end
+        if ((1 << ADDR_WIDTH) != MEM_DEPTH) begin
+            $error("MEM_DEPTH must be a power of 2");
+            $finish;
+        end
+        if (ADDR_BYTES < 1 || ADDR_BYTES > 4 || ADDR_BYTES * 8 < ADDR_WIDTH) begin
+            $error("ADDR_BYTES must be 1-4 and cover ADDR_WIDTH");
+            $finish;
+        end
+    end
+    
+    localparam CMD_READ = 8'h00;
+    localparam CMD_WRITE = 8'h01;
+    localparam CMD_FILL = 8'h02;
+    localparam CMD_COPY = 8'h03;
+    
+    localparam BYTES = DATA_WIDTH / 8;
+    localparam HDR = ADDR_BYTES + 3;             // CMD + ADDR + LEN bytes
+    localparam CW = $clog2(FIFO_DEPTH) + 1;      // FIFO count width
+    
+    // =========================================================================
+    // Memory: one write port, one synchronous read port
+    // =========================================================================
+    reg [DATA_WIDTH-1:0] memory [0:MEM_DEPTH-1];
+    reg [DATA_WIDTH-1:0] mem_rd_data;
+    wire [ADDR_WIDTH-1:0] mem_rd_addr;
+    wire [ADDR_WIDTH-1:0] mem_wr_addr;
+    wire [DATA_WIDTH-1:0] mem_wr_data;
+    wire mem_we;
+    
+    integer i;
+    initial begin
+        for (i = 0; i < MEM_DEPTH; i = i + 1) begin
+            memory[i] = 0;
+        end
+    end
+    
+    always @(posedge clk) begin
+        if (mem_we)
+            memory[mem_wr_addr] <= mem_wr_data;
+        mem_rd_data <= memory[mem_rd_addr];
+    end
+    
+    // =========================================================================
+    // SPI byte engine
+    // =========================================================================
+    wire [7:0] rx_data;
+    wire rx_valid;
+    wire [7:0] tx_data;
+    wire tx_ready;
+    wire spi_cs_active;
+    
+    spi_slave #(
+        .TRANSFER_WIDTH(8)
+    ) spi_inst (
+        .clk(clk),
+        .rst(rst),
+        .spi_sclk(spi_sclk),
+        .spi_mosi(spi_mosi),
+        .spi_miso(spi_miso),
+        .spi_cs_n(spi_cs_n),
+        .rx_data(rx_data),
+        .rx_valid(rx_valid),
+        .rx_ready(1'b1),
+        .tx_data(tx_data),
+        .tx_valid(1'b1),                         // Always a byte to send (status/0xFF filler)
+        .tx_ready(tx_ready),
+        .cs_active(spi_cs_active)
+    );
+    
+    // =========================================================================
+    // Read-ahead FIFO
+    // =========================================================================
+    wire [DATA_WIDTH-1:0] fifo_rd_data;
+    wire fifo_rd_valid;
+    wire fifo_rd_ready;
+    wire [CW-1:0] fifo_count;
+    reg fetch_pending;        // Memory read issued last clock
+    
+    fifo_sync #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .DEPTH(FIFO_DEPTH)
+    ) fifo_inst (
+        .clk(clk),
+        .rst_n(!rst),
+        .wr_data(mem_rd_data),
+        .wr_valid(fetch_pending),
+        .wr_ready(),
+        .rd_data(fifo_rd_data),
+        .rd_valid(fifo_rd_valid),
+        .rd_ready(fifo_rd_ready),
+        .full(),
+        .empty(),
+        .almost_full(),
+        .almost_empty(),
+        .count(fifo_count)
+    );
+    
+    // =========================================================================
+    // Frame header and SPI-side data registers
+    // =========================================================================
+    reg [3:0] hdr_count;      // Bytes received, saturates at HDR + 1
+    reg cmd_ok;
+    reg [7:0] cmd;
+    reg [31:0] hdr_addr;
+    reg [7:0] len_hi;
+    reg [15:0] hdr_len;
+    reg [31:0] arg;           // Fill value or copy source
+    reg [2:0] arg_count;      // Payload bytes of arg received
+    reg eng_req;              // Fill/copy payload complete, start the engine
+    
+    reg [ADDR_WIDTH-1:0] wr_addr;
+    reg [DATA_WIDTH-1:0] rx_word;
+    reg [1:0] rx_byte;        // Byte of the current write word
+    reg [15:0] rx_left;       // Write words still expected
+    reg rx_push;
+    
+    reg rd_run;               // Read frame: fetch into the FIFO
+    reg [ADDR_WIDTH-1:0] fetch_addr;
+    reg [15:0] fetch_left;    // Words still to fetch
+    reg [1:0] tx_byte;        // Byte of the current read word
+    reg tx_fill;              // Current read word is an 0xFF stand-in
+    reg [15:0] tx_left;       // Read words not yet started
+    reg [15:0] skip;          // Stand-in words whose data is still to come
+    
+    wire cmd_read = (cmd == CMD_READ);
+    wire cmd_write = (cmd == CMD_WRITE);
+    wire cmd_fill = (cmd == CMD_FILL);
+    wire [2:0] arg_bytes = cmd_fill ? BYTES : ADDR_BYTES;
+    
+    wire [DATA_WIDTH+7:0] rx_word_next = {rx_word, rx_data};
+    
+    // At a byte boundary spi_slave takes tx_data for the byte after the
+    // last one received; read data starts after the turnaround byte
+    wire tx_data_phase = spi_cs_active && cmd_ok && cmd_read && (hdr_count == HDR + 1);
+    wire tx_word_start = (tx_byte == 0);
+    wire tx_start_ok = fifo_rd_valid && (skip == 0) && (tx_left != 0);
+    wire tx_real = tx_word_start ? tx_start_ok : !tx_fill;
+    wire tx_boundary = spi_cs_active && tx_ready && tx_data_phase;
+    wire [DATA_WIDTH-1:0] tx_word = fifo_rd_data << {tx_byte, 3'b000};
+    
+    // While CS is high spi_slave keeps reloading the first byte: status
+    assign tx_data = !spi_cs_active ? {7'b0, busy} :
+                     (tx_data_phase && tx_real) ? tx_word[DATA_WIDTH-1 -: 8] : 8'hFF;
+    
+    wire tx_pop = tx_boundary && tx_real && (tx_byte == BYTES - 1);
+    wire skip_inc = tx_boundary && tx_word_start && !tx_start_ok && (tx_left != 0);
+    wire skip_pop = (skip != 0) && fifo_rd_valid;
+    
+    // Reads only run ahead as far as the FIFO can hold
+    wire fetch_issue = rd_run && spi_cs_active && (fetch_left != 0) &&
+                       (fifo_count + fetch_pending < FIFO_DEPTH);
+    
+    // Left-over read-ahead words are drained between frames and during the
+    // next header
+    assign fifo_rd_ready = tx_pop || skip_pop || !rd_run;
+    
+    // =========================================================================
+    // SPI Frame Logic
+    // =========================================================================
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            hdr_count <= 0;
+            cmd_ok <= 0;
+            cmd <= 0;
+            hdr_addr <= 0;
+            len_hi <= 0;
+            hdr_len <= 0;
+            arg <= 0;
+            arg_count <= 0;
+            eng_req <= 0;
+            wr_addr <= 0;
+            rx_word <= 0;
+            rx_byte <= 0;
+            rx_left <= 0;
+            rx_push <= 0;
+            rd_run <= 0;
+            fetch_addr <= 0;
+            fetch_left <= 0;
+            fetch_pending <= 0;
+            tx_byte <= 0;
+            tx_fill <= 0;
+            tx_left <= 0;
+            skip <= 0;
+        end else begin
+            eng_req <= 0;
+            rx_push <= 0;
+            fetch_pending <= fetch_issue;
+            
+            // Write word assembled last clock
+            if (rx_push)
+                wr_addr <= wr_addr + 1;
+            
+            if (fetch_issue) begin
+                fetch_addr <= fetch_addr + 1;
+                fetch_left <= fetch_left - 1;
+            end
+            
+            if (!spi_cs_active) begin
+                // Reset when CS goes inactive
+                hdr_count <= 0;
+                arg_count <= 0;
+                rx_byte <= 0;
+                rd_run <= 0;
+                tx_byte <= 0;
+                tx_fill <= 0;
+                skip <= 0;
+            end else begin
+                if (rx_valid) begin
+                    if (hdr_count != HDR + 1)
+                        hdr_count <= hdr_count + 1;
+                    
+                    if (hdr_count == 0) begin
+                        // Anything else (or a frame while busy) is ignored
+                        cmd_ok <= (rx_data <= CMD_COPY) && !busy;
+                        cmd <= rx_data;
+                    end else if (hdr_count <= ADDR_BYTES) begin
+                        hdr_addr <= {hdr_addr[23:0], rx_data};
+                    end else if (hdr_count == HDR - 2) begin
+                        len_hi <= rx_data;
+                    end else if (hdr_count == HDR - 1) begin
+                        hdr_len <= {len_hi, rx_data};
+                        wr_addr <= hdr_addr[ADDR_WIDTH-1:0];
+                        rx_left <= {len_hi, rx_data};
+                        fetch_addr <= hdr_addr[ADDR_WIDTH-1:0];
+                        fetch_left <= {len_hi, rx_data};
+                        tx_left <= {len_hi, rx_data};
+                        rd_run <= cmd_ok && cmd_read;
+                    end else if (cmd_write) begin
+                        // Write data: assemble words MSB first
+                        rx_word <= rx_word_next[DATA_WIDTH-1:0];
+                        if (rx_byte == BYTES - 1) begin
+                            rx_byte <= 0;
+                            if (rx_left != 0) begin
+                                rx_push <= cmd_ok;
+                                rx_left <= rx_left - 1;
+                            end
+                        end else begin
+                            rx_byte <= rx_byte + 1;
+                        end
+                    end else if (!cmd_read && arg_count != arg_bytes) begin
+                        // Fill value or copy source, MSB first
+                        arg <= {arg[23:0], rx_data};
+                        arg_count <= arg_count + 1;
+                        if (arg_count == arg_bytes - 1)
+                            eng_req <= cmd_ok && (hdr_len != 0);
+                    end
+                end
+                
+                // Read data: advance one byte per boundary
+                if (tx_boundary) begin
+                    if (tx_word_start && tx_left != 0)
+                        tx_left <= tx_left - 1;
+                    if (tx_byte == BYTES - 1) begin
+                        tx_byte <= 0;
+                        tx_fill <= 0;
+                    end else begin
+                        tx_byte <= tx_byte + 1;
+                        if (tx_word_start)
+                            tx_fill <= !tx_start_ok;
+                    end
+                end
+                
+                skip <= skip + skip_inc - skip_pop;
+            end
+        end
+    end
+    
+    // =========================================================================
+    // Fill / Copy Engine
+    // =========================================================================
+    reg eng_run;
+    reg eng_copy;
+    reg eng_down;             // Copy from the top (destination inside the source range)
+    reg [15:0] eng_left;      // Words still to issue
+    reg [ADDR_WIDTH-1:0] eng_src;
+    reg [ADDR_WIDTH-1:0] eng_dst;
+    reg [DATA_WIDTH-1:0] eng_value;
+    reg cp_valid;             // Copy word read last clock, write it now
+    reg [ADDR_WIDTH-1:0] cp_dst;
+    
+    wire eng_step = eng_run && (eng_left != 0);
+    wire fill_we = eng_step && !eng_copy;
+    wire [ADDR_WIDTH-1:0] eng_last = hdr_len - 1'b1;
+    wire [ADDR_WIDTH-1:0] req_src = arg[ADDR_WIDTH-1:0];
+    wire [ADDR_WIDTH-1:0] req_dst = hdr_addr[ADDR_WIDTH-1:0];
+    wire [ADDR_WIDTH-1:0] req_delta = req_dst - req_src;   // Modulo MEM_DEPTH
+    
+    assign busy = eng_run;
+    
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            eng_run <= 0;
+            eng_copy <= 0;
+            eng_down <= 0;
+            eng_left <= 0;
+            eng_src <= 0;
+            eng_dst <= 0;
+            eng_value <= 0;
+            cp_valid <= 0;
+            cp_dst <= 0;
+        end else if (eng_req) begin
+            eng_run <= 1;
+            eng_copy <= !cmd_fill;
+            eng_value <= arg[DATA_WIDTH-1:0];
+            eng_left <= hdr_len;
+            // A copy whose destination starts inside the source range (counted
+            // around the wrap) must read each word before it is overwritten,
+            // so it runs from the last word down
+            if (!cmd_fill && req_delta != 0 && req_delta < hdr_len) begin
+                eng_down <= 1;
+                eng_src <= req_src + eng_last;
+                eng_dst <= req_dst + eng_last;
+            end else begin
+                eng_down <= 0;
+                eng_src <= req_src;
+                eng_dst <= req_dst;
+            end
+        end else if (eng_run) begin
+            cp_valid <= eng_copy && eng_step;
+            cp_dst <= eng_dst;
+            if (eng_step) begin
+                eng_left <= eng_left - 1;
+                eng_src <= eng_down ? eng_src - 1'b1 : eng_src + 1'b1;
+                eng_dst <= eng_down ? eng_dst - 1'b1 : eng_dst + 1'b1;
+            end
+            if (eng_left == 0 && !cp_valid)
+                eng_run <= 0;
+        end
+    end
+    
+    // =========================================================================
+    // Memory port sharing (SPI frames and the engine never overlap)
+    // =========================================================================
+    assign mem_rd_addr = (eng_run && eng_copy) ? eng_src : fetch_addr;
+    assign mem_we = rx_push || fill_we || cp_valid;
+    assign mem_wr_addr = rx_push ? wr_addr : (cp_valid ? cp_dst : eng_dst);
+    assign mem_wr_data = rx_push ? rx_word : (cp_valid ? mem_rd_data : eng_value);
+
+endmodule
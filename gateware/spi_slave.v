@@ -15,11 +15,18 @@
 // Interface:
 // - RX: rx_data, rx_valid (strobed when word complete), rx_ready (backpressure)
 // - TX: tx_data, tx_valid (load next word), tx_ready (module ready for data)
+// - cs_active: synchronized chip select, high while a frame is in progress
 //
 // Timing:
 // - Sample MOSI on rising edge of SCLK (after synchronization)
 // - Shift MISO on falling edge of SCLK to ensure stable data for master sampling
-// - TX data must be loaded BEFORE CS goes active (during CS high time)
+// - First TX word must be loaded BEFORE CS goes active (during CS high time)
+// - Later words in the same frame are taken at each word boundary: tx_ready
+//   pulses for one cycle there and tx_data is loaded if tx_valid is high
+// - Frames can stream any number of back-to-back words: a boundary without
+//   tx_valid sends one all-ones word and the next boundary tries again
+// - A received word is held in rx_data while rx_ready is low and delivered
+//   once it rises, unless the next word completes first
 // - Maximum validated speed: 4MHz SPI clock with 27MHz system clock
 // - Speed limit due to synchronization latency (~6.75 system cycles per SPI cycle at 4MHz)
 //
@@ -27,11 +34,22 @@
 // Mode 1 masters shift on rising edge and sample on falling edge, which
 // aligns perfectly with this slave's timing.
 //
+// SCLK-domain engine (SCLK_DOMAIN = 1):
+// - Shift registers are clocked by SCLK directly and reset by CS, so the
+//   SCLK rate is no longer tied to the system clock; only completed words
+//   cross into clk (toggle synchronizer + holding register per direction)
+// - True SPI Mode 0; same rx/tx/cs_active interface as the default engine
+// - A word must last at least ~6 system clocks: (TRANSFER_WIDTH-1) SCLK
+//   periods >= 6 clk periods, e.g. 8-bit words up to ~24MHz at 27MHz clk
+// - CS must fall at least 3 system clocks before the first SCLK edge
+// - spi_sclk has to be routed as a clock and constrained in the .sdc
+//
 // Author: Generated for Papilio RetroCade Wishbone Bus Project
 // Date: 2025-12-31
 
 module spi_slave #(
-    parameter TRANSFER_WIDTH = 8  // 8, 16, or 32 bits per transfer
+    parameter TRANSFER_WIDTH = 8,  // 8, 16, or 32 bits per transfer
+    parameter SCLK_DOMAIN = 0      // 1: shift registers clocked by SCLK
 )(
     // System clock and reset
     input wire clk,           // System clock (e.g., 27MHz)
@@ -51,7 +69,10 @@ module spi_slave #(
     // Transmit Interface (system clock domain)
     input wire [TRANSFER_WIDTH-1:0] tx_data,  // Data to transmit
     input wire tx_valid,                       // Load tx_data when high
-    output reg tx_ready                        // Module ready for new tx_data
+    output wire tx_ready,                      // Module ready for new tx_data
+    
+    // Frame status (system clock domain)
+    output wire cs_active                      // Synchronized CS, high during a frame
 );
 
     // =========================================================================
@@ -90,103 +111,302 @@ module spi_slave #(
     
     // Derived control signals
     wire spi_cs_active = !spi_cs_n_d2;
+    assign cs_active = spi_cs_active;
     wire spi_sclk_posedge = spi_sclk_d2 && !spi_sclk_d3;  // Rising edge detect
     wire spi_sclk_negedge = !spi_sclk_d2 && spi_sclk_d3;  // Falling edge detect
     
-    // =========================================================================
-    // Receive Path - Shift register and bit counter
-    // =========================================================================
-    reg [TRANSFER_WIDTH-1:0] rx_shift;  // Shift register for incoming bits
-    reg [$clog2(TRANSFER_WIDTH):0] rx_bit_count;  // Bit counter (0 to TRANSFER_WIDTH)
-    
-    always @(posedge clk) begin
-        if (rst) begin
-            rx_shift <= 0;
-            rx_bit_count <= 0;
-            rx_data <= 0;
-            rx_valid <= 0;
-        end else begin
-            rx_valid <= 0;  // Default: clear strobe
-            
-            if (!spi_cs_active) begin
-                // CS inactive - reset for next transaction
-                rx_bit_count <= 0;
-                rx_shift <= 0;
-            end else if (spi_sclk_posedge) begin
-                // Sample MOSI on rising edge of SCLK
-                rx_shift <= {rx_shift[TRANSFER_WIDTH-2:0], spi_mosi_d2};
-                rx_bit_count <= rx_bit_count + 1;
-                
-                // Check if word is complete
-                if (rx_bit_count == TRANSFER_WIDTH - 1) begin
-                    // Word complete - output to application
-                    rx_data <= {rx_shift[TRANSFER_WIDTH-2:0], spi_mosi_d2};
-                    rx_valid <= rx_ready;  // Only assert valid if application ready
-                    rx_bit_count <= 0;     // Reset for next word
+    generate
+        if (SCLK_DOMAIN == 0) begin : g_oversampled
+            // =================================================================
+            // Receive Path - Shift register and bit counter
+            // =================================================================
+            reg [TRANSFER_WIDTH-1:0] rx_shift;  // Shift register for incoming bits
+            reg [$clog2(TRANSFER_WIDTH):0] rx_bit_count;  // Bit counter (0 to TRANSFER_WIDTH)
+            reg rx_pending;                     // rx_data holds a word not yet delivered
+            
+            always @(posedge clk) begin
+                if (rst) begin
+                    rx_shift <= 0;
+                    rx_bit_count <= 0;
+                    rx_data <= 0;
+                    rx_valid <= 0;
+                    rx_pending <= 0;
+                end else begin
+                    rx_valid <= 0;  // Default: clear strobe
+                    
+                    // rx_data is the second RX buffer: a word the application
+                    // was not ready for waits there until rx_ready rises or
+                    // the next word completes
+                    if (rx_pending && rx_ready) begin
+                        rx_valid <= 1;
+                        rx_pending <= 0;
+                    end
+                    
+                    if (!spi_cs_active) begin
+                        // CS inactive - reset for next transaction
+                        rx_bit_count <= 0;
+                        rx_shift <= 0;
+                    end else if (spi_sclk_posedge) begin
+                        // Sample MOSI on rising edge of SCLK
+                        rx_shift <= {rx_shift[TRANSFER_WIDTH-2:0], spi_mosi_d2};
+                        rx_bit_count <= rx_bit_count + 1;
+                        
+                        // Check if word is complete
+                        if (rx_bit_count == TRANSFER_WIDTH - 1) begin
+                            // Word complete - output to application
+                            rx_data <= {rx_shift[TRANSFER_WIDTH-2:0], spi_mosi_d2};
+                            rx_valid <= rx_ready;  // Only assert valid if application ready
+                            rx_pending <= !rx_ready;
+                            rx_bit_count <= 0;     // Reset for next word
+                        end
+                    end
                 end
             end
-        end
-    end
-    
-    // =========================================================================
-    // Transmit Path - Shift register and control
-    // =========================================================================
-    reg [TRANSFER_WIDTH-1:0] tx_shift;  // Shift register for outgoing bits
-    reg [$clog2(TRANSFER_WIDTH):0] tx_bit_count;  // Bit counter
-    reg tx_data_loaded;                 // Flag: tx_shift loaded with data
-    reg first_bit_sent;                 // Flag: skip first falling edge after load
-    
-    // MISO output - drive MSB of shift register
-    assign spi_miso = tx_shift[TRANSFER_WIDTH-1];
-    
-    always @(posedge clk) begin
-        if (rst) begin
-            tx_shift <= {TRANSFER_WIDTH{1'b1}};  // Default to all 1's
-            tx_bit_count <= 0;
-            tx_data_loaded <= 0;
-            first_bit_sent <= 0;
-            tx_ready <= 1;  // Ready for data initially
-        end else begin
-            if (!spi_cs_active) begin
-                // CS inactive - prepare for next transaction
-                // Reset ready flag so new data can be loaded
-                if (!tx_ready) begin
-                    tx_ready <= 1;
+            
+            // =================================================================
+            // Transmit Path - Shift register and control
+            // =================================================================
+            reg [TRANSFER_WIDTH-1:0] tx_shift;  // Shift register for outgoing bits
+            reg [$clog2(TRANSFER_WIDTH):0] tx_bit_count;  // Bit counter
+            reg tx_data_loaded;                 // Flag: tx_shift loaded with data (not filler)
+            reg first_bit_sent;                 // Flag: skip first falling edge of the frame
+            reg tx_ready_reg;                   // Idle-time load handshake
+            
+            // Falling edge that completes the current word - the next word can be
+            // loaded here without disturbing the bit timing of the frame
+            wire tx_word_done = spi_cs_active && spi_sclk_negedge &&
+                                first_bit_sent && (tx_bit_count == TRANSFER_WIDTH - 1);
+            
+            // During a frame, only accept data at word boundaries
+            assign tx_ready = spi_cs_active ? tx_word_done : tx_ready_reg;
+            
+            // MISO output - drive MSB of shift register
+            assign spi_miso = tx_shift[TRANSFER_WIDTH-1];
+            
+            always @(posedge clk) begin
+                if (rst) begin
+                    tx_shift <= {TRANSFER_WIDTH{1'b1}};  // Default to all 1's
+                    tx_bit_count <= 0;
+                    tx_data_loaded <= 0;
+                    first_bit_sent <= 0;
+                    tx_ready_reg <= 1;  // Ready for data initially
+                end else begin
+                    if (!spi_cs_active) begin
+                        // CS inactive - prepare for next transaction
+                        // Reset ready flag so new data can be loaded
+                        if (!tx_ready_reg) begin
+                            tx_ready_reg <= 1;
+                        end
+                        
+                        // Load new data if available
+                        if (tx_valid && tx_ready_reg) begin
+                            tx_shift <= tx_data;
+                            tx_data_loaded <= 1;
+                            tx_ready_reg <= 0;
+                        end else if (!tx_data_loaded) begin
+                            // No new data, preload with all 1's (idle state)
+                            tx_shift <= {TRANSFER_WIDTH{1'b1}};
+                        end
+                        tx_bit_count <= 0;
+                        first_bit_sent <= 0;
+                    end else begin
+                        // CS active - transaction in progress
+                        // Shift out on falling edge of SCLK. Filler words shift
+                        // too, so the word boundaries stay aligned and a frame
+                        // can stream any number of words.
+                        if (spi_sclk_negedge) begin
+                            if (!first_bit_sent) begin
+                                // Skip first falling edge - MSB already output
+                                first_bit_sent <= 1;
+                            end else begin
+                                // Shift left, new bit on LSB doesn't matter
+                                tx_shift <= {tx_shift[TRANSFER_WIDTH-2:0], 1'b0};
+                                tx_bit_count <= tx_bit_count + 1;
+                                
+                                // Check if word transmission complete
+                                if (tx_bit_count == TRANSFER_WIDTH - 1) begin
+                                    tx_bit_count <= 0;
+                                    // Next word in the same frame; this edge stands in
+                                    // for the skipped first edge, so keep first_bit_sent
+                                    if (tx_valid) begin
+                                        tx_shift <= tx_data;
+                                        tx_data_loaded <= 1;
+                                    end else begin
+                                        // Nothing queued: send an all-ones word and
+                                        // try again at the next boundary
+                                        tx_shift <= {TRANSFER_WIDTH{1'b1}};
+                                        tx_data_loaded <= 0;
+                                    end
+                                end
+                            end
+                        end
+                    end
                 end
-                
-                // Load new data if available
-                if (tx_valid && tx_ready) begin
-                    tx_shift <= tx_data;
-                    tx_data_loaded <= 1;
-                    tx_ready <= 0;
-                end else if (!tx_data_loaded) begin
-                    // No new data, preload with all 1's (idle state)
-                    tx_shift <= {TRANSFER_WIDTH{1'b1}};
+            end
+        end else begin : g_sclk_domain
+            // =================================================================
+            // SCLK-domain shift engine (SCLK_DOMAIN = 1)
+            // Shift registers run on SCLK itself (Mode 0: sample on rising,
+            // shift on falling) and are cleared asynchronously while CS is
+            // high. Only whole words cross into clk, through toggle
+            // handshakes: the holding registers on either side are stable
+            // for a full word time while the other side reads them.
+            // =================================================================
+            
+            // -----------------------------------------------------------------
+            // Receive Path (SCLK domain)
+            // -----------------------------------------------------------------
+            reg [TRANSFER_WIDTH-1:0] rx_shift;
+            reg [$clog2(TRANSFER_WIDTH):0] rx_bit_count;
+            reg [TRANSFER_WIDTH-1:0] rx_hold;   // Last complete word
+            reg rx_toggle = 1'b0;               // Flips once per word (never reset)
+            
+            wire [TRANSFER_WIDTH-1:0] rx_word = {rx_shift[TRANSFER_WIDTH-2:0], spi_mosi};
+            wire rx_word_done = (rx_bit_count == TRANSFER_WIDTH - 1);
+            
+            always @(posedge spi_sclk or posedge spi_cs_n) begin
+                if (spi_cs_n) begin
+                    rx_bit_count <= 0;
+                    rx_shift <= 0;
+                end else begin
+                    rx_shift <= rx_word;
+                    rx_bit_count <= rx_word_done ? 0 : rx_bit_count + 1;
                 end
-                tx_bit_count <= 0;
-                first_bit_sent <= 0;
-            end else begin
-                // CS active - transaction in progress
-                // Shift out on falling edge of SCLK
-                if (spi_sclk_negedge && tx_data_loaded) begin
-                    if (!first_bit_sent) begin
-                        // Skip first falling edge - MSB already output
-                        first_bit_sent <= 1;
+            end
+            
+            always @(posedge spi_sclk) begin
+                if (!spi_cs_n && rx_word_done) begin
+                    rx_hold <= rx_word;
+                    rx_toggle <= ~rx_toggle;
+                end
+            end
+            
+            // -----------------------------------------------------------------
+            // Receive Path (clk domain) - one rx_valid per toggle
+            // -----------------------------------------------------------------
+            reg rx_toggle_d1, rx_toggle_d2, rx_toggle_d3;
+            reg rx_pending;                     // rx_data holds a word not yet delivered
+            
+            always @(posedge clk) begin
+                if (rst) begin
+                    rx_toggle_d1 <= 0;
+                    rx_toggle_d2 <= 0;
+                    rx_toggle_d3 <= 0;
+                    rx_data <= 0;
+                    rx_valid <= 0;
+                    rx_pending <= 0;
+                end else begin
+                    rx_toggle_d1 <= rx_toggle;
+                    rx_toggle_d2 <= rx_toggle_d1;
+                    rx_toggle_d3 <= rx_toggle_d2;
+                    
+                    rx_valid <= 0;  // Default: clear strobe
+                    if (rx_pending && rx_ready) begin
+                        rx_valid <= 1;         // Held word, as in the oversampled engine
+                        rx_pending <= 0;
+                    end
+                    if (rx_toggle_d2 != rx_toggle_d3) begin
+                        rx_data <= rx_hold;    // Stable until the next word completes
+                        rx_valid <= rx_ready;  // Only assert valid if application ready
+                        rx_pending <= !rx_ready;
+                    end
+                end
+            end
+            
+            // -----------------------------------------------------------------
+            // Transmit Path (clk domain) - holding register
+            // -----------------------------------------------------------------
+            reg [TRANSFER_WIDTH-1:0] tx_hold;   // Next word for the SCLK side
+            reg tx_hold_peek;                   // tx_hold mirrors tx_data, not yet popped
+            reg tx_refresh;                     // Reload tx_hold this cycle
+            reg tx_ready_reg;                   // Idle-time load handshake
+            reg tx_toggle = 1'b0;               // SCLK side: flips when tx_hold is copied
+            reg tx_toggle_d1, tx_toggle_d2, tx_toggle_d3;
+            
+            // tx_hold was just copied into the shift register; the SCLK side
+            // now shifts out the remaining W-1 bits before it looks again
+            wire tx_taken = spi_cs_active && (tx_toggle_d2 != tx_toggle_d3);
+            
+            // Inside a frame a word is only popped once it has actually been
+            // clocked out, so ending the frame never drops queued data
+            assign tx_ready = spi_cs_active ? (tx_taken && tx_hold_peek) : tx_ready_reg;
+            
+            always @(posedge clk) begin
+                if (rst) begin
+                    tx_hold <= {TRANSFER_WIDTH{1'b1}};
+                    tx_hold_peek <= 0;
+                    tx_refresh <= 0;
+                    tx_ready_reg <= 1;
+                    tx_toggle_d1 <= 0;
+                    tx_toggle_d2 <= 0;
+                    tx_toggle_d3 <= 0;
+                end else begin
+                    tx_toggle_d1 <= tx_toggle;
+                    tx_toggle_d2 <= tx_toggle_d1;
+                    tx_toggle_d3 <= tx_toggle_d2;
+                    
+                    if (!spi_cs_active) begin
+                        // Same idle loading as the oversampled engine
+                        if (!tx_ready_reg) begin
+                            tx_ready_reg <= 1;
+                        end
+                        if (tx_valid && tx_ready_reg) begin
+                            tx_hold <= tx_data;
+                            tx_ready_reg <= 0;
+                        end
+                        tx_hold_peek <= 0;
+                        tx_refresh <= 0;
                     end else begin
-                        // Shift left, new bit on LSB doesn't matter
-                        tx_shift <= {tx_shift[TRANSFER_WIDTH-2:0], 1'b0};
-                        tx_bit_count <= tx_bit_count + 1;
-                        
-                        // Check if word transmission complete
-                        if (tx_bit_count == TRANSFER_WIDTH - 1) begin
-                            tx_data_loaded <= 0;
-                            tx_ready <= 1;  // Ready for next word
-                            tx_bit_count <= 0;
+                        // Sample the next word one cycle after the pop, once the
+                        // source has presented it; tx_hold is stable otherwise,
+                        // so the SCLK side never copies a changing word
+                        tx_refresh <= tx_taken;
+                        if (tx_refresh) begin
+                            tx_hold <= tx_valid ? tx_data : {TRANSFER_WIDTH{1'b1}};
+                            tx_hold_peek <= tx_valid;
                         end
                     end
                 end
             end
+            
+            // -----------------------------------------------------------------
+            // Transmit Path (SCLK domain)
+            // -----------------------------------------------------------------
+            reg [TRANSFER_WIDTH-1:0] tx_shift;
+            reg [$clog2(TRANSFER_WIDTH):0] tx_bit_count;
+            reg tx_started;                     // MSB has been clocked, shifting from tx_shift
+            
+            // At each word boundary (and at the start of a frame) MISO shows the
+            // MSB straight from tx_hold. tx_hold is only copied - and the word
+            // popped - once the master clocks past that bit, so the trailing
+            // SCLK edge of a frame never drops a word.
+            always @(negedge spi_sclk or posedge spi_cs_n) begin
+                if (spi_cs_n) begin
+                    tx_bit_count <= 0;
+                    tx_started <= 0;
+                end else if (!tx_started) begin
+                    // MSB went out from tx_hold; continue with bit W-2
+                    tx_shift <= {tx_hold[TRANSFER_WIDTH-2:0], 1'b0};
+                    tx_bit_count <= 1;
+                    tx_started <= 1;
+                end else if (tx_bit_count == TRANSFER_WIDTH - 1) begin
+                    tx_bit_count <= 0;
+                    tx_started <= 0;            // Next word's MSB from tx_hold
+                end else begin
+                    tx_shift <= {tx_shift[TRANSFER_WIDTH-2:0], 1'b0};
+                    tx_bit_count <= tx_bit_count + 1;
+                end
+            end
+            
+            always @(negedge spi_sclk) begin
+                if (!spi_cs_n && !tx_started) begin
+                    tx_toggle <= ~tx_toggle;
+                end
+            end
+            
+            // MISO comes straight from tx_hold until the MSB has been clocked
+            assign spi_miso = tx_started ? tx_shift[TRANSFER_WIDTH-1] : tx_hold[TRANSFER_WIDTH-1];
         end
-    end
+    endgenerate
 
 endmodule
@@ -0,0 +1,368 @@
+// =============================================================================
+// SPI Slave with CRC-Checked FIFO Frames
+// Part of papilio_hdl_blocks library
+// =============================================================================
+//
+// Variant of spi_slave_fifo with a link layer: every data burst carries a
+// CRC-16 and is only committed to (or released from) the FIFOs once it has
+// been checked, so the master can retransmit failed frames and run SCLK
+// closer to the edge. Same application-side ports as spi_slave_fifo.
+//
+// CRC: CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection, no final
+// XOR) over the data words MSB first. CRC_WORDS = 2 for 8-bit words (high
+// byte first), 1 otherwise (CRC in the low 16 bits, upper bits zero).
+//
+// Frame format (every frame starts with a header word, W = TRANSFER_WIDTH):
+//   Word 0   MOSI command {write, seq, count[W-3:0]}
+//            MISO status  {rx_almost_full, rd_seq, wr_seq, tx_level[W-4:0]}
+//   count == 0: status only, nothing follows.
+//
+//   Write (MOSI -> RX FIFO), N = count:
+//     words 1..N       MOSI data
+//     next CRC_WORDS   MOSI CRC of the data
+//     2 pad words
+//     1 verdict word   MISO ACK (0xA5 per byte) or NAK (0x5A per byte)
+//   The data is committed when the CRC matches and every word fit. seq must
+//   equal the status wr_seq bit; a frame with the other seq is a retransmit
+//   of one that was already committed, so it is acknowledged but dropped
+//   (alternating-bit protocol - a lost ACK never duplicates data).
+//
+//   Read (TX FIFO -> MISO), N = min(count, tx_level from word 0):
+//     words 1..N       MISO data
+//     next CRC_WORDS   MISO CRC of the data
+//     1 ack word       MOSI ACK if the master's CRC matched
+//   Words are released from the TX FIFO only on ACK; otherwise the same
+//   words are sent again in the next read. rd_seq toggles on every accepted
+//   ACK so the master can tell whether its last ACK arrived.
+//
+// Words outside these fields are don't-care (MISO sends 0xFF filler).
+//
+// =============================================================================
+
+module spi_slave_crc #(
+    parameter TRANSFER_WIDTH = 8,      // SPI transfer width (8, 16, or 32)
+    parameter RX_FIFO_DEPTH = 256,     // RX FIFO depth (power of 2)
+    parameter TX_FIFO_DEPTH = 256,     // TX FIFO depth (power of 2)
+    parameter SCLK_DOMAIN = 0          // 1: SCLK-clocked shift engine (see spi_slave.v)
+) (
+    // System Interface
+    input wire clk,                    // System clock
+    input wire rst_n,                  // Active-low reset
+    
+    // SPI Interface (connect to physical pins)
+    input wire spi_sclk,               // SPI clock from master
+    input wire spi_mosi,               // SPI MOSI from master
+    output wire spi_miso,              // SPI MISO to master
+    input wire spi_cs_n,               // SPI chip select (active low)
+    
+    // RX FIFO Interface (for reading received data)
+    output wire [TRANSFER_WIDTH-1:0] rx_fifo_data,
+    output wire rx_fifo_valid,
+    input wire rx_fifo_ready,
+    output wire rx_fifo_empty,
+    output wire rx_fifo_almost_full,
+    output wire [$clog2(RX_FIFO_DEPTH):0] rx_fifo_count,
+    
+    // TX FIFO Interface (for writing data to transmit)
+    input wire [TRANSFER_WIDTH-1:0] tx_fifo_data,
+    input wire tx_fifo_valid,
+    output wire tx_fifo_ready,
+    output wire tx_fifo_full,
+    output wire tx_fifo_almost_empty,
+    output wire [$clog2(TX_FIFO_DEPTH):0] tx_fifo_count,
+    
+    // Link statistics
+    output reg [15:0] crc_errors       // Write frames rejected for a bad CRC
+);
+    
+    localparam W = TRANSFER_WIDTH;
+    localparam CRC_WORDS = (W == 8) ? 2 : 1;
+    localparam [31:0] LEVEL_MAX = (32'd1 << (W - 3)) - 1;
+    localparam [W-1:0] ACK_WORD = {(W/8){8'hA5}};
+    localparam [W-1:0] NAK_WORD = {(W/8){8'h5A}};
+    
+    // CRC-16/CCITT over one word, MSB first
+    function [15:0] crc16_word;
+        input [15:0] crc;
+        input [W-1:0] data;
+        integer i;
+        reg [15:0] c;
+        begin
+            c = crc;
+            for (i = W - 1; i >= 0; i = i - 1)
+                c = {c[14:0], 1'b0} ^ ((c[15] ^ data[i]) ? 16'h1021 : 16'h0000);
+            crc16_word = c;
+        end
+    endfunction
+    
+    // =========================================================================
+    // SPI Slave Instance
+    // =========================================================================
+    
+    wire [W-1:0] spi_rx_data;
+    wire spi_rx_valid;
+    wire [W-1:0] spi_tx_data;
+    wire spi_tx_valid;
+    wire spi_tx_ready;
+    wire spi_cs_active;
+    
+    spi_slave #(
+        .TRANSFER_WIDTH(W),
+        .SCLK_DOMAIN(SCLK_DOMAIN)
+    ) spi_inst (
+        .clk(clk),
+        .rst(!rst_n),  // spi_slave uses active-high reset
+        .spi_sclk(spi_sclk),
+        .spi_mosi(spi_mosi),
+        .spi_miso(spi_miso),
+        .spi_cs_n(spi_cs_n),
+        .rx_data(spi_rx_data),
+        .rx_valid(spi_rx_valid),
+        .rx_ready(1'b1),  // Every word is counted; overflow is reported by NAK
+        .tx_data(spi_tx_data),
+        .tx_valid(spi_tx_valid),
+        .tx_ready(spi_tx_ready),
+        .cs_active(spi_cs_active)
+    );
+    
+    // =========================================================================
+    // Transactional FIFOs
+    // =========================================================================
+    
+    wire rx_wr_valid;
+    wire rx_wr_ready;
+    reg rx_commit;
+    
+    wire [W-1:0] tx_rd_data;
+    wire tx_rd_valid;
+    wire tx_rd_ready;
+    reg tx_commit;
+    
+    reg cs_active_d;
+    wire frame_end = cs_active_d && !spi_cs_active;
+    
+    fifo_frame #(
+        .DATA_WIDTH(W),
+        .DEPTH(RX_FIFO_DEPTH),
+        .ALMOST_FULL_THRESHOLD(16),
+        .ALMOST_EMPTY_THRESHOLD(4)
+    ) rx_fifo_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        // Write side (from SPI) - committed per checked frame
+        .wr_data(spi_rx_data),
+        .wr_valid(rx_wr_valid),
+        .wr_ready(rx_wr_ready),
+        .wr_commit(rx_commit),
+        .wr_rollback(frame_end),
+        // Read side (to application)
+        .rd_data(rx_fifo_data),
+        .rd_valid(rx_fifo_valid),
+        .rd_ready(rx_fifo_ready),
+        .rd_commit(1'b1),
+        .rd_rollback(1'b0),
+        // Status
+        .full(),
+        .empty(rx_fifo_empty),
+        .almost_full(rx_fifo_almost_full),
+        .almost_empty(),  // Not used
+        .count(rx_fifo_count)
+    );
+    
+    fifo_frame #(
+        .DATA_WIDTH(W),
+        .DEPTH(TX_FIFO_DEPTH),
+        .ALMOST_FULL_THRESHOLD(16),
+        .ALMOST_EMPTY_THRESHOLD(4)
+    ) tx_fifo_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        // Write side (from application)
+        .wr_data(tx_fifo_data),
+        .wr_valid(tx_fifo_valid),
+        .wr_ready(tx_fifo_ready),
+        .wr_commit(1'b1),
+        .wr_rollback(1'b0),
+        // Read side (to SPI) - released on the master's ACK
+        .rd_data(tx_rd_data),
+        .rd_valid(tx_rd_valid),
+        .rd_ready(tx_rd_ready),
+        .rd_commit(tx_commit),
+        .rd_rollback(frame_end),
+        // Status
+        .full(tx_fifo_full),
+        .empty(),
+        .almost_full(),  // Not used
+        .almost_empty(tx_fifo_almost_empty),
+        .count(tx_fifo_count)
+    );
+    
+    // =========================================================================
+    // Frame State
+    // =========================================================================
+    
+    reg [31:0] rx_pos;                 // Words received in this frame
+    reg [31:0] tx_pos;                 // Words taken by spi_slave after word 0
+    reg cmd_valid;
+    reg cmd_write;
+    reg cmd_dup;                       // Write retransmit of a committed frame
+    reg [31:0] n_words;                // Data words in this frame
+    reg [15:0] rx_crc;
+    reg [15:0] tx_crc;
+    reg crc_ok;                        // CRC words matched so far
+    reg overflow;                      // RX FIFO refused a data word
+    reg verdict_ack;
+    reg wr_seq;                        // seq expected for the next new write
+    reg rd_seq;                        // Toggles on every accepted read ACK
+    reg [W-4:0] level_sent;            // TX level in the status word last loaded
+    
+    wire [31:0] tx_level = tx_fifo_count;
+    wire [W-4:0] tx_level_sat = (tx_level > LEVEL_MAX) ? LEVEL_MAX[W-4:0] : tx_level[W-4:0];
+    wire [W-1:0] status_word = {rx_fifo_almost_full, rd_seq, wr_seq, tx_level_sat};
+    
+    // Command fields of word 0
+    wire [31:0] rx_count = spi_rx_data[W-3:0];
+    wire [31:0] level_sent_w = level_sent;
+    
+    // RX word classification (rx_pos is the index of the word in spi_rx_data)
+    wire rx_in_data = cmd_valid && cmd_write && (rx_pos >= 1) && (rx_pos <= n_words);
+    wire rx_in_crc = cmd_valid && cmd_write && (rx_pos > n_words) && (rx_pos <= n_words + CRC_WORDS);
+    wire rx_crc_last = rx_in_crc && (rx_pos == n_words + CRC_WORDS);
+    wire rx_is_ack = cmd_valid && !cmd_write && (n_words != 0) &&
+                     (rx_pos == n_words + CRC_WORDS + 1);
+    
+    // Expected CRC word at this position
+    wire [W-1:0] rx_crc_expect;
+    generate
+        if (W == 8) begin : g_crc8
+            assign rx_crc_expect = (rx_pos == n_words + 1) ? rx_crc[15:8] : rx_crc[7:0];
+        end else begin : g_crc_wide
+            assign rx_crc_expect = {{(W-16){1'b0}}, rx_crc};
+        end
+    endgenerate
+    
+    assign rx_wr_valid = spi_rx_valid && rx_in_data && !cmd_dup;
+    
+    // TX word for the next position (tx_pos + 1); every in-frame word is
+    // marked valid so both spi_slave engines count each position
+    wire [31:0] tx_next = tx_pos + 1;
+    wire tx_serve_fifo = !cmd_valid || (!cmd_write && (tx_next <= n_words));
+    wire tx_in_crc = cmd_valid && !cmd_write && (tx_next > n_words) &&
+                     (tx_next <= n_words + CRC_WORDS);
+    wire tx_in_verdict = cmd_valid && cmd_write && (tx_next == n_words + CRC_WORDS + 3);
+    
+    wire [W-1:0] tx_crc_word;
+    generate
+        if (W == 8) begin : g_tx_crc8
+            assign tx_crc_word = (tx_next == n_words + 1) ? tx_crc[15:8] : tx_crc[7:0];
+        end else begin : g_tx_crc_wide
+            assign tx_crc_word = {{(W-16){1'b0}}, tx_crc};
+        end
+    endgenerate
+    
+    assign spi_tx_data = !spi_cs_active ? status_word :
+                         (tx_serve_fifo && tx_rd_valid) ? tx_rd_data :
+                         tx_in_crc ? tx_crc_word :
+                         tx_in_verdict ? (verdict_ack ? ACK_WORD : NAK_WORD) :
+                         {W{1'b1}};
+    assign spi_tx_valid = 1'b1;
+    assign tx_rd_ready = spi_cs_active && spi_tx_ready && tx_serve_fifo;
+    
+    // =========================================================================
+    // Link Control
+    // =========================================================================
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            cs_active_d <= 1'b0;
+            rx_pos <= 0;
+            tx_pos <= 0;
+            cmd_valid <= 1'b0;
+            cmd_write <= 1'b0;
+            cmd_dup <= 1'b0;
+            n_words <= 0;
+            rx_crc <= 16'hFFFF;
+            tx_crc <= 16'hFFFF;
+            crc_ok <= 1'b0;
+            overflow <= 1'b0;
+            verdict_ack <= 1'b0;
+            wr_seq <= 1'b0;
+            rd_seq <= 1'b0;
+            level_sent <= 0;
+            rx_commit <= 1'b0;
+            tx_commit <= 1'b0;
+            crc_errors <= 16'd0;
+        end else begin
+            cs_active_d <= spi_cs_active;
+            rx_commit <= 1'b0;
+            tx_commit <= 1'b0;
+            
+            if (!spi_cs_active) begin
+                // Between frames: FIFOs roll back whatever was not committed
+                rx_pos <= 0;
+                tx_pos <= 0;
+                cmd_valid <= 1'b0;
+                cmd_dup <= 1'b0;
+                rx_crc <= 16'hFFFF;
+                tx_crc <= 16'hFFFF;
+                crc_ok <= 1'b1;
+                overflow <= 1'b0;
+                verdict_ack <= 1'b0;
+                
+                // Remember the level the master is about to see
+                if (spi_tx_ready)
+                    level_sent <= tx_level_sat;
+            end else begin
+                // ---- TX side ----
+                if (spi_tx_ready) begin
+                    tx_pos <= tx_next;
+                    if (tx_rd_ready && tx_rd_valid)
+                        tx_crc <= crc16_word(tx_crc, tx_rd_data);
+                end
+                
+                // ---- RX side ----
+                if (spi_rx_valid) begin
+                    rx_pos <= rx_pos + 1;
+                    
+                    if (rx_pos == 0) begin
+                        cmd_valid <= 1'b1;
+                        cmd_write <= spi_rx_data[W-1];
+                        cmd_dup <= spi_rx_data[W-1] && (spi_rx_data[W-2] != wr_seq);
+                        if (spi_rx_data[W-1])
+                            n_words <= rx_count;
+                        else
+                            n_words <= (rx_count < level_sent_w) ? rx_count : level_sent_w;
+                    end
+                    
+                    if (rx_in_data) begin
+                        rx_crc <= crc16_word(rx_crc, spi_rx_data);
+                        if (!cmd_dup && !rx_wr_ready)
+                            overflow <= 1'b1;
+                    end
+                    
+                    if (rx_in_crc) begin
+                        if (spi_rx_data != rx_crc_expect)
+                            crc_ok <= 1'b0;
+                        if (rx_crc_last) begin
+                            if (crc_ok && spi_rx_data == rx_crc_expect && !overflow) begin
+                                verdict_ack <= 1'b1;
+                                if (!cmd_dup) begin
+                                    rx_commit <= 1'b1;
+                                    wr_seq <= ~wr_seq;
+                                end
+                            end else if (!(crc_ok && spi_rx_data == rx_crc_expect)) begin
+                                crc_errors <= crc_errors + 1'b1;
+                            end
+                        end
+                    end
+                    
+                    if (rx_is_ack && spi_rx_data == ACK_WORD) begin
+                        tx_commit <= 1'b1;
+                        rd_seq <= ~rd_seq;
+                    end
+                end
+            end
+        end
+    end
+
+endmodule
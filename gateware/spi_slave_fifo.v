@@ -12,6 +12,10 @@
 // - Configurable FIFO depths
 // - Ready/valid interfaces for easy integration with DMA or Wishbone
 // - Status flags for monitoring FIFO levels
+// - Optional status header so the SPI master can see FIFO levels
+// - Optional dual-clock FIFOs so the application side runs on its own clock
+// - Optional data-ready interrupt line to the SPI master
+// - Optional run-length encoding of TX data (capture streams)
 //
 // Use Cases:
 // - High-speed SPI data acquisition
@@ -19,16 +23,71 @@
 // - Buffered Wishbone-to-SPI bridge
 // - Burst SPI transactions
 //
+// Status Header (STATUS_HEADER = 1):
+// - The first word of every frame is a status exchange. MOSI word 0 is
+//   discarded; MISO word 0 is the status word:
+//     [TRANSFER_WIDTH-1]   RX FIFO almost full (master should stop writing)
+//     [TRANSFER_WIDTH-2:0] Words waiting in the TX FIFO (saturating)
+// - TX FIFO data starts with word 1 and is only popped inside a frame, so
+//   words already counted in the header are never lost between frames.
+// - The status word is refreshed continuously while CS is high.
+//
+// TX Frame Timing:
+// - The TX FIFO is only popped inside a frame. Without the status header the
+//   FIFO head is loaded while CS is high and popped when the frame starts,
+//   so N queued words come out in order as the first N words of one frame.
+//
+// Dual-Clock FIFOs (ASYNC_FIFO = 1):
+// - Both FIFOs become fifo_async; the SPI side stays on clk and the
+//   application side (rx_fifo_*/tx_fifo_* data ports) moves to app_clk
+// - Status flags live in the domain that acts on them: rx_fifo_empty,
+//   rx_fifo_count, tx_fifo_full and tx_fifo_count are app_clk;
+//   rx_fifo_almost_full and tx_fifo_almost_empty are clk
+// - app_clk is ignored when ASYNC_FIFO = 0
+//
+// Data-Ready Interrupt (IRQ_THRESHOLD > 0):
+// - irq is high while the TX FIFO holds at least IRQ_THRESHOLD words
+// - With IRQ_TIMEOUT > 0 it also rises once fewer words have waited
+//   IRQ_TIMEOUT clk cycles (bounded latency)
+// - Needs STATUS_HEADER = 1: the master sizes each drain from the header
+// - Held low while CS is active: every frame ends with irq low, and the
+//   line rises again within ~3 clk cycles if enough data is still waiting,
+//   so an edge-triggered master input never misses data
+//
+// TX Run-Length Encoding (TX_RLE = 1):
+// - An rle_encoder sits between tx_fifo_data and the TX FIFO (on app_clk
+//   with ASYNC_FIFO = 1), so repeated samples take FIFO space and SPI
+//   bandwidth only once per run; see rle_encoder.v for the format
+// - tx_fifo_count, the status header and irq count encoded words
+// - A pending run is sent after TX_RLE_FLUSH idle clocks
+// - The master expands the stream with PapilioSPI::setStreamRle(true)
+//
+// FIFO Statistics (STATS = 1, clk domain):
+// - stat_rx_overflows: words received while the RX FIFO was full (dropped)
+// - stat_tx_underflows: words the master clocked with the TX FIFO empty
+//   (oversampled engine only; the SCLK-domain engine cannot see them)
+// - stat_rx_peak/stat_tx_peak: highest FIFO level seen
+// - Counters saturate; stats_clear resets all four
+//
 // =============================================================================
 
 module spi_slave_fifo #(
     parameter TRANSFER_WIDTH = 8,      // SPI transfer width (8, 16, or 32)
     parameter RX_FIFO_DEPTH = 256,     // RX FIFO depth (power of 2)
-    parameter TX_FIFO_DEPTH = 256      // TX FIFO depth (power of 2)
+    parameter TX_FIFO_DEPTH = 256,     // TX FIFO depth (power of 2)
+    parameter STATUS_HEADER = 0,       // 1: status word leads every frame
+    parameter SCLK_DOMAIN = 0,         // 1: SCLK-clocked shift engine (see spi_slave.v)
+    parameter ASYNC_FIFO = 0,          // 1: application ports on app_clk
+    parameter IRQ_THRESHOLD = 0,       // TX words that raise irq (0: irq unused)
+    parameter IRQ_TIMEOUT = 0,         // clk cycles before fewer words raise irq (0: never)
+    parameter STATS = 0,               // 1: overflow/underflow/peak counters
+    parameter TX_RLE = 0,              // 1: run-length encode TX data
+    parameter TX_RLE_FLUSH = 64        // Idle clocks before a pending run is sent
 ) (
     // System Interface
-    input wire clk,                    // System clock
+    input wire clk,                    // System clock (SPI side)
     input wire rst_n,                  // Active-low reset
+    input wire app_clk,                // Application clock (ASYNC_FIFO = 1 only)
     
     // SPI Interface (connect to physical pins)
     input wire spi_sclk,               // SPI clock from master
@@ -50,7 +109,17 @@ module spi_slave_fifo #(
     output wire tx_fifo_ready,
     output wire tx_fifo_full,
     output wire tx_fifo_almost_empty,
-    output wire [$clog2(TX_FIFO_DEPTH):0] tx_fifo_count
+    output wire [$clog2(TX_FIFO_DEPTH):0] tx_fifo_count,
+    
+    // Data-ready interrupt to the SPI master (active high)
+    output wire irq,
+    
+    // FIFO statistics (STATS = 1, clk domain)
+    input wire stats_clear,
+    output wire [15:0] stat_rx_overflows,
+    output wire [15:0] stat_tx_underflows,
+    output wire [$clog2(RX_FIFO_DEPTH):0] stat_rx_peak,
+    output wire [$clog2(TX_FIFO_DEPTH):0] stat_tx_peak
 );
 
     // =========================================================================
@@ -64,9 +133,11 @@ module spi_slave_fifo #(
     wire [TRANSFER_WIDTH-1:0] spi_tx_data;
     wire spi_tx_valid;
     wire spi_tx_ready;
+    wire spi_cs_active;
     
     spi_slave #(
-        .TRANSFER_WIDTH(TRANSFER_WIDTH)
+        .TRANSFER_WIDTH(TRANSFER_WIDTH),
+        .SCLK_DOMAIN(SCLK_DOMAIN)
     ) spi_inst (
         .clk(clk),
         .rst(!rst_n),  // spi_slave uses active-high reset
@@ -79,67 +150,317 @@ module spi_slave_fifo #(
         .rx_ready(spi_rx_ready),
         .tx_data(spi_tx_data),
         .tx_valid(spi_tx_valid),
-        .tx_ready(spi_tx_ready)
+        .tx_ready(spi_tx_ready),
+        .cs_active(spi_cs_active)
     );
     
+    // Every received word is taken: with the RX FIFO full it is dropped at
+    // the FIFO instead of inside spi_slave, where the stats could not see it
+    assign spi_rx_ready = 1'b1;
+    
+    // FIFO side of the SPI data paths (differs from the SPI side only
+    // when the status header is enabled)
+    wire rx_wr_valid;
+    wire rx_wr_ready;
+    wire [TRANSFER_WIDTH-1:0] tx_rd_data;
+    wire tx_rd_valid;
+    wire tx_rd_ready;
+    
     // =========================================================================
-    // RX FIFO Instance (SPI → Application)
+    // TX Run-Length Encoder
     // =========================================================================
     
-    wire rx_fifo_full;
+    // Application side of the TX FIFO write port
+    wire [TRANSFER_WIDTH-1:0] tx_wr_data;
+    wire tx_wr_valid;
+    wire tx_wr_ready;
     
-    fifo_sync #(
-        .DATA_WIDTH(TRANSFER_WIDTH),
-        .DEPTH(RX_FIFO_DEPTH),
-        .ALMOST_FULL_THRESHOLD(16),
-        .ALMOST_EMPTY_THRESHOLD(4)
-    ) rx_fifo_inst (
-        .clk(clk),
-        .rst_n(rst_n),
-        // Write side (from SPI)
-        .wr_data(spi_rx_data),
-        .wr_valid(spi_rx_valid),
-        .wr_ready(spi_rx_ready),
-        // Read side (to application)
-        .rd_data(rx_fifo_data),
-        .rd_valid(rx_fifo_valid),
-        .rd_ready(rx_fifo_ready),
-        // Status
-        .full(rx_fifo_full),
-        .empty(rx_fifo_empty),
-        .almost_full(rx_fifo_almost_full),
-        .almost_empty(),  // Not used
-        .count(rx_fifo_count)
-    );
+    generate
+        if (TX_RLE) begin : g_tx_rle
+            rle_encoder #(
+                .DATA_WIDTH(TRANSFER_WIDTH),
+                .FLUSH_CYCLES(TX_RLE_FLUSH)
+            ) tx_rle_inst (
+                .clk(ASYNC_FIFO ? app_clk : clk),
+                .rst_n(rst_n),
+                .in_data(tx_fifo_data),
+                .in_valid(tx_fifo_valid),
+                .in_ready(tx_fifo_ready),
+                .out_data(tx_wr_data),
+                .out_valid(tx_wr_valid),
+                .out_ready(tx_wr_ready),
+                .flush(1'b0)
+            );
+        end else begin : g_no_tx_rle
+            assign tx_wr_data = tx_fifo_data;
+            assign tx_wr_valid = tx_fifo_valid;
+            assign tx_fifo_ready = tx_wr_ready;
+        end
+    endgenerate
     
     // =========================================================================
-    // TX FIFO Instance (Application → SPI)
+    // FIFO Instances
     // =========================================================================
     
+    wire rx_fifo_full;
     wire tx_fifo_empty;
+    wire [$clog2(RX_FIFO_DEPTH):0] rx_spi_count;  // RX level seen from the SPI side
+    wire [$clog2(TX_FIFO_DEPTH):0] tx_spi_count;  // TX level seen from the SPI side
     
-    fifo_sync #(
-        .DATA_WIDTH(TRANSFER_WIDTH),
-        .DEPTH(TX_FIFO_DEPTH),
-        .ALMOST_FULL_THRESHOLD(16),
-        .ALMOST_EMPTY_THRESHOLD(4)
-    ) tx_fifo_inst (
-        .clk(clk),
-        .rst_n(rst_n),
-        // Write side (from application)
-        .wr_data(tx_fifo_data),
-        .wr_valid(tx_fifo_valid),
-        .wr_ready(tx_fifo_ready),
-        // Read side (to SPI)
-        .rd_data(spi_tx_data),
-        .rd_valid(spi_tx_valid),
-        .rd_ready(spi_tx_ready),
-        // Status
-        .full(tx_fifo_full),
-        .empty(tx_fifo_empty),
-        .almost_full(),  // Not used
-        .almost_empty(tx_fifo_almost_empty),
-        .count(tx_fifo_count)
-    );
+    generate
+        if (ASYNC_FIFO) begin : g_async_fifo
+            // RX FIFO (SPI clk -> app_clk)
+            fifo_async #(
+                .DATA_WIDTH(TRANSFER_WIDTH),
+                .DEPTH(RX_FIFO_DEPTH),
+                .ALMOST_FULL_THRESHOLD(16),
+                .ALMOST_EMPTY_THRESHOLD(4)
+            ) rx_fifo_inst (
+                .rst_n(rst_n),
+                // Write side (from SPI)
+                .wr_clk(clk),
+                .wr_data(spi_rx_data),
+                .wr_valid(rx_wr_valid),
+                .wr_ready(rx_wr_ready),
+                .full(rx_fifo_full),
+                .almost_full(rx_fifo_almost_full),
+                .wr_count(rx_spi_count),
+                // Read side (to application)
+                .rd_clk(app_clk),
+                .rd_data(rx_fifo_data),
+                .rd_valid(rx_fifo_valid),
+                .rd_ready(rx_fifo_ready),
+                .empty(rx_fifo_empty),
+                .almost_empty(),  // Not used
+                .rd_count(rx_fifo_count)
+            );
+            
+            // TX FIFO (app_clk -> SPI clk)
+            fifo_async #(
+                .DATA_WIDTH(TRANSFER_WIDTH),
+                .DEPTH(TX_FIFO_DEPTH),
+                .ALMOST_FULL_THRESHOLD(16),
+                .ALMOST_EMPTY_THRESHOLD(4)
+            ) tx_fifo_inst (
+                .rst_n(rst_n),
+                // Write side (from application)
+                .wr_clk(app_clk),
+                .wr_data(tx_wr_data),
+                .wr_valid(tx_wr_valid),
+                .wr_ready(tx_wr_ready),
+                .full(tx_fifo_full),
+                .almost_full(),  // Not used
+                .wr_count(tx_fifo_count),
+                // Read side (to SPI)
+                .rd_clk(clk),
+                .rd_data(tx_rd_data),
+                .rd_valid(tx_rd_valid),
+                .rd_ready(tx_rd_ready),
+                .empty(tx_fifo_empty),
+                .almost_empty(tx_fifo_almost_empty),
+                .rd_count(tx_spi_count)
+            );
+        end else begin : g_sync_fifo
+            // RX FIFO (SPI -> Application)
+            fifo_sync #(
+                .DATA_WIDTH(TRANSFER_WIDTH),
+                .DEPTH(RX_FIFO_DEPTH),
+                .ALMOST_FULL_THRESHOLD(16),
+                .ALMOST_EMPTY_THRESHOLD(4)
+            ) rx_fifo_inst (
+                .clk(clk),
+                .rst_n(rst_n),
+                // Write side (from SPI)
+                .wr_data(spi_rx_data),
+                .wr_valid(rx_wr_valid),
+                .wr_ready(rx_wr_ready),
+                // Read side (to application)
+                .rd_data(rx_fifo_data),
+                .rd_valid(rx_fifo_valid),
+                .rd_ready(rx_fifo_ready),
+                // Status
+                .full(rx_fifo_full),
+                .empty(rx_fifo_empty),
+                .almost_full(rx_fifo_almost_full),
+                .almost_empty(),  // Not used
+                .count(rx_fifo_count)
+            );
+            
+            // TX FIFO (Application -> SPI)
+            fifo_sync #(
+                .DATA_WIDTH(TRANSFER_WIDTH),
+                .DEPTH(TX_FIFO_DEPTH),
+                .ALMOST_FULL_THRESHOLD(16),
+                .ALMOST_EMPTY_THRESHOLD(4)
+            ) tx_fifo_inst (
+                .clk(clk),
+                .rst_n(rst_n),
+                // Write side (from application)
+                .wr_data(tx_wr_data),
+                .wr_valid(tx_wr_valid),
+                .wr_ready(tx_wr_ready),
+                // Read side (to SPI)
+                .rd_data(tx_rd_data),
+                .rd_valid(tx_rd_valid),
+                .rd_ready(tx_rd_ready),
+                // Status
+                .full(tx_fifo_full),
+                .empty(tx_fifo_empty),
+                .almost_full(),  // Not used
+                .almost_empty(tx_fifo_almost_empty),
+                .count(tx_fifo_count)
+            );
+            
+            assign rx_spi_count = rx_fifo_count;
+            assign tx_spi_count = tx_fifo_count;
+        end
+    endgenerate
+    
+    // =========================================================================
+    // Status Header
+    // =========================================================================
+    
+    generate
+        if (STATUS_HEADER) begin : g_status_header
+            localparam [31:0] COUNT_MAX = {(TRANSFER_WIDTH-1){1'b1}};
+            
+            // Next received word is the frame's header word
+            reg rx_header;
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n)
+                    rx_header <= 1'b1;
+                else if (!spi_cs_active)
+                    rx_header <= 1'b1;
+                else if (spi_rx_valid)
+                    rx_header <= 1'b0;
+            end
+            
+            // TX level includes the word staged at the FIFO output
+            wire [31:0] tx_level = tx_spi_count + tx_rd_valid;
+            wire [TRANSFER_WIDTH-2:0] tx_level_sat =
+                (tx_level > COUNT_MAX) ? COUNT_MAX[TRANSFER_WIDTH-2:0] : tx_level[TRANSFER_WIDTH-2:0];
+            wire [TRANSFER_WIDTH-1:0] status_word = {rx_fifo_almost_full, tx_level_sat};
+            
+            // Header word is always dropped
+            assign rx_wr_valid = spi_rx_valid && !rx_header;
+            
+            // Between frames spi_slave keeps reloading the status word; inside
+            // a frame it takes FIFO data at each word boundary
+            assign spi_tx_data = spi_cs_active ? tx_rd_data : status_word;
+            assign spi_tx_valid = spi_cs_active ? tx_rd_valid : 1'b1;
+            assign tx_rd_ready = spi_cs_active && spi_tx_ready;
+        end else begin : g_no_header
+            reg idle_taken;           // spi_slave loaded the head word during this CS high
+            reg cs_active_d;
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    idle_taken <= 1'b0;
+                    cs_active_d <= 1'b0;
+                end else begin
+                    cs_active_d <= spi_cs_active;
+                    if (spi_cs_active)
+                        idle_taken <= 1'b0;
+                    else if (spi_tx_ready && tx_rd_valid)
+                        idle_taken <= 1'b1;  // Head is stable: no pops while CS is high
+                end
+            end
+            
+            assign rx_wr_valid = spi_rx_valid;
+            
+            // While CS is high spi_slave keeps reloading the FIFO head without
+            // popping it; that word is popped once, when its frame starts, and
+            // every later one at its word boundary
+            wire frame_start = spi_cs_active && !cs_active_d;
+            assign spi_tx_data = tx_rd_data;
+            assign spi_tx_valid = tx_rd_valid;
+            assign tx_rd_ready = spi_cs_active && (spi_tx_ready || (frame_start && idle_taken));
+        end
+    endgenerate
+    
+    // =========================================================================
+    // Data-Ready Interrupt
+    // =========================================================================
+    
+    generate
+        if (IRQ_THRESHOLD > 0) begin : g_irq
+            localparam AGE_BITS = (IRQ_TIMEOUT > 1) ? $clog2(IRQ_TIMEOUT + 1) : 1;
+            
+            // Words the master can read, including the one staged at the FIFO output
+            wire [31:0] irq_level = tx_spi_count + tx_rd_valid;
+            
+            // clk cycles data has been waiting since the last frame
+            reg [AGE_BITS-1:0] irq_age;
+            wire irq_timeout = (IRQ_TIMEOUT > 0) && (irq_age >= IRQ_TIMEOUT);
+            
+            reg irq_reg;
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    irq_age <= 0;
+                    irq_reg <= 1'b0;
+                end else begin
+                    if (spi_cs_active || irq_level == 0)
+                        irq_age <= 0;
+                    else if (!irq_timeout)
+                        irq_age <= irq_age + 1'b1;
+                    
+                    irq_reg <= !spi_cs_active && (irq_level >= IRQ_THRESHOLD || irq_timeout);
+                end
+            end
+            
+            assign irq = irq_reg;
+        end else begin : g_no_irq
+            assign irq = 1'b0;
+        end
+    endgenerate
+    
+    // =========================================================================
+    // FIFO Statistics
+    // =========================================================================
+    
+    generate
+        if (STATS) begin : g_stats
+            reg [15:0] rx_overflows;
+            reg [15:0] tx_underflows;
+            reg [$clog2(RX_FIFO_DEPTH):0] rx_peak;
+            reg [$clog2(TX_FIFO_DEPTH):0] tx_peak;
+            
+            wire rx_overflow = rx_wr_valid && !rx_wr_ready;
+            // Word boundary inside a frame with nothing to load
+            wire tx_underflow = spi_cs_active && spi_tx_ready && !spi_tx_valid;
+            
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    rx_overflows <= 0;
+                    tx_underflows <= 0;
+                    rx_peak <= 0;
+                    tx_peak <= 0;
+                end else if (stats_clear) begin
+                    rx_overflows <= 0;
+                    tx_underflows <= 0;
+                    rx_peak <= 0;
+                    tx_peak <= 0;
+                end else begin
+                    if (rx_overflow && rx_overflows != 16'hFFFF)
+                        rx_overflows <= rx_overflows + 1'b1;
+                    if (tx_underflow && tx_underflows != 16'hFFFF)
+                        tx_underflows <= tx_underflows + 1'b1;
+                    if (rx_spi_count > rx_peak)
+                        rx_peak <= rx_spi_count;
+                    if (tx_spi_count > tx_peak)
+                        tx_peak <= tx_spi_count;
+                end
+            end
+            
+            assign stat_rx_overflows = rx_overflows;
+            assign stat_tx_underflows = tx_underflows;
+            assign stat_rx_peak = rx_peak;
+            assign stat_tx_peak = tx_peak;
+        end else begin : g_no_stats
+            assign stat_rx_overflows = 16'd0;
+            assign stat_tx_underflows = 16'd0;
+            assign stat_rx_peak = 0;
+            assign stat_tx_peak = 0;
+        end
+    endgenerate
 
 endmodule
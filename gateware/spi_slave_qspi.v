@@ -0,0 +1,229 @@
+// Dual/Quad SPI Slave Module
+//
+// Variant of spi_slave that moves 2 or 4 bits per SCLK on bidirectional IO
+// lines after a single-line command byte. Uses the same synchronizer and
+// edge detection as spi_slave, so the SCLK limit is unchanged but each
+// clock carries DATA_LANES bits.
+//
+// Frame format (SPI Mode 0, half duplex, MSB first):
+//   [CMD on IO0, 8 clocks] then
+//     CMD_WRITE: data words in on IO[DATA_LANES-1:0], DATA_LANES bits per clock
+//     CMD_READ:  DUMMY_CYCLES turnaround clocks, then data words out on IO
+//     other:     ignored until CS goes high
+//   Within each clock, IO[DATA_LANES-1] carries the most significant bit
+//   (ESP32 DIO/QIO data order).
+//
+// Interface:
+// - RX: rx_data, rx_valid (strobed when word complete), rx_ready (backpressure)
+// - TX: tx_data, tx_valid, tx_ready (pulses when a word has been taken)
+// - cs_active: synchronized chip select, high while a frame is in progress
+// - IO lines are split into io_in/io_out/io_oe; the tristate buffer lives
+//   in the top module:
+//     assign spi_io[i] = spi_io_oe[i] ? spi_io_out[i] : 1'bz;
+//
+// Timing:
+// - Command and write data are sampled on the rising edge of SCLK
+// - Read data is presented on the falling edge; the first word is taken
+//   from tx_data on the falling edge after the last dummy clock
+// - A TX word is only popped (tx_ready pulse) once the master has clocked
+//   its first bits, so the trailing SCLK edge of a frame never drops data
+// - Same SCLK limit as spi_slave (~4 MHz with 27 MHz system clock)
+//
+// Author: Papilio Labs
+// License: MIT
+
+module spi_slave_qspi #(
+    parameter TRANSFER_WIDTH = 8,   // 8, 16, or 32 bits per word
+    parameter DATA_LANES = 4,       // 2 (dual) or 4 (quad)
+    parameter DUMMY_CYCLES = 2,     // Turnaround clocks before read data
+    parameter [7:0] CMD_WRITE = 8'h01,
+    parameter [7:0] CMD_READ = 8'h02
+)(
+    // System clock and reset
+    input wire clk,           // System clock (e.g., 27MHz)
+    input wire rst,           // Active-high reset
+    
+    // SPI Interface (asynchronous to clk)
+    input wire spi_sclk,      // SPI clock from master
+    input wire spi_cs_n,      // Chip select (active low)
+    input wire [3:0] spi_io_in,     // IO0 (MOSI), IO1 (MISO), IO2 (WP), IO3 (HD)
+    output wire [3:0] spi_io_out,
+    output wire [3:0] spi_io_oe,    // High = slave drives the line
+    
+    // Receive Interface (system clock domain)
+    output reg [TRANSFER_WIDTH-1:0] rx_data,  // Received data word
+    output reg rx_valid,                       // Pulse when rx_data valid
+    input wire rx_ready,                       // Backpressure from application
+    
+    // Transmit Interface (system clock domain)
+    input wire [TRANSFER_WIDTH-1:0] tx_data,  // Data to transmit
+    input wire tx_valid,                       // tx_data holds a word
+    output wire tx_ready,                      // Word taken this cycle
+    
+    // Frame status (system clock domain)
+    output wire cs_active                      // Synchronized CS, high during a frame
+);
+    
+    // =========================================================================
+    // Parameter Validation
+    // =========================================================================
+    initial begin
+        if (TRANSFER_WIDTH != 8 && TRANSFER_WIDTH != 16 && TRANSFER_WIDTH != 32) begin
+            $error("TRANSFER_WIDTH must be 8, 16, or 32");
+            $finish;
+        end
+        if (DATA_LANES != 2 && DATA_LANES != 4) begin
+            $error("DATA_LANES must be 2 or 4");
+            $finish;
+        end
+    end
+    
+    localparam CLOCKS_PER_WORD = TRANSFER_WIDTH / DATA_LANES;
+    
+    // =========================================================================
+    // Synchronize SPI signals to system clock (dual register for metastability)
+    // =========================================================================
+    reg spi_cs_n_d1, spi_cs_n_d2;
+    reg spi_sclk_d1, spi_sclk_d2, spi_sclk_d3;
+    reg [3:0] spi_io_d1, spi_io_d2;
+    
+    always @(posedge clk) begin
+        spi_cs_n_d1 <= spi_cs_n;
+        spi_sclk_d1 <= spi_sclk;
+        spi_io_d1 <= spi_io_in;
+    
+        spi_cs_n_d2 <= spi_cs_n_d1;
+        spi_sclk_d2 <= spi_sclk_d1;
+        spi_io_d2 <= spi_io_d1;
+    
+        spi_sclk_d3 <= spi_sclk_d2;
+    end
+    
+    wire spi_cs_active = !spi_cs_n_d2;
+    wire spi_sclk_posedge = spi_sclk_d2 && !spi_sclk_d3;
+    wire spi_sclk_negedge = !spi_sclk_d2 && spi_sclk_d3;
+    assign cs_active = spi_cs_active;
+    
+    // =========================================================================
+    // Frame State Machine
+    // =========================================================================
+    localparam ST_CMD    = 3'd0;   // Shifting in the command byte on IO0
+    localparam ST_WRITE  = 3'd1;   // Multi-lane data in
+    localparam ST_DUMMY  = 3'd2;   // Turnaround before read data
+    localparam ST_READ   = 3'd3;   // Multi-lane data out
+    localparam ST_IGNORE = 3'd4;   // Unknown command, wait for CS high
+    
+    reg [2:0] state;
+    reg [7:0] cmd_shift;
+    reg [3:0] cmd_count;
+    reg [7:0] dummy_count;
+    
+    // =========================================================================
+    // Receive Path
+    // =========================================================================
+    reg [TRANSFER_WIDTH-1:0] rx_shift;
+    reg [$clog2(CLOCKS_PER_WORD):0] rx_clock_count;
+    wire [TRANSFER_WIDTH-1:0] rx_next = {rx_shift[TRANSFER_WIDTH-DATA_LANES-1:0], spi_io_d2[DATA_LANES-1:0]};
+    
+    // =========================================================================
+    // Transmit Path
+    // =========================================================================
+    reg [TRANSFER_WIDTH-1:0] tx_shift;
+    reg [$clog2(CLOCKS_PER_WORD):0] tx_clocks_left;  // Clocks before the next load
+    reg tx_pending;                                  // Loaded word not yet popped
+    
+    // Pop the word once its first clock has been sampled by the master
+    assign tx_ready = (state == ST_READ) && spi_cs_active && spi_sclk_posedge && tx_pending;
+    
+    localparam [3:0] LANE_MASK = (DATA_LANES == 4) ? 4'b1111 : 4'b0011;
+    wire [3:0] tx_lanes = tx_shift[TRANSFER_WIDTH-1 -: DATA_LANES];  // Zero-extended for dual
+    
+    assign spi_io_out = tx_lanes;
+    assign spi_io_oe = (state == ST_READ) ? LANE_MASK : 4'b0000;
+    
+    always @(posedge clk) begin
+        if (rst) begin
+            state <= ST_CMD;
+            cmd_shift <= 0;
+            cmd_count <= 0;
+            dummy_count <= 0;
+            rx_shift <= 0;
+            rx_clock_count <= 0;
+            rx_data <= 0;
+            rx_valid <= 0;
+            tx_shift <= {TRANSFER_WIDTH{1'b1}};
+            tx_clocks_left <= 0;
+            tx_pending <= 0;
+        end else begin
+            rx_valid <= 0;  // Default: clear strobe
+    
+            if (!spi_cs_active) begin
+                // CS inactive - reset for next frame
+                state <= ST_CMD;
+                cmd_count <= 0;
+                dummy_count <= 0;
+                rx_clock_count <= 0;
+                tx_clocks_left <= 0;
+                tx_pending <= 0;
+                tx_shift <= {TRANSFER_WIDTH{1'b1}};
+            end else begin
+                case (state)
+                    ST_CMD: begin
+                        if (spi_sclk_posedge) begin
+                            cmd_shift <= {cmd_shift[6:0], spi_io_d2[0]};
+                            cmd_count <= cmd_count + 1;
+                            if (cmd_count == 4'd7) begin
+                                if ({cmd_shift[6:0], spi_io_d2[0]} == CMD_WRITE)
+                                    state <= ST_WRITE;
+                                else if ({cmd_shift[6:0], spi_io_d2[0]} == CMD_READ)
+                                    state <= (DUMMY_CYCLES == 0) ? ST_READ : ST_DUMMY;
+                                else
+                                    state <= ST_IGNORE;
+                            end
+                        end
+                    end
+    
+                    ST_WRITE: begin
+                        if (spi_sclk_posedge) begin
+                            rx_shift <= rx_next;
+                            rx_clock_count <= rx_clock_count + 1;
+                            if (rx_clock_count == CLOCKS_PER_WORD - 1) begin
+                                rx_data <= rx_next;
+                                rx_valid <= rx_ready;  // Only assert valid if application ready
+                                rx_clock_count <= 0;
+                            end
+                        end
+                    end
+    
+                    ST_DUMMY: begin
+                        if (spi_sclk_posedge) begin
+                            dummy_count <= dummy_count + 1;
+                            if (dummy_count == DUMMY_CYCLES - 1)
+                                state <= ST_READ;
+                        end
+                    end
+    
+                    ST_READ: begin
+                        if (tx_ready)
+                            tx_pending <= 0;
+    
+                        if (spi_sclk_negedge) begin
+                            if (tx_clocks_left == 0) begin
+                                // Word boundary: take the next word (all 1's if none)
+                                tx_shift <= tx_valid ? tx_data : {TRANSFER_WIDTH{1'b1}};
+                                tx_pending <= tx_valid;
+                                tx_clocks_left <= CLOCKS_PER_WORD - 1;
+                            end else begin
+                                tx_shift <= tx_shift << DATA_LANES;
+                                tx_clocks_left <= tx_clocks_left - 1;
+                            end
+                        end
+                    end
+    
+                    default: ;  // ST_IGNORE
+                endcase
+            end
+        end
+    end
+
+endmodule
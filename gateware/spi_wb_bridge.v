@@ -1,12 +1,38 @@
 // Simple SPI to Wishbone Bridge with Read/Write Support
-// Protocol: [CMD][ADDR_HI][ADDR_LO][DATA]
-//   CMD=0x00: Read  - returns data on MISO during 4th byte
-//   CMD=0x01: Write - writes DATA to address
+// Protocol: [CMD][ADDR_HI][ADDR_LO][DATA][DATA]...
+//   CMD=0x00: Read        - returns data on MISO during 4th byte
+//   CMD=0x01: Write       - writes DATA to address; each further byte in the
+//                           same CS frame writes the next address
+//   CMD=0x02: Burst read  - like 0x00, then returns ADDR+1, ADDR+2, ... for
+//                           every further byte; the next address is read
+//                           while the current byte shifts out
+//
+// Burst reads prefetch one address ahead, so use 0x00 for registers with
+// read side effects. The first read must complete within the gap between
+// ADDR_LO and the 4th byte; later burst bytes get a full byte time.
+//
+// Pipelined protocol (PIPELINED = 1), instead of the frames above:
+//   Commands are 4-byte slots [CMD][ADDR_HI][ADDR_LO][DATA] sent back to
+//   back in one CS frame (CMD 0x00 read, 0x01 write, anything else is a
+//   no-op; DATA is ignored for reads). The response to slot N is shifted
+//   out during slot N+1 as [CMD][ADDR_LO][READ DATA][STATUS], so the
+//   master ends each frame with one no-op slot. The CMD and ADDR_LO echoes
+//   let the master match responses to requests. STATUS is 0x01 if the
+//   Wishbone cycle completed in time, 0x02 if the slot was dropped (never
+//   issued, safe to send again) and 0x00 if it is still queued or on the
+//   bus: the read data was 0xFF and the cycle will still run, so the master
+//   must not re-send it. Slot 0 of a frame returns 0xFF in all four bytes.
+//   A read is issued once ADDR_LO arrives and its data goes out about
+//   three byte times later; a write is issued after DATA and has two byte
+//   times. One request waits while another is on the bus, and a slot that
+//   finds both taken is dropped (STATUS 0x02).
 //
 // SPI Mode 0: CPOL=0, CPHA=0
 // Data sampled on rising edge, shifted out on falling edge
 
-module simple_spi_wb_bridge (
+module simple_spi_wb_bridge #(
+    parameter PIPELINED = 0   // 1 = pipelined slot protocol (see header)
+) (
     input wire clk,
     input wire rst,
     
@@ -58,9 +84,12 @@ module simple_spi_wb_bridge (
     reg [7:0] addr_high;
     reg [7:0] addr_low;
     reg [15:0] addr;
+    reg [15:0] wr_addr;       // Address for the current write byte
+    reg data_seen;            // A data byte has been received in this frame
     reg [7:0] data_in;
     reg transaction_complete;
     reg is_read;
+    reg is_burst_read;
     reg start_read;
     
     // =========================================================================
@@ -70,6 +99,7 @@ module simple_spi_wb_bridge (
     reg [7:0] read_data;
     reg read_data_valid;
     reg tx_active;
+    reg read_next;            // Burst read: fetch the following address
     
     // =========================================================================
     // MISO output - drive from transmit shift register MSB
@@ -85,178 +115,424 @@ module simple_spi_wb_bridge (
     
     reg [1:0] wb_state;
     
-    // =========================================================================
-    // SPI Receive Logic (sample on rising edge of SCLK)
-    // =========================================================================
-    always @(posedge clk or posedge rst) begin
-        if (rst) begin
-            bit_count <= 0;
-            byte_shift <= 0;
-            byte_count <= 0;
-            cmd <= 0;
-            addr_high <= 0;
-            addr_low <= 0;
-            addr <= 0;
-            data_in <= 0;
-            transaction_complete <= 0;
-            is_read <= 0;
-            start_read <= 0;
-        end else begin
-            transaction_complete <= 0;
-            start_read <= 0;
-            
-            if (!spi_cs_active) begin
-                // Reset when CS goes inactive
-                bit_count <= 0;
-                byte_count <= 0;
-                is_read <= 0;
-            end else if (spi_sclk_posedge) begin
-                // Shift in MOSI data on rising edge
-                byte_shift <= {byte_shift[6:0], spi_mosi_d2};
-                bit_count <= bit_count + 1;
-                
-                if (bit_count == 3'd7) begin
-                    // Completed receiving a byte
+    generate
+        if (!PIPELINED) begin : g_framed
+            // =================================================================
+            // SPI Receive Logic (sample on rising edge of SCLK)
+            // =================================================================
+            always @(posedge clk or posedge rst) begin
+                if (rst) begin
                     bit_count <= 0;
+                    byte_shift <= 0;
+                    byte_count <= 0;
+                    cmd <= 0;
+                    addr_high <= 0;
+                    addr_low <= 0;
+                    addr <= 0;
+                    wr_addr <= 0;
+                    data_seen <= 0;
+                    data_in <= 0;
+                    transaction_complete <= 0;
+                    is_read <= 0;
+                    is_burst_read <= 0;
+                    start_read <= 0;
+                end else begin
+                    transaction_complete <= 0;
+                    start_read <= 0;
                     
-                    case (byte_count)
-                        3'd0: begin
-                            cmd <= {byte_shift[6:0], spi_mosi_d2};
-                            is_read <= ({byte_shift[6:0], spi_mosi_d2} == 8'h00);
+                    if (!spi_cs_active) begin
+                        // Reset when CS goes inactive
+                        bit_count <= 0;
+                        byte_count <= 0;
+                        is_read <= 0;
+                        is_burst_read <= 0;
+                    end else if (spi_sclk_posedge) begin
+                        // Shift in MOSI data on rising edge
+                        byte_shift <= {byte_shift[6:0], spi_mosi_d2};
+                        bit_count <= bit_count + 1;
+                        
+                        if (bit_count == 3'd7) begin
+                            // Completed receiving a byte
+                            bit_count <= 0;
+                            
+                            case (byte_count)
+                                3'd0: begin
+                                    cmd <= {byte_shift[6:0], spi_mosi_d2};
+                                    is_read <= ({byte_shift[6:0], spi_mosi_d2} == 8'h00) ||
+                                               ({byte_shift[6:0], spi_mosi_d2} == 8'h02);
+                                    is_burst_read <= ({byte_shift[6:0], spi_mosi_d2} == 8'h02);
+                                end
+                                3'd1: addr_high <= {byte_shift[6:0], spi_mosi_d2};
+                                3'd2: begin
+                                    addr_low <= {byte_shift[6:0], spi_mosi_d2};
+                                    addr <= {addr_high, {byte_shift[6:0], spi_mosi_d2}};
+                                    wr_addr <= {addr_high, {byte_shift[6:0], spi_mosi_d2}};
+                                    data_seen <= 0;
+                                    // For reads, start the Wishbone transaction now
+                                    if (is_read) begin
+                                        start_read <= 1;
+                                    end
+                                end
+                                3'd3: begin
+                                    // 4th and every later byte (byte_count stays at 3)
+                                    data_in <= {byte_shift[6:0], spi_mosi_d2};
+                                    // Auto-increment: later data bytes go to the next address
+                                    if (data_seen)
+                                        wr_addr <= wr_addr + 1;
+                                    data_seen <= 1;
+                                    // For writes, trigger the transaction
+                                    if (!is_read) begin
+                                        transaction_complete <= 1;
+                                    end
+                                end
+                            endcase
+                            
+                            if (byte_count < 3'd3)
+                                byte_count <= byte_count + 1;
                         end
-                        3'd1: addr_high <= {byte_shift[6:0], spi_mosi_d2};
-                        3'd2: begin
-                            addr_low <= {byte_shift[6:0], spi_mosi_d2};
-                            addr <= {addr_high, {byte_shift[6:0], spi_mosi_d2}};
-                            // For reads, start the Wishbone transaction now
-                            if (is_read) begin
-                                start_read <= 1;
+                    end
+                end
+            end
+            
+            // =================================================================
+            // SPI Transmit Logic (shift out on falling edge of SCLK)
+            // Data should be stable on rising edge (when master samples)
+            // So we shift on falling edge to prepare for next rising edge
+            // =================================================================
+            reg [2:0] tx_bit_count;
+            reg tx_data_loaded;
+            reg first_bit_sent;  // Flag to skip first falling edge after load
+            
+            // Byte boundary: falling edge after the 8th bit has been sampled
+            wire tx_byte_done = spi_sclk_negedge && tx_active && first_bit_sent && (tx_bit_count == 3'd7);
+            wire tx_load_first = read_data_valid && !tx_data_loaded;
+            wire tx_load_next = tx_byte_done && is_burst_read && read_data_valid;
+            // read_data has been taken by the transmitter (burst reads fetch the next one)
+            wire tx_consume = spi_cs_active && (tx_load_first || tx_load_next);
+            
+            always @(posedge clk or posedge rst) begin
+                if (rst) begin
+                    tx_shift <= 8'hFF;
+                    tx_active <= 0;
+                    tx_bit_count <= 0;
+                    tx_data_loaded <= 0;
+                    first_bit_sent <= 0;
+                end else begin
+                    if (!spi_cs_active) begin
+                        // CS inactive - reset transmitter
+                        tx_shift <= 8'hFF;
+                        tx_active <= 0;
+                        tx_bit_count <= 0;
+                        tx_data_loaded <= 0;
+                        first_bit_sent <= 0;
+                    end else begin
+                        // Load read data as soon as it becomes valid
+                        if (tx_load_first) begin
+                            tx_shift <= read_data;
+                            tx_active <= 1;
+                            tx_bit_count <= 0;
+                            tx_data_loaded <= 1;
+                            first_bit_sent <= 0;  // Need to wait for first rising edge
+                        end else if (spi_sclk_posedge && tx_active && !first_bit_sent) begin
+                            // First rising edge - mark that MSB has been sampled
+                            first_bit_sent <= 1;
+                        end else if (spi_sclk_negedge && tx_active && first_bit_sent && tx_bit_count < 3'd7) begin
+                            // Shift out on falling edge (after first bit was sampled)
+                            tx_shift <= {tx_shift[6:0], 1'b1};
+                            tx_bit_count <= tx_bit_count + 1;
+                        end else if (tx_byte_done && is_burst_read) begin
+                            // Burst read: next address goes out in the following byte
+                            // (0xFF if the Wishbone slave has not acked in time)
+                            tx_shift <= read_data_valid ? read_data : 8'hFF;
+                            tx_bit_count <= 0;
+                            first_bit_sent <= 0;
+                        end
+                    end
+                end
+            end
+            
+            // =================================================================
+            // Wishbone State Machine
+            // =================================================================
+            always @(posedge clk or posedge rst) begin
+                if (rst) begin
+                    wb_state <= WB_IDLE;
+                    wb_adr_o <= 0;
+                    wb_dat_o <= 0;
+                    wb_we_o <= 0;
+                    wb_cyc_o <= 0;
+                    wb_stb_o <= 0;
+                    read_data <= 8'hFF;
+                    read_data_valid <= 0;
+                    read_next <= 0;
+                end else begin
+                    // Burst read: once the transmitter has the data, fetch the next address
+                    if (tx_consume && is_burst_read) begin
+                        read_data_valid <= 0;
+                        read_next <= 1;
+                    end
+                    
+                    case (wb_state)
+                        WB_IDLE: begin
+                            wb_cyc_o <= 0;
+                            wb_stb_o <= 0;
+                            
+                            // Clear read_data_valid when CS goes inactive
+                            if (!spi_cs_active) begin
+                                read_data_valid <= 0;
+                                read_next <= 0;
+                            end
+                            
+                            // Start read when start_read pulse arrives
+                            if (start_read) begin
+                                wb_adr_o <= addr;
+                                wb_we_o <= 0;
+                                wb_cyc_o <= 1;
+                                wb_stb_o <= 1;
+                                wb_state <= WB_WAIT_ACK;
+                                read_data_valid <= 0;
+                            end
+                            // Burst read prefetch of the following address
+                            else if (read_next && spi_cs_active) begin
+                                wb_adr_o <= wb_adr_o + 1;
+                                wb_we_o <= 0;
+                                wb_cyc_o <= 1;
+                                wb_stb_o <= 1;
+                                wb_state <= WB_WAIT_ACK;
+                                read_next <= 0;
+                            end
+                            // Start write when transaction_complete for writes
+                            else if (transaction_complete && cmd == 8'h01) begin
+                                wb_adr_o <= wr_addr;
+                                wb_dat_o <= data_in;
+                                wb_we_o <= 1;
+                                wb_cyc_o <= 1;
+                                wb_stb_o <= 1;
+                                wb_state <= WB_WAIT_ACK;
                             end
                         end
-                        3'd3: begin
-                            data_in <= {byte_shift[6:0], spi_mosi_d2};
-                            // For writes, trigger the transaction
-                            if (!is_read) begin
-                                transaction_complete <= 1;
+                        
+                        WB_WAIT_ACK: begin
+                            if (wb_ack_i) begin
+                                if (!wb_we_o) begin
+                                    // Read completed - capture data
+                                    read_data <= wb_dat_i;
+                                    read_data_valid <= 1;
+                                end
+                                wb_cyc_o <= 0;
+                                wb_stb_o <= 0;
+                                wb_state <= WB_DONE;
                             end
                         end
+                        
+                        WB_DONE: begin
+                            wb_state <= WB_IDLE;
+                        end
+                        
+                        default: wb_state <= WB_IDLE;
                     endcase
+                end
+            end
+        end else begin : g_pipelined
+            // =================================================================
+            // Pipelined protocol: 4-byte slots, response one slot behind
+            // =================================================================
+            wire [7:0] rx_byte = {byte_shift[6:0], spi_mosi_d2};
+            
+            reg [7:0] slot_id;        // Free-running slot number (tags Wishbone requests)
+            reg [7:0] prev_id;        // Slot whose response is going out
+            reg [7:0] prev_cmd;
+            reg [7:0] prev_adr_lo;
+            reg prev_valid;           // A slot has completed in this CS frame
+            reg req_pulse;            // Slot wants a Wishbone cycle
+            reg [7:0] req_tag;
+            
+            // Receive: byte_count wraps every 4 bytes
+            always @(posedge clk or posedge rst) begin
+                if (rst) begin
+                    bit_count <= 0;
+                    byte_shift <= 0;
+                    byte_count <= 0;
+                    cmd <= 0;
+                    addr_high <= 0;
+                    addr <= 0;
+                    data_in <= 0;
+                    slot_id <= 0;
+                    prev_id <= 0;
+                    prev_cmd <= 8'hFF;
+                    prev_adr_lo <= 8'hFF;
+                    prev_valid <= 0;
+                    req_pulse <= 0;
+                    req_tag <= 0;
+                end else begin
+                    req_pulse <= 0;
                     
-                    if (byte_count < 3'd7)
-                        byte_count <= byte_count + 1;
+                    if (!spi_cs_active) begin
+                        bit_count <= 0;
+                        byte_count <= 0;
+                        prev_valid <= 0;
+                    end else if (spi_sclk_posedge) begin
+                        byte_shift <= rx_byte;
+                        bit_count <= bit_count + 1;
+                        
+                        if (bit_count == 3'd7) begin
+                            case (byte_count)
+                                3'd0: cmd <= rx_byte;
+                                3'd1: addr_high <= rx_byte;
+                                3'd2: begin
+                                    addr <= {addr_high, rx_byte};
+                                    // Reads start as soon as the address is known
+                                    if (cmd == 8'h00) begin
+                                        req_pulse <= 1;
+                                        req_tag <= slot_id;
+                                    end
+                                end
+                                default: begin
+                                    data_in <= rx_byte;
+                                    if (cmd == 8'h01) begin
+                                        req_pulse <= 1;
+                                        req_tag <= slot_id;
+                                    end
+                                    // Slot done: its response goes out in the next slot
+                                    prev_id <= slot_id;
+                                    prev_cmd <= cmd;
+                                    prev_adr_lo <= addr[7:0];
+                                    prev_valid <= 1;
+                                    slot_id <= slot_id + 1;
+                                end
+                            endcase
+                            
+                            byte_count <= (byte_count == 3'd3) ? 3'd0 : byte_count + 1;
+                        end
+                    end
                 end
             end
-        end
-    end
-    
-    // =========================================================================
-    // SPI Transmit Logic (shift out on falling edge of SCLK)
-    // Data should be stable on rising edge (when master samples)
-    // So we shift on falling edge to prepare for next rising edge
-    // =========================================================================
-    reg [2:0] tx_bit_count;
-    reg tx_data_loaded;
-    reg first_bit_sent;  // Flag to skip first falling edge after load
-    
-    always @(posedge clk or posedge rst) begin
-        if (rst) begin
-            tx_shift <= 8'hFF;
-            tx_active <= 0;
-            tx_bit_count <= 0;
-            tx_data_loaded <= 0;
-            first_bit_sent <= 0;
-        end else begin
-            if (!spi_cs_active) begin
-                // CS inactive - reset transmitter
-                tx_shift <= 8'hFF;
-                tx_active <= 0;
-                tx_bit_count <= 0;
-                tx_data_loaded <= 0;
-                first_bit_sent <= 0;
-            end else begin
-                // Load read data as soon as it becomes valid
-                if (read_data_valid && !tx_data_loaded) begin
-                    tx_shift <= read_data;
-                    tx_active <= 1;
+            
+            // Response of slot N, shifted out during slot N+1:
+            // [CMD echo][ADDR_LO echo][READ DATA][STATUS]
+            reg [7:0] req_id;         // Accepted request waiting for the bus
+            reg req_valid;
+            reg req_we;
+            reg [15:0] req_adr;
+            reg [7:0] req_dat;
+            reg [7:0] busy_id;        // Request on the bus
+            reg [7:0] done_id;        // Last request that completed
+            reg [7:0] done_data;
+            reg done_any;
+            reg [7:0] last_id;        // Last slot that asked for a Wishbone cycle
+            reg last_dropped;         // ... and found no room, so it never ran
+            
+            wire prev_is_rw = (prev_cmd == 8'h00) || (prev_cmd == 8'h01);
+            wire prev_done = !prev_is_rw || (done_any && done_id == prev_id);
+            wire prev_dropped = prev_is_rw && last_dropped && last_id == prev_id;
+            
+            reg [2:0] tx_bit_count;
+            reg [1:0] tx_byte;        // Slot byte currently in tx_shift
+            reg resp_done;            // prev_done, sampled with the read data
+            reg resp_dropped;         // prev_dropped, sampled with it
+            
+            always @(posedge clk or posedge rst) begin
+                if (rst) begin
+                    tx_shift <= 8'hFF;
                     tx_bit_count <= 0;
-                    tx_data_loaded <= 1;
-                    first_bit_sent <= 0;  // Need to wait for first rising edge
-                end else if (spi_sclk_posedge && tx_active && !first_bit_sent) begin
-                    // First rising edge - mark that MSB has been sampled
-                    first_bit_sent <= 1;
-                end else if (spi_sclk_negedge && tx_active && first_bit_sent && tx_bit_count < 3'd7) begin
-                    // Shift out on falling edge (after first bit was sampled)
-                    tx_shift <= {tx_shift[6:0], 1'b1};
+                    tx_byte <= 0;
+                    resp_done <= 0;
+                    resp_dropped <= 0;
+                end else if (!spi_cs_active) begin
+                    tx_shift <= 8'hFF;    // First slot of a frame has no response
+                    tx_bit_count <= 0;
+                    tx_byte <= 0;
+                end else if (spi_sclk_negedge) begin
                     tx_bit_count <= tx_bit_count + 1;
+                    if (tx_bit_count == 3'd7) begin
+                        // Byte boundary: load the next response byte
+                        tx_byte <= tx_byte + 1;
+                        case (tx_byte)
+                            2'd3: tx_shift <= prev_valid ? prev_cmd : 8'hFF;
+                            2'd0: tx_shift <= prev_valid ? prev_adr_lo : 8'hFF;
+                            2'd1: begin
+                                resp_done <= prev_done;
+                                resp_dropped <= prev_dropped;
+                                tx_shift <= (prev_valid && prev_done && prev_cmd == 8'h00) ? done_data : 8'hFF;
+                            end
+                            default: tx_shift <= prev_valid ? {6'd0, resp_dropped, resp_done} : 8'hFF;
+                        endcase
+                    end else begin
+                        tx_shift <= {tx_shift[6:0], 1'b1};
+                    end
                 end
             end
-        end
-    end
-    
-    // =========================================================================
-    // Wishbone State Machine
-    // =========================================================================
-    always @(posedge clk or posedge rst) begin
-        if (rst) begin
-            wb_state <= WB_IDLE;
-            wb_adr_o <= 0;
-            wb_dat_o <= 0;
-            wb_we_o <= 0;
-            wb_cyc_o <= 0;
-            wb_stb_o <= 0;
-            read_data <= 8'hFF;
-            read_data_valid <= 0;
-        end else begin
-            case (wb_state)
-                WB_IDLE: begin
+            
+            // Wishbone: one request on the bus, one waiting. A slot whose
+            // request finds both taken is dropped and reports status 0x02.
+            wire req_take = (wb_state == WB_IDLE) && req_valid;
+            
+            always @(posedge clk or posedge rst) begin
+                if (rst) begin
+                    wb_state <= WB_IDLE;
+                    wb_adr_o <= 0;
+                    wb_dat_o <= 0;
+                    wb_we_o <= 0;
                     wb_cyc_o <= 0;
                     wb_stb_o <= 0;
-                    
-                    // Clear read_data_valid when CS goes inactive
-                    if (!spi_cs_active) begin
-                        read_data_valid <= 0;
+                    req_id <= 0;
+                    req_valid <= 0;
+                    req_we <= 0;
+                    req_adr <= 0;
+                    req_dat <= 0;
+                    busy_id <= 0;
+                    done_id <= 0;
+                    done_data <= 8'hFF;
+                    done_any <= 0;
+                    last_id <= 0;
+                    last_dropped <= 0;
+                end else begin
+                    if (req_pulse) begin
+                        last_id <= req_tag;
+                        last_dropped <= req_valid && !req_take;
                     end
                     
-                    // Start read when start_read pulse arrives
-                    if (start_read) begin
-                        wb_adr_o <= addr;
-                        wb_we_o <= 0;
-                        wb_cyc_o <= 1;
-                        wb_stb_o <= 1;
-                        wb_state <= WB_WAIT_ACK;
-                        read_data_valid <= 0;
-                    end
-                    // Start write when transaction_complete for writes
-                    else if (transaction_complete && cmd == 8'h01) begin
-                        wb_adr_o <= addr;
-                        wb_dat_o <= data_in;
-                        wb_we_o <= 1;
-                        wb_cyc_o <= 1;
-                        wb_stb_o <= 1;
-                        wb_state <= WB_WAIT_ACK;
+                    if (req_pulse && (!req_valid || req_take)) begin
+                        req_valid <= 1;
+                        req_id <= req_tag;
+                        req_we <= (cmd == 8'h01);
+                        req_adr <= addr;
+                        req_dat <= data_in;
+                    end else if (req_take) begin
+                        req_valid <= 0;
                     end
-                end
-                
-                WB_WAIT_ACK: begin
-                    if (wb_ack_i) begin
-                        if (!wb_we_o) begin
-                            // Read completed - capture data
-                            read_data <= wb_dat_i;
-                            read_data_valid <= 1;
+                    
+                    case (wb_state)
+                        WB_IDLE: begin
+                            wb_cyc_o <= 0;
+                            wb_stb_o <= 0;
+                            if (req_valid) begin
+                                wb_adr_o <= req_adr;
+                                wb_dat_o <= req_dat;
+                                wb_we_o <= req_we;
+                                wb_cyc_o <= 1;
+                                wb_stb_o <= 1;
+                                busy_id <= req_id;
+                                wb_state <= WB_WAIT_ACK;
+                            end
                         end
-                        wb_cyc_o <= 0;
-                        wb_stb_o <= 0;
-                        wb_state <= WB_DONE;
-                    end
-                end
-                
-                WB_DONE: begin
-                    wb_state <= WB_IDLE;
+                        
+                        WB_WAIT_ACK: begin
+                            if (wb_ack_i) begin
+                                done_id <= busy_id;
+                                done_data <= wb_we_o ? 8'hFF : wb_dat_i;
+                                done_any <= 1;
+                                wb_cyc_o <= 0;
+                                wb_stb_o <= 0;
+                                wb_state <= WB_IDLE;
+                            end
+                        end
+                        
+                        default: wb_state <= WB_IDLE;
+                    endcase
                 end
-                
-                default: wb_state <= WB_IDLE;
-            endcase
+            end
         end
-    end
+    endgenerate
 
 endmodule
@@ -0,0 +1,386 @@
+// Pipelined Burst SPI to Wishbone Bridge
+// Protocol: [CMD][ADDR x ADDR_WIDTH/8][LEN_HI][LEN_LO][DATA]...
+//   CMD=0x00: Read   - one turnaround byte, then LEN words on MISO
+//   CMD=0x01: Write  - LEN words on MOSI, written to ADDR, ADDR+ADDR_STEP, ...
+// Address and length are MSB first; LEN counts DATA_WIDTH words (1-65535,
+// 0 does nothing). Words go MSB first, DATA_WIDTH/8 bytes each; MISO is
+// 0xFF outside the read data.
+//
+// Wishbone side is a B4 pipelined master: a new request is presented every
+// cycle the slave does not stall, without waiting for the previous ack.
+// Reads run ahead of the SPI side into a FIFO_DEPTH-word read-ahead FIFO,
+// so MISO is fed from the FIFO and only the first word waits on wb_ack_i
+// (it has the turnaround byte to arrive). Reads stop at LEN words, so
+// registers with read side effects are only read once. A word that has
+// not arrived by its first byte boundary goes out as 0xFF and is dropped
+// when it does, so later words stay aligned.
+//
+// Writes are buffered in the same FIFO and issued as soon as each word is
+// complete. A frame that ends early writes the words received so far.
+//
+// wb_cti_o/wb_bte_o tag every burst as linear incrementing (CTI 010, 111 on
+// the last word) for slaves that use registered feedback cycles. For a
+// classic (B3) slave tie wb_stall_i to (wb_stb_o & ~wb_ack_i).
+//
+// SPI Mode 0: CPOL=0, CPHA=0, through the spi_slave byte engine
+
+module spi_wb_burst_bridge #(
+    parameter ADDR_WIDTH = 32,     // 8, 16, 24, or 32 bits
+    parameter DATA_WIDTH = 32,     // 8, 16, or 32 bits
+    parameter ADDR_STEP = 1,       // Address increment per word (4 for byte addressing)
+    parameter FIFO_DEPTH = 16      // Read-ahead/write buffer words, power of 2
+)(
+    input wire clk,
+    input wire rst,
+    
+    // SPI Interface
+    input wire spi_sclk,
+    input wire spi_mosi,
+    output wire spi_miso,
+    input wire spi_cs_n,
+    
+    // Wishbone B4 Pipelined Master Interface
+    output reg [ADDR_WIDTH-1:0] wb_adr_o,
+    output reg [DATA_WIDTH-1:0] wb_dat_o,
+    input wire [DATA_WIDTH-1:0] wb_dat_i,
+    output reg wb_we_o,
+    output wire [DATA_WIDTH/8-1:0] wb_sel_o,
+    output wire wb_cyc_o,
+    output reg wb_stb_o,
+    input wire wb_stall_i,
+    input wire wb_ack_i,
+    output reg [2:0] wb_cti_o,
+    output wire [1:0] wb_bte_o
+);
+
+    // =========================================================================
+    // Parameter Validation
+    // =========================================================================
+    initial begin
+        if (ADDR_WIDTH != 8 && ADDR_WIDTH != 16 && ADDR_WIDTH != 24 && ADDR_WIDTH != 32) begin
+            $error("ADDR_WIDTH must be 8, 16, 24, or 32");
+            $finish;
+        end
+        if (DATA_WIDTH != 8 && DATA_WIDTH != 16 && DATA_WIDTH != 32) begin
+            $error("DATA_WIDTH must be 8, 16, or 32");
+            $finish;
+        end
+    end
+    
+    localparam CMD_READ = 8'h00;
+    localparam CMD_WRITE = 8'h01;
+    
+    localparam BYTES = DATA_WIDTH / 8;
+    localparam ABYTES = ADDR_WIDTH / 8;
+    localparam HDR = ABYTES + 3;                 // CMD + ADDR + LEN bytes
+    localparam CW = $clog2(FIFO_DEPTH) + 1;      // FIFO count width
+    
+    localparam CTI_INC = 3'b010;                 // Incrementing burst
+    localparam CTI_END = 3'b111;                 // End of burst
+    
+    assign wb_sel_o = {(DATA_WIDTH/8){1'b1}};
+    assign wb_bte_o = 2'b00;                     // Linear bursts
+    
+    // =========================================================================
+    // SPI byte engine
+    // =========================================================================
+    wire [7:0] rx_data;
+    wire rx_valid;
+    wire [7:0] tx_data;
+    wire tx_ready;
+    wire spi_cs_active;
+    
+    spi_slave #(
+        .TRANSFER_WIDTH(8)
+    ) spi_inst (
+        .clk(clk),
+        .rst(rst),
+        .spi_sclk(spi_sclk),
+        .spi_mosi(spi_mosi),
+        .spi_miso(spi_miso),
+        .spi_cs_n(spi_cs_n),
+        .rx_data(rx_data),
+        .rx_valid(rx_valid),
+        .rx_ready(1'b1),
+        .tx_data(tx_data),
+        .tx_valid(1'b1),                         // Always a byte to send (0xFF filler)
+        .tx_ready(tx_ready),
+        .cs_active(spi_cs_active)
+    );
+    
+    // =========================================================================
+    // Read-ahead / write FIFO (one direction per frame)
+    // =========================================================================
+    wire [DATA_WIDTH-1:0] fifo_wr_data;
+    wire fifo_wr_valid;
+    wire [DATA_WIDTH-1:0] fifo_rd_data;
+    wire fifo_rd_valid;
+    wire fifo_rd_ready;
+    wire [CW-1:0] fifo_count;
+    
+    fifo_sync #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .DEPTH(FIFO_DEPTH)
+    ) fifo_inst (
+        .clk(clk),
+        .rst_n(!rst),
+        .wr_data(fifo_wr_data),
+        .wr_valid(fifo_wr_valid),
+        .wr_ready(),
+        .rd_data(fifo_rd_data),
+        .rd_valid(fifo_rd_valid),
+        .rd_ready(fifo_rd_ready),
+        .full(),
+        .empty(),
+        .almost_full(),
+        .almost_empty(),
+        .count(fifo_count)
+    );
+    
+    // Nothing stored or staged
+    wire fifo_idle = (fifo_count == 0) && !fifo_rd_valid;
+    
+    // =========================================================================
+    // Frame header and SPI-side data registers
+    // =========================================================================
+    reg [3:0] hdr_count;      // Bytes received, saturates at HDR + 1
+    reg cmd_ok;
+    reg cmd_write;
+    reg [31:0] hdr_addr;
+    reg [7:0] len_hi;
+    reg [15:0] hdr_len;
+    reg op_req;               // Header complete, start the Wishbone side
+    reg op_pending;
+    
+    reg [DATA_WIDTH-1:0] rx_word;
+    reg [1:0] rx_byte;        // Byte of the current write word
+    reg [15:0] rx_left;       // Write words still expected
+    reg rx_push;
+    
+    reg [1:0] tx_byte;        // Byte of the current read word
+    reg tx_fill;              // Current read word is an 0xFF stand-in
+    reg [15:0] tx_left;       // Read words not yet started
+    reg [15:0] skip;          // Stand-in words whose data is still to come
+    
+    wire [DATA_WIDTH+7:0] rx_word_next = {rx_word, rx_data};
+    
+    // At a byte boundary spi_slave takes tx_data for the byte after the
+    // last one received; read data starts after the turnaround byte
+    wire tx_data_phase = spi_cs_active && cmd_ok && !cmd_write && (hdr_count == HDR + 1);
+    wire tx_word_start = (tx_byte == 0);
+    wire tx_start_ok = fifo_rd_valid && (skip == 0) && (tx_left != 0);
+    wire tx_real = tx_word_start ? tx_start_ok : !tx_fill;
+    wire tx_boundary = spi_cs_active && tx_ready && tx_data_phase;
+    wire [DATA_WIDTH-1:0] tx_word = fifo_rd_data << {tx_byte, 3'b000};
+    
+    assign tx_data = (tx_data_phase && tx_real) ? tx_word[DATA_WIDTH-1 -: 8] : 8'hFF;
+    
+    wire tx_pop = tx_boundary && tx_real && (tx_byte == BYTES - 1);
+    wire skip_inc = tx_boundary && tx_word_start && !tx_start_ok && (tx_left != 0);
+    
+    // Stand-in words are dropped in order: from the FIFO if it holds them,
+    // else as their acks arrive
+    wire skip_pop = (skip != 0) && fifo_rd_valid;
+    wire ack_drop;
+    
+    // =========================================================================
+    // SPI Frame Logic
+    // =========================================================================
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            hdr_count <= 0;
+            cmd_ok <= 0;
+            cmd_write <= 0;
+            hdr_addr <= 0;
+            len_hi <= 0;
+            hdr_len <= 0;
+            op_req <= 0;
+            rx_word <= 0;
+            rx_byte <= 0;
+            rx_left <= 0;
+            rx_push <= 0;
+            tx_byte <= 0;
+            tx_fill <= 0;
+            tx_left <= 0;
+            skip <= 0;
+        end else begin
+            op_req <= 0;
+            rx_push <= 0;
+            
+            if (!spi_cs_active) begin
+                // Reset when CS goes inactive
+                hdr_count <= 0;
+                rx_byte <= 0;
+                tx_byte <= 0;
+                tx_fill <= 0;
+                skip <= 0;
+            end else begin
+                if (rx_valid) begin
+                    if (hdr_count != HDR + 1)
+                        hdr_count <= hdr_count + 1;
+                    
+                    if (hdr_count == 0) begin
+                        cmd_ok <= (rx_data == CMD_READ) || (rx_data == CMD_WRITE);
+                        cmd_write <= (rx_data == CMD_WRITE);
+                    end else if (hdr_count <= ABYTES) begin
+                        hdr_addr <= {hdr_addr[23:0], rx_data};
+                    end else if (hdr_count == HDR - 2) begin
+                        len_hi <= rx_data;
+                    end else if (hdr_count == HDR - 1) begin
+                        hdr_len <= {len_hi, rx_data};
+                        rx_left <= {len_hi, rx_data};
+                        tx_left <= {len_hi, rx_data};
+                        op_req <= cmd_ok && ({len_hi, rx_data} != 0);
+                    end else if (cmd_write) begin
+                        // Write data: assemble words MSB first
+                        rx_word <= rx_word_next[DATA_WIDTH-1:0];
+                        if (rx_byte == BYTES - 1) begin
+                            rx_byte <= 0;
+                            if (rx_left != 0) begin
+                                rx_push <= 1;
+                                rx_left <= rx_left - 1;
+                            end
+                        end else begin
+                            rx_byte <= rx_byte + 1;
+                        end
+                    end
+                end
+                
+                // Read data: advance one byte per boundary
+                if (tx_boundary) begin
+                    if (tx_word_start && tx_left != 0)
+                        tx_left <= tx_left - 1;
+                    if (tx_byte == BYTES - 1) begin
+                        tx_byte <= 0;
+                        tx_fill <= 0;
+                    end else begin
+                        tx_byte <= tx_byte + 1;
+                        if (tx_word_start)
+                            tx_fill <= !tx_start_ok;
+                    end
+                end
+                
+                skip <= skip + skip_inc - (skip_pop || ack_drop);
+            end
+        end
+    end
+    
+    // =========================================================================
+    // Wishbone Pipelined Master
+    // =========================================================================
+    localparam WB_IDLE = 2'd0;
+    localparam WB_READ = 2'd1;
+    localparam WB_WRITE = 2'd2;
+    localparam WB_ABORT = 2'd3;   // Read frame ended: retire outstanding requests
+    
+    reg [1:0] wb_state;
+    reg [15:0] wb_left;       // Requests still to issue
+    reg [CW-1:0] wb_pending;  // Accepted requests waiting for ack
+    reg wr_frame_done;        // CS of the write frame has risen
+    
+    wire op_start = (wb_state == WB_IDLE) && op_pending;
+    wire wb_accept = wb_stb_o && !wb_stall_i;
+    wire wb_slot = !wb_stb_o || wb_accept;    // A new request can be presented
+    
+    // Reads only run ahead as far as the FIFO can hold every answer
+    wire rd_issue = (wb_state == WB_READ) && spi_cs_active && (wb_left != 0) && wb_slot &&
+                    (fifo_count + wb_pending + wb_stb_o < FIFO_DEPTH);
+    wire wr_issue = (wb_state == WB_WRITE) && (wb_left != 0) && wb_slot && fifo_rd_valid &&
+                    (wb_pending + wb_stb_o < FIFO_DEPTH);
+    
+    assign ack_drop = wb_ack_i && (wb_state == WB_READ) && (skip != 0) && fifo_idle;
+    wire ack_push = wb_ack_i && (wb_state == WB_READ) && !ack_drop;
+    
+    assign wb_cyc_o = wb_stb_o || (wb_pending != 0);
+    
+    // FIFO ports: writes come from SPI, read answers from Wishbone. Left-over
+    // read-ahead words are drained between frames and during the next header
+    wire fifo_drain = (wb_state == WB_IDLE || wb_state == WB_ABORT) && (hdr_count < HDR);
+    
+    assign fifo_wr_data = rx_push ? rx_word : wb_dat_i;
+    assign fifo_wr_valid = rx_push || ack_push;
+    assign fifo_rd_ready = tx_pop || skip_pop || wr_issue || fifo_drain;
+    
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            op_pending <= 0;
+        end else if (op_req) begin
+            op_pending <= 1;
+        end else if (op_start || (!spi_cs_active && !cmd_write)) begin
+            op_pending <= 0;  // A read whose frame already ended is not started
+        end
+    end
+    
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            wb_state <= WB_IDLE;
+            wb_adr_o <= 0;
+            wb_dat_o <= 0;
+            wb_we_o <= 0;
+            wb_stb_o <= 0;
+            wb_cti_o <= CTI_END;
+            wb_left <= 0;
+            wb_pending <= 0;
+            wr_frame_done <= 0;
+        end else begin
+            // Request accepted: the next one goes to the following address
+            if (wb_accept) begin
+                wb_stb_o <= 0;
+                wb_adr_o <= wb_adr_o + ADDR_STEP;
+            end
+            
+            if (rd_issue || wr_issue) begin
+                wb_stb_o <= 1;
+                wb_cti_o <= (wb_left == 1) ? CTI_END : CTI_INC;
+                wb_left <= wb_left - 1;
+            end
+            if (wr_issue) begin
+                wb_dat_o <= fifo_rd_data;
+            end
+            
+            if (wb_accept && !wb_ack_i)
+                wb_pending <= wb_pending + 1;
+            else if (!wb_accept && wb_ack_i)
+                wb_pending <= wb_pending - 1;
+            
+            case (wb_state)
+                WB_IDLE: begin
+                    if (op_start) begin
+                        wb_adr_o <= hdr_addr[ADDR_WIDTH-1:0];
+                        wb_we_o <= cmd_write;
+                        wb_left <= hdr_len;
+                        wr_frame_done <= !spi_cs_active;
+                        wb_state <= cmd_write ? WB_WRITE : WB_READ;
+                    end
+                end
+                
+                WB_READ: begin
+                    if (!spi_cs_active) begin
+                        wb_state <= WB_ABORT;
+                    end else if (wb_left == 0 && wb_pending == 0 && !wb_stb_o) begin
+                        wb_state <= WB_IDLE;
+                    end
+                end
+                
+                WB_WRITE: begin
+                    if (!spi_cs_active) begin
+                        wr_frame_done <= 1;
+                    end
+                    // Done after LEN words, or once an early-ended frame is drained
+                    if (wb_pending == 0 && !wb_stb_o &&
+                        (wb_left == 0 || (wr_frame_done && fifo_idle && !rx_push))) begin
+                        wb_state <= WB_IDLE;
+                    end
+                end
+                
+                WB_ABORT: begin
+                    // No new requests; a stalled one is held until accepted
+                    if (wb_pending == 0 && !wb_stb_o) begin
+                        wb_state <= WB_IDLE;
+                    end
+                end
+            endcase
+        end
+    end
+
+endmodule
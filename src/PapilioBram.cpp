@@ -0,0 +1,282 @@
+// PapilioBram.cpp - Implementation
+// 
+// Client for the spi_bram_controller and spi_bram_framed gateware.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioBram.h"
+
+// Constructor
+PapilioBram::PapilioBram() :
+    _spi(nullptr),
+    _addrBytes(1),
+    _wordBytes(1),
+    _framed(false),
+    _addrMask(0xFF),
+    _engineBusy(false),
+    _scan(),
+    _scanDone(),
+    _scanNext(0),
+    _scanHeld(false),
+    _scanning(false)
+{
+}
+
+// Attach to SPI bus
+bool PapilioBram::begin(PapilioSPI* spi, uint8_t addrBytes) {
+    if (!spi || addrBytes == 0 || addrBytes > 4) return false;
+    _spi = spi;
+    _addrBytes = addrBytes;
+    return true;
+}
+
+// Select the protocol (legacy command bytes or framed headers)
+bool PapilioBram::setFramed(bool enable, uint8_t wordBytes, uint32_t depth) {
+    if (wordBytes != 1 && wordBytes != 2 && wordBytes != 4) return false;
+    if (depth & (depth - 1)) return false;  // MEM_DEPTH is a power of 2
+    if (_scanning) return false;
+    _framed = enable;
+    _wordBytes = enable ? wordBytes : 1;
+    _addrMask = depth ? depth - 1 : (uint32_t)(((uint64_t)1 << (8 * _addrBytes)) - 1);
+    _engineBusy = false;
+    return true;
+}
+
+// Write a block in one frame
+bool PapilioBram::writeBlock(uint32_t addr, const uint8_t* buf, size_t n) {
+    if (!_spi || !buf) return false;
+    if (_framed) return _framedBlock(FRAMED_WRITE, addr, buf, nullptr, n, false);
+    
+    for (size_t i = 0; i < n; i++) {
+        if (buf[i] >= CMD_ADDRESS) return false;  // Would be taken as a command
+    }
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return false;
+    
+    _setAddress(txn, addr);
+    txn.putBurst(buf, nullptr, n);
+    return true;
+}
+
+// Read a block in one frame
+bool PapilioBram::readBlock(uint32_t addr, uint8_t* buf, size_t n) {
+    if (!_spi || !buf) return false;
+    if (_framed) return _framedBlock(FRAMED_READ, addr, nullptr, buf, n, false);
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return false;
+    
+    _setAddress(txn, addr);
+    txn.put8(CMD_READ);
+    txn.putBurst(nullptr, buf, n);  // Dummy 0x00 bytes clock the data out
+    return true;
+}
+
+// Write n native words (framed)
+bool PapilioBram::writeWords(uint32_t addr, const void* buf, size_t n) {
+    if (!_spi || !buf || !_framed) return false;
+    return _framedBlock(FRAMED_WRITE, addr, buf, nullptr, n * _wordBytes, true);
+}
+
+// Read n native words (framed)
+bool PapilioBram::readWords(uint32_t addr, void* buf, size_t n) {
+    if (!_spi || !buf || !_framed) return false;
+    return _framedBlock(FRAMED_READ, addr, nullptr, buf, n * _wordBytes, true);
+}
+
+// Set n words to value inside the FPGA, one command per 65535 words
+bool PapilioBram::fill(uint32_t addr, uint32_t value, size_t n, bool wait) {
+    if (!_spi || !_framed) return false;
+    
+    while (n > 0) {
+        size_t len = n < MAX_LEN ? n : MAX_LEN;
+        if (!_engine(FRAMED_FILL, addr, len, value, _wordBytes)) return false;
+        addr += len;
+        n -= len;
+    }
+    return wait ? waitIdle() : true;
+}
+
+// Copy n words inside the FPGA. A copy whose destination starts inside
+// the source range (counted around the wrap) is split from the top down,
+// as the gateware runs it, so overlapping ranges stay intact.
+bool PapilioBram::copy(uint32_t dst, uint32_t src, size_t n, bool wait) {
+    if (!_spi || !_framed) return false;
+    
+    uint32_t delta = (dst - src) & _addrMask;
+    bool down = delta != 0 && delta < n;
+    size_t done = 0;
+    while (done < n) {
+        size_t len = n - done < MAX_LEN ? n - done : MAX_LEN;
+        size_t offset = down ? n - done - len : done;
+        if (!_engine(FRAMED_COPY, dst + offset, len, src + offset, _addrBytes)) return false;
+        done += len;
+    }
+    return wait ? waitIdle() : true;
+}
+
+// Status frame: the first MISO byte of every frame carries the busy bit
+// 1 = running, 0 = idle, -1 = the status frame could not be sent
+int PapilioBram::busy() {
+    if (!_spi) return -1;
+    if (!_framed) return 0;
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return -1;
+    
+    return (txn.put8(FRAMED_STATUS) & 0x01) ? 1 : 0;
+}
+
+// Poll until the last fill/copy has finished; false on timeout or if the
+// status could not be read (the operation then still counts as running)
+bool PapilioBram::waitIdle(uint32_t timeout_ms) {
+    uint32_t start = millis();
+    
+    for (;;) {
+        int state = busy();
+        if (state < 0) return false;
+        if (state == 0) break;
+        if (timeout_ms != UINT32_MAX && millis() - start >= timeout_ms) return false;
+        yield();
+    }
+    _engineBusy = false;
+    return true;
+}
+
+// Start a sequential scan: header frame, then two blocks in flight
+bool PapilioBram::beginScan(uint32_t addr, uint8_t* bufA, uint8_t* bufB, size_t n) {
+    if (!_spi || !bufA || !bufB || n == 0 || _scanning || _framed) return false;
+    if (_spi->pending() > 0) return false;  // Header must not overtake queued frames
+    
+    {
+        PapilioSPI::Transaction txn(*_spi);
+        if (!txn.active()) return false;
+        _setAddress(txn, addr);
+        txn.put8(CMD_READ);  // D0 is loaded while CS is high
+    }
+    
+    uint8_t* bufs[2] = { bufA, bufB };
+    for (uint8_t i = 0; i < 2; i++) {
+        _scan[i].txBuf = nullptr;
+        _scan[i].rxBuf = bufs[i];
+        _scan[i].len = n;
+        _scan[i].user = &_scanDone[i];
+        _scanDone[i] = false;
+        if (!_spi->submit(&_scan[i], _scanComplete)) {
+            _spi->wait();
+            return false;
+        }
+    }
+    
+    _scanNext = 0;
+    _scanHeld = false;
+    _scanning = true;
+    return true;
+}
+
+// Next block of the scan; the block returned before is requeued first
+const uint8_t* PapilioBram::nextBlock(uint32_t timeout_ms) {
+    if (!_scanning) return nullptr;
+    
+    if (_scanHeld) {
+        uint8_t held = _scanNext ^ 1;
+        _scanDone[held] = false;
+        if (!_spi->submit(&_scan[held], _scanComplete)) return nullptr;
+        _scanHeld = false;
+    }
+    
+    uint32_t start = millis();
+    while (!_scanDone[_scanNext]) {
+        if (timeout_ms != UINT32_MAX && millis() - start >= timeout_ms) return nullptr;
+        if (_spi->poll() == 0) yield();
+    }
+    
+    uint8_t slot = _scanNext;
+    _scanNext ^= 1;
+    _scanHeld = true;
+    return _scan[slot].rxBuf;
+}
+
+// Stop the scan once the blocks in flight have landed
+void PapilioBram::endScan() {
+    if (!_scanning) return;
+    _spi->wait();
+    _scanning = false;
+}
+
+// Internal: completion callback, marks the slot ready
+void PapilioBram::_scanComplete(PapilioTransaction* txn) {
+    *static_cast<bool*>(txn->user) = true;
+}
+
+// Send the address header (MSB first)
+void PapilioBram::_setAddress(PapilioSPI::Transaction& txn, uint32_t addr) {
+    txn.put8(CMD_ADDRESS);
+    for (int i = _addrBytes - 1; i >= 0; i--) {
+        txn.put8((uint8_t)(addr >> (8 * i)));
+    }
+}
+
+// Internal: Framed read or write of n bytes, one frame per 65535 words.
+// words: buffers hold native words, else bytes in wire order.
+bool PapilioBram::_framedBlock(uint8_t cmd, uint32_t addr, const void* txBuf, void* rxBuf, size_t n, bool words) {
+    if (n % _wordBytes != 0) return false;
+    if (_engineBusy && !waitIdle()) return false;  // Frames are ignored while busy
+    
+    const uint8_t* tx = static_cast<const uint8_t*>(txBuf);
+    uint8_t* rx = static_cast<uint8_t*>(rxBuf);
+    size_t count = n / _wordBytes;
+    while (count > 0) {
+        size_t len = count < MAX_LEN ? count : MAX_LEN;
+        size_t bytes = len * _wordBytes;
+        
+        PapilioSPI::Transaction txn(*_spi);
+        if (!txn.active()) return false;
+        
+        _header(txn, cmd, addr, len);
+        if (cmd == FRAMED_READ) txn.put8(0x00);  // Turnaround: the first word is fetched here
+        
+        if (!words || _wordBytes == 1) {
+            txn.putBurst(tx, rx, bytes);
+        } else if (_wordBytes == 2) {
+            txn.putBurst16(reinterpret_cast<const uint16_t*>(tx), reinterpret_cast<uint16_t*>(rx), len);
+        } else {
+            txn.putBurst32(reinterpret_cast<const uint32_t*>(tx), reinterpret_cast<uint32_t*>(rx), len);
+        }
+        
+        if (tx) tx += bytes;
+        if (rx) rx += bytes;
+        addr += len;
+        count -= len;
+    }
+    return true;
+}
+
+// Internal: Send one fill/copy command; arg is its value or source address
+bool PapilioBram::_engine(uint8_t cmd, uint32_t addr, size_t len, uint32_t arg, uint8_t argBytes) {
+    if (_engineBusy && !waitIdle()) return false;
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return false;
+    
+    _header(txn, cmd, addr, len);
+    _put(txn, arg, argBytes);
+    _engineBusy = true;
+    return true;
+}
+
+// Internal: Framed header, command then address and length (MSB first)
+void PapilioBram::_header(PapilioSPI::Transaction& txn, uint8_t cmd, uint32_t addr, size_t len) {
+    txn.put8(cmd);
+    _put(txn, addr, _addrBytes);
+    _put(txn, (uint32_t)len, 2);
+}
+
+// Internal: Low bytes of value, MSB first
+void PapilioBram::_put(PapilioSPI::Transaction& txn, uint32_t value, uint8_t bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        txn.put8((uint8_t)(value >> (8 * i)));
+    }
+}
@@ -0,0 +1,108 @@
+// PapilioBram.h - Client for the spi_bram_controller and spi_bram_framed gateware
+// 
+// Streams whole blocks to and from BRAM in a single CS frame using the
+// controller's 0xFD address header:
+//   Write: [0xFD][ADDR][D0]...[Dn-1]
+//   Read:  [0xFD][ADDR][0xFE][0x00 x n]
+// The controller stays in read mode between frames, so sequential scans
+// send the header once and then only dummy-byte frames, queued ahead
+// through PapilioSPI::submit().
+//
+// After setFramed(true) the same calls talk to spi_bram_framed instead:
+// every frame carries a command, address and length header, any byte value
+// can be stored, words can be 16 or 32 bits, and fill()/copy() run inside
+// the FPGA without moving the data over SPI.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOBRAM_H
+#define PAPILIOBRAM_H
+
+#include <Arduino.h>
+#include "PapilioSPI.h"
+
+#ifndef PAPILIO_BRAM_TIMEOUT_MS
+#define PAPILIO_BRAM_TIMEOUT_MS 100       // Longest wait for a fill/copy to finish
+#endif
+
+class PapilioBram {
+public:
+    PapilioBram();
+    
+    // Attach to an initialized PapilioSPI. addrBytes must match the
+    // controller's ADDR_WORDS (1 for MEM_DEPTH <= 256 with 8-bit data), or
+    // ADDR_BYTES for spi_bram_framed.
+    bool begin(PapilioSPI* spi, uint8_t addrBytes = 1);
+    
+    // Switch to the spi_bram_framed protocol; wordBytes is its DATA_WIDTH/8
+    // and depth its MEM_DEPTH (power of 2, 0 = the whole addrBytes range)
+    bool setFramed(bool enable, uint8_t wordBytes = 1, uint32_t depth = 0);
+    bool framed() const { return _framed; }
+    
+    // Write n bytes starting at addr. Bytes 0xFD-0xFF are controller
+    // commands, so the block is rejected (nothing sent) if it contains one.
+    // Framed: any bytes; n must be whole words, each MSB first.
+    bool writeBlock(uint32_t addr, const uint8_t* buf, size_t n);
+    
+    // Read n bytes starting at addr
+    bool readBlock(uint32_t addr, uint8_t* buf, size_t n);
+    
+    // Framed only: n words from/to a uint8_t, uint16_t or uint32_t array
+    // (matching wordBytes)
+    bool writeWords(uint32_t addr, const void* buf, size_t n);
+    bool readWords(uint32_t addr, void* buf, size_t n);
+    
+    // Framed only: set n words from addr to value, or copy n words from src
+    // to dst (overlap is fine, also across the wrap at depth). Both run
+    // inside the FPGA. With wait = false
+    // the call returns once the command is sent; the next framed call (or
+    // waitIdle()) waits for it.
+    bool fill(uint32_t addr, uint32_t value, size_t n, bool wait = true);
+    bool copy(uint32_t dst, uint32_t src, size_t n, bool wait = true);
+    int busy();                                           // 1 running, 0 idle, -1 no status (one frame)
+    bool waitIdle(uint32_t timeout_ms = PAPILIO_BRAM_TIMEOUT_MS);
+    
+    // Sequential read-ahead: blocks of n bytes from addr, double-buffered
+    // in bufA/bufB. Both blocks are queued right away, and each nextBlock()
+    // requeues the block it returned last time, so the next one is on the
+    // wire while the application works on the current one. Nothing else may
+    // use the bus until endScan(). Legacy controller only.
+    bool beginScan(uint32_t addr, uint8_t* bufA, uint8_t* bufB, size_t n);
+    const uint8_t* nextBlock(uint32_t timeout_ms = UINT32_MAX);  // nullptr on timeout
+    void endScan();
+    
+private:
+    static const uint8_t CMD_READ = 0xFE;     // Read mode
+    static const uint8_t CMD_ADDRESS = 0xFD;  // Address header, write mode
+    
+    static const uint8_t FRAMED_READ = 0x00;
+    static const uint8_t FRAMED_WRITE = 0x01;
+    static const uint8_t FRAMED_FILL = 0x02;
+    static const uint8_t FRAMED_COPY = 0x03;
+    static const uint8_t FRAMED_STATUS = 0xFF;  // Not a command: status byte only
+    static const size_t MAX_LEN = 0xFFFF;       // Words per frame (16-bit length)
+    
+    PapilioSPI* _spi;
+    uint8_t _addrBytes;
+    uint8_t _wordBytes;
+    bool _framed;
+    uint32_t _addrMask;       // Framed: MEM_DEPTH - 1, addresses wrap there
+    bool _engineBusy;         // Fill/copy sent and not yet seen finished
+    
+    // Read-ahead state
+    PapilioTransaction _scan[2];
+    bool _scanDone[2];
+    uint8_t _scanNext;        // Slot nextBlock() returns next
+    bool _scanHeld;           // The other slot was returned and not yet requeued
+    bool _scanning;
+    
+    void _setAddress(PapilioSPI::Transaction& txn, uint32_t addr);
+    bool _framedBlock(uint8_t cmd, uint32_t addr, const void* txBuf, void* rxBuf, size_t n, bool words);
+    bool _engine(uint8_t cmd, uint32_t addr, size_t len, uint32_t arg, uint8_t argBytes);
+    void _header(PapilioSPI::Transaction& txn, uint8_t cmd, uint32_t addr, size_t len);
+    void _put(PapilioSPI::Transaction& txn, uint32_t value, uint8_t bytes);
+    static void _scanComplete(PapilioTransaction* txn);
+};
+
+#endif // PAPILIOBRAM_H
@@ -0,0 +1,330 @@
+// PapilioBus.cpp - Implementation
+//
+// Shared-bus scheduler for several PapilioDevice handles.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioBus.h"
+
+// Constructor
+PapilioDevice::PapilioDevice() :
+    PapilioSPI(),
+    _bus(nullptr),
+    _priority(0),
+    _maxSlice(0),
+    _head(0),
+    _done(0),
+    _queued(0),
+    _offset(0)
+{
+}
+
+// Queue through the bus scheduler
+bool PapilioDevice::submit(PapilioTransaction* txn, PapilioCallback callback) {
+    if (!_bus) return PapilioSPI::submit(txn, callback);
+    return _bus->_submit(*this, txn, callback);
+}
+
+// Run this device's finished callbacks (and stream delivery)
+int PapilioDevice::poll() {
+    int completed = _bus ? _bus->_poll(this) : 0;
+    return completed + PapilioSPI::poll();
+}
+
+// Block until this device's submitted transfers have completed
+bool PapilioDevice::wait(uint32_t timeout_ms) {
+    if (!_bus) return PapilioSPI::wait(timeout_ms);
+    return _bus->_wait(this, timeout_ms);
+}
+
+// Submitted through the bus (or locally), callback not yet run
+size_t PapilioDevice::pending() const {
+    if (!_bus) return PapilioSPI::pending();
+    
+    _bus->_lockState();
+    size_t n = _done + _queued;
+    _bus->_unlockState();
+    return n;
+}
+
+// Constructor
+PapilioBus::PapilioBus() :
+    _spi(nullptr),
+    _count(0),
+    _next(0)
+#if defined(ARDUINO_ARCH_ESP32)
+    ,
+    _worker(nullptr),
+    _doneSignal(nullptr)
+#endif
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    _lock = unlocked;
+#endif
+    for (size_t i = 0; i < PAPILIO_BUS_MAX_DEVICES; i++) {
+        _devices[i] = nullptr;
+    }
+}
+
+// Take over an SPIClass whose pins are already set up
+bool PapilioBus::begin(SPIClass* spi) {
+    if (!spi) return false;
+    _spi = spi;
+    return true;
+}
+
+// Detach every device and stop the scheduler
+void PapilioBus::end() {
+    while (_count > 0) {
+        detach(*_devices[_count - 1]);
+    }
+#if defined(ARDUINO_ARCH_ESP32)
+    _stopWorker();
+#endif
+    _spi = nullptr;
+}
+
+// Initialize a device on the shared SPIClass and register it
+bool PapilioBus::attach(PapilioDevice& dev, int cs_pin, uint32_t speed, uint8_t mode,
+                        uint8_t priority, size_t maxSlice) {
+    if (!_spi || dev._bus || _count >= PAPILIO_BUS_MAX_DEVICES) return false;
+    if (!dev.begin(_spi, cs_pin, speed, mode)) return false;
+    
+    dev._priority = priority;
+    dev._maxSlice = maxSlice;
+    dev._head = 0;
+    dev._done = 0;
+    dev._queued = 0;
+    dev._offset = 0;
+    
+    _lockState();
+    _devices[_count++] = &dev;
+    dev._bus = this;
+    _unlockState();
+    return true;
+}
+
+// Unregister a device once its queued transfers are done
+void PapilioBus::detach(PapilioDevice& dev) {
+    if (dev._bus != this) return;
+    _wait(&dev, UINT32_MAX);
+    
+    _lockState();
+    for (size_t i = 0; i < _count; i++) {
+        if (_devices[i] == &dev) {
+            for (size_t j = i + 1; j < _count; j++) {
+                _devices[j - 1] = _devices[j];
+            }
+            _devices[--_count] = nullptr;
+            break;
+        }
+    }
+    _next = 0;
+    dev._bus = nullptr;
+    _unlockState();
+    
+    dev.end();
+}
+
+// Run finished callbacks of every device
+// Without a worker task, first runs one slice of the most urgent transfer.
+int PapilioBus::poll() {
+    return _poll(nullptr);
+}
+
+// Block until no device has pending transfers; false on timeout
+bool PapilioBus::wait(uint32_t timeout_ms) {
+    return _wait(nullptr, timeout_ms);
+}
+
+// Transfers submitted on any device whose callback has not run yet
+size_t PapilioBus::pending() const {
+    size_t n = 0;
+    for (size_t i = 0; i < _count; i++) {
+        n += _devices[i]->pending();
+    }
+    return n;
+}
+
+// Internal: Guard device rings against the worker task
+void PapilioBus::_lockState() {
+#if defined(ARDUINO_ARCH_ESP32)
+    portENTER_CRITICAL(&_lock);
+#endif
+}
+
+void PapilioBus::_unlockState() {
+#if defined(ARDUINO_ARCH_ESP32)
+    portEXIT_CRITICAL(&_lock);
+#endif
+}
+
+// Internal: Append a transfer to the device's ring and wake the scheduler
+bool PapilioBus::_submit(PapilioDevice& dev, PapilioTransaction* txn, PapilioCallback callback) {
+    if (!_spi || !txn) return false;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (!_worker && !_startWorker()) return false;
+#endif
+    
+    _lockState();
+    if (dev._done + dev._queued >= PAPILIO_SPI_QUEUE_DEPTH) {
+        _unlockState();
+        return false;
+    }
+    PapilioDevice::Entry& entry = dev._ring[(dev._head + dev._done + dev._queued) % PAPILIO_SPI_QUEUE_DEPTH];
+    entry.txn = txn;
+    entry.callback = callback;
+    dev._queued++;
+    _unlockState();
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    xTaskNotifyGive(_worker);
+#endif
+    return true;
+}
+
+// Internal: Pick the highest priority device with queued work (equal
+// priorities take turns) and send one frame of its oldest transfer - all
+// of it, or maxSlice bytes if the device allows slicing
+bool PapilioBus::_runSlice() {
+    PapilioDevice* dev = nullptr;
+    size_t picked = 0;
+    
+    _lockState();
+    for (size_t i = 0; i < _count; i++) {
+        size_t index = (_next + i) % _count;
+        PapilioDevice* candidate = _devices[index];
+        if (candidate->_queued > 0 && (!dev || candidate->_priority > dev->_priority)) {
+            dev = candidate;
+            picked = index;
+        }
+    }
+    if (!dev) {
+        _unlockState();
+        return false;
+    }
+    _next = (picked + 1) % _count;
+    PapilioDevice::Entry entry = dev->_ring[(dev->_head + dev->_done) % PAPILIO_SPI_QUEUE_DEPTH];
+    size_t offset = dev->_offset;
+    _unlockState();
+    
+    // Outside the lock - only this task advances the queued part of a ring
+    PapilioTransaction* txn = entry.txn;
+    size_t n = txn->len - offset;
+    if (dev->_maxSlice > 0 && n > dev->_maxSlice) n = dev->_maxSlice;
+    if (n > 0) {
+        dev->transferBurst(txn->txBuf ? txn->txBuf + offset : nullptr,
+                           txn->rxBuf ? txn->rxBuf + offset : nullptr, n);
+    }
+    
+    bool finished = offset + n >= txn->len;
+    _lockState();
+    dev->_offset = finished ? 0 : offset + n;
+    if (finished) {
+        dev->_queued--;
+        dev->_done++;
+    }
+    _unlockState();
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    if (finished) xSemaphoreGive(_doneSignal);
+#endif
+    return true;
+}
+
+// Internal: Run a device's finished callbacks in submission order
+// The slot is released before the callback so it can submit the next buffer.
+int PapilioBus::_complete(PapilioDevice& dev) {
+    int completed = 0;
+    
+    for (;;) {
+        _lockState();
+        if (dev._done == 0) {
+            _unlockState();
+            break;
+        }
+        PapilioDevice::Entry entry = dev._ring[dev._head];
+        dev._head = (dev._head + 1) % PAPILIO_SPI_QUEUE_DEPTH;
+        dev._done--;
+        _unlockState();
+        
+        if (entry.callback) {
+            entry.callback(entry.txn);
+        }
+        completed++;
+    }
+    return completed;
+}
+
+// Internal: poll() for one device or (only == nullptr) all of them
+int PapilioBus::_poll(PapilioDevice* only) {
+#if !defined(ARDUINO_ARCH_ESP32)
+    _runSlice();
+#endif
+    if (only) return _complete(*only);
+    
+    int completed = 0;
+    for (size_t i = 0; i < _count; i++) {
+        completed += _complete(*_devices[i]);
+    }
+    return completed;
+}
+
+// Internal: wait() for one device or all of them
+bool PapilioBus::_wait(PapilioDevice* only, uint32_t timeout_ms) {
+    uint32_t start = millis();
+    
+    for (;;) {
+        _poll(only);
+        if ((only ? only->pending() : pending()) == 0) return true;
+        
+        uint32_t elapsed = millis() - start;
+        if (timeout_ms != UINT32_MAX && elapsed >= timeout_ms) return false;
+#if defined(ARDUINO_ARCH_ESP32)
+        // Woken per finished transfer; the tick timeout covers several waiters
+        xSemaphoreTake(_doneSignal, 1);
+#endif
+    }
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Internal: Create the scheduler task on first submit()
+bool PapilioBus::_startWorker() {
+    _doneSignal = xSemaphoreCreateBinary();
+    
+    if (!_doneSignal ||
+        xTaskCreate(_workerTask, "papilio_bus", PAPILIO_BUS_TASK_STACK, this,
+                    PAPILIO_BUS_TASK_PRIORITY, &_worker) != pdPASS) {
+        _worker = nullptr;
+        _stopWorker();
+        return false;
+    }
+    return true;
+}
+
+// Internal: Delete the scheduler task (only called with nothing queued,
+// so the task is blocked waiting for work and does not hold the bus)
+void PapilioBus::_stopWorker() {
+    if (_worker) {
+        vTaskDelete(_worker);
+        _worker = nullptr;
+    }
+    if (_doneSignal) {
+        vSemaphoreDelete(_doneSignal);
+        _doneSignal = nullptr;
+    }
+}
+
+// Internal: Scheduler task - runs slices back to back, sleeps when idle
+void PapilioBus::_workerTask(void* arg) {
+    PapilioBus* self = static_cast<PapilioBus*>(arg);
+    
+    for (;;) {
+        if (!self->_runSlice()) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+}
+#endif
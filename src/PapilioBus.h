@@ -0,0 +1,134 @@
+// PapilioBus.h - Several FPGA cores on one SPI bus
+//
+// PapilioBus owns the SPIClass; each core on its own CS pin gets a
+// PapilioDevice. A device is a full PapilioSPI (own prebuilt SPISettings,
+// CS pin, bit width and CS timing), so PapilioBram, PapilioWishbone etc.
+// attach to it unchanged and switching devices costs no reconfiguration.
+//
+// Queued transfers (submit()) of all devices go through one bus scheduler:
+// - Higher priority devices go first; equal priorities take turns
+// - A device with maxSlice > 0 has its bursts split into frames of at most
+//   maxSlice bytes, and the scheduler picks again between slices, so a long
+//   stream burst cannot hold off register accesses for its whole length.
+//   Only use slicing for cores where a burst may span several CS frames
+//   (FIFO streams), never for command-framed cores (BRAM, Wishbone).
+// Synchronous calls (transfer8(), Transaction, ...) from any task are
+// serialized with queued work frame by frame.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOBUS_H
+#define PAPILIOBUS_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "PapilioSPI.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/semphr.h>
+#endif
+
+#ifndef PAPILIO_BUS_MAX_DEVICES
+#define PAPILIO_BUS_MAX_DEVICES 8         // Devices attached at once
+#endif
+#ifndef PAPILIO_BUS_TASK_STACK
+#define PAPILIO_BUS_TASK_STACK PAPILIO_SPI_TASK_STACK
+#endif
+#ifndef PAPILIO_BUS_TASK_PRIORITY
+#define PAPILIO_BUS_TASK_PRIORITY PAPILIO_SPI_TASK_PRIORITY
+#endif
+
+class PapilioBus;
+
+class PapilioDevice : public PapilioSPI {
+public:
+    PapilioDevice();
+    
+    // Queued transfers through the bus scheduler (device-local if the
+    // device is not attached). Callbacks run from this device's poll()/wait()
+    // or from PapilioBus::poll()/wait().
+    bool submit(PapilioTransaction* txn, PapilioCallback callback = nullptr);
+    int poll();
+    bool wait(uint32_t timeout_ms = UINT32_MAX);
+    size_t pending() const;
+    
+    // Scheduling (can be changed while attached)
+    void setPriority(uint8_t priority) { _priority = priority; }   // Higher runs first
+    void setMaxSlice(size_t bytes) { _maxSlice = bytes; }          // 0 = never split
+    uint8_t priority() const { return _priority; }
+    size_t maxSlice() const { return _maxSlice; }
+    PapilioBus* bus() const { return _bus; }
+    
+private:
+    friend class PapilioBus;
+    
+    struct Entry {
+        PapilioTransaction* txn;
+        PapilioCallback callback;
+    };
+    
+    PapilioBus* _bus;
+    uint8_t _priority;
+    size_t _maxSlice;
+    
+    // Ring of submitted transfers: [head, head + done) have finished and
+    // wait for their callback, the next queued ones wait for the bus.
+    // Guarded by the bus lock.
+    Entry _ring[PAPILIO_SPI_QUEUE_DEPTH];
+    size_t _head;
+    size_t _done;
+    size_t _queued;
+    size_t _offset;           // Bytes of the oldest queued transfer already sent
+    
+    PapilioDevice(const PapilioDevice&);             // Not copyable
+    PapilioDevice& operator=(const PapilioDevice&);
+};
+
+class PapilioBus {
+public:
+    PapilioBus();
+    
+    bool begin(SPIClass* spi = &SPI);
+    void end();               // Detaches every device
+    
+    // Initialize dev on this bus (PapilioSPI::begin with the shared SPIClass)
+    bool attach(PapilioDevice& dev, int cs_pin, uint32_t speed = 1000000, uint8_t mode = SPI_MODE0,
+                uint8_t priority = 0, size_t maxSlice = 0);
+    void detach(PapilioDevice& dev);  // Waits for its queued transfers
+    
+    int poll();                                   // Callbacks of all devices, returns count
+    bool wait(uint32_t timeout_ms = UINT32_MAX);  // Until no device has pending transfers
+    size_t pending() const;
+    
+    SPIClass* spi() const { return _spi; }
+    size_t devices() const { return _count; }
+    
+private:
+    friend class PapilioDevice;
+    
+    SPIClass* _spi;
+    PapilioDevice* _devices[PAPILIO_BUS_MAX_DEVICES];
+    size_t _count;
+    size_t _next;             // Round-robin start among equal priorities
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    portMUX_TYPE _lock;
+    TaskHandle_t _worker;
+    SemaphoreHandle_t _doneSignal;
+    
+    bool _startWorker();
+    void _stopWorker();
+    static void _workerTask(void* arg);
+#endif
+    
+    void _lockState();
+    void _unlockState();
+    bool _submit(PapilioDevice& dev, PapilioTransaction* txn, PapilioCallback callback);
+    bool _runSlice();         // One frame of the most urgent transfer, false if idle
+    int _complete(PapilioDevice& dev);
+    int _poll(PapilioDevice* only);
+    bool _wait(PapilioDevice* only, uint32_t timeout_ms);
+};
+
+#endif // PAPILIOBUS_H
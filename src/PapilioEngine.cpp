@@ -0,0 +1,204 @@
+// PapilioEngine.cpp - Implementation
+//
+// Pinned SPI service task with lock-free request/result rings.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioEngine.h"
+
+// Constructor
+PapilioEngine::PapilioEngine() :
+    _spi(nullptr),
+    _inFlight(0),
+    _stats()
+#if defined(ARDUINO_ARCH_ESP32)
+    ,
+    _task(nullptr),
+    _run(false),
+    _sleeping(false)
+#endif
+{
+}
+
+// Take over an initialized PapilioSPI and start the engine task on core
+bool PapilioEngine::begin(PapilioSPI* spi, int core) {
+    if (_spi) end();
+    if (!spi || spi->streaming() || spi->pending() > 0) return false;
+    
+    _inFlight = 0;
+    _stats = PapilioEngineStats();
+    _pool.reset();
+    _spi = spi;
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    _run = true;
+    _sleeping = false;
+    if (xTaskCreatePinnedToCore(_taskMain, "papilio_engine", PAPILIO_ENGINE_STACK, this,
+                                PAPILIO_ENGINE_PRIORITY, &_task, core) != pdPASS) {
+        _task = nullptr;
+        _run = false;
+        _spi = nullptr;
+        return false;
+    }
+#else
+    (void)core;
+#endif
+    return true;
+}
+
+// Let the engine finish what is in flight, then stop it
+void PapilioEngine::end() {
+    if (!_spi) return;
+    wait();
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    _run = false;
+    while (_task) {
+        _wake();
+        vTaskDelay(1);  // Task sees _run cleared, then clears the handle
+    }
+#endif
+    
+    PapilioTransaction txn;
+    while (_results.pop(txn)) {
+    }
+    _inFlight = 0;
+    _spi = nullptr;
+}
+
+// Take a pool buffer (PapilioEngine::bufferSize() bytes, cache-line aligned)
+uint8_t* PapilioEngine::alloc() {
+    return _pool.alloc();
+}
+
+bool PapilioEngine::release(uint8_t* buf) {
+    return _pool.release(buf);
+}
+
+// Hand a transfer to the engine
+// At most PAPILIO_ENGINE_DEPTH are in flight, so the result ring never fills
+// and the engine never waits for the application.
+bool PapilioEngine::submit(const PapilioTransaction& txn) {
+    if (!_spi || _inFlight >= PAPILIO_ENGINE_DEPTH) return false;
+    if (!_requests.push(txn)) return false;
+    _inFlight++;
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    // Order the push before reading _sleeping (the engine does the reverse)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&_sleeping, __ATOMIC_RELAXED)) _wake();
+#endif
+    return true;
+}
+
+// Next finished transfer, false if none has finished yet
+bool PapilioEngine::receive(PapilioTransaction& txn) {
+#if !defined(ARDUINO_ARCH_ESP32)
+    _service();
+#endif
+    if (!_results.pop(txn)) return false;
+    _inFlight--;
+    return true;
+}
+
+// Receive every finished transfer; the callback can release its buffer
+// and submit the next one
+int PapilioEngine::poll(PapilioCallback callback) {
+    int completed = 0;
+    PapilioTransaction txn;
+    
+    while (receive(txn)) {
+        if (callback) callback(&txn);
+        completed++;
+    }
+    return completed;
+}
+
+// Block until the engine has finished every transfer in flight (results
+// stay queued for receive()); false on timeout
+bool PapilioEngine::wait(uint32_t timeout_ms) {
+    uint32_t start = millis();
+    
+    for (;;) {
+#if !defined(ARDUINO_ARCH_ESP32)
+        _service();
+#endif
+        if (_results.size() >= _inFlight) return true;
+        
+        uint32_t elapsed = millis() - start;
+        if (timeout_ms != UINT32_MAX && elapsed >= timeout_ms) return false;
+#if defined(ARDUINO_ARCH_ESP32)
+        vTaskDelay(1);
+#endif
+    }
+}
+
+// Snapshot of the counters (each is a single aligned word)
+PapilioEngineStats PapilioEngine::stats() const {
+    return _stats;
+}
+
+// Internal: One transfer on the bus, accounted in the counters
+void PapilioEngine::_execute(const PapilioTransaction& txn) {
+    uint32_t start = micros();
+    _spi->transferBurst(txn.txBuf, txn.rxBuf, txn.len);
+    _stats.busyUs += micros() - start;
+    _stats.transfers++;
+    _stats.bytes += txn.len;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Internal: Wake the engine task
+void PapilioEngine::_wake() {
+    __atomic_store_n(&_sleeping, false, __ATOMIC_RELAXED);
+    if (_task) xTaskNotifyGive(_task);
+}
+
+// Internal: Engine task - runs requests back to back, polls a little when
+// the ring runs dry, then sleeps until submit() wakes it
+void PapilioEngine::_taskMain(void* arg) {
+    PapilioEngine* self = static_cast<PapilioEngine*>(arg);
+    PapilioTransaction txn;
+    uint32_t spins = 0;
+    
+    while (self->_run) {
+        size_t queued = self->_requests.size();
+        if (queued > self->_stats.maxQueued) self->_stats.maxQueued = (uint32_t)queued;
+        
+        if (self->_requests.pop(txn)) {
+            self->_execute(txn);
+            self->_results.push(txn);   // Cannot fail: at most PAPILIO_ENGINE_DEPTH in flight
+            spins = 0;
+            continue;
+        }
+        if (++spins < PAPILIO_ENGINE_SPIN) continue;
+        spins = 0;
+        
+        // Publish _sleeping before the final empty check, so a submit()
+        // racing with it either is seen here or sees the flag
+        __atomic_store_n(&self->_sleeping, true, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (self->_requests.empty() && self->_run) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            self->_stats.wakeups++;
+        }
+        __atomic_store_n(&self->_sleeping, false, __ATOMIC_RELAXED);
+    }
+    
+    self->_task = nullptr;
+    vTaskDelete(nullptr);
+}
+#else
+// Internal: No task - run every queued transfer in the caller's context
+void PapilioEngine::_service() {
+    PapilioTransaction txn;
+    size_t queued = _requests.size();
+    if (queued > _stats.maxQueued) _stats.maxQueued = (uint32_t)queued;
+    
+    while (_requests.pop(txn)) {
+        _execute(txn);
+        _results.push(txn);
+    }
+}
+#endif
@@ -0,0 +1,117 @@
+// PapilioEngine.h - SPI service task pinned to its own core
+//
+// On ESP32 the engine runs every transfer of one PapilioSPI from a task
+// pinned to PAPILIO_ENGINE_CORE (0 by default; Arduino's loop() runs on
+// core 1), so application work and the bus no longer share a CPU.
+// Transfer descriptors go to the task and come back through two lock-free
+// PapilioSpscQueue rings. The only kernel call on the hot path is the
+// wake-up of a sleeping engine. Payloads live in a fixed pool of
+// cache-line aligned buffers, which means no heap allocation per transfer.
+//
+//   uint8_t* buf = engine.alloc();
+//   PapilioTransaction txn = { buf, buf, 256, nullptr };
+//   engine.submit(txn);
+//   ...
+//   while (engine.receive(txn)) { use(txn.rxBuf); engine.release(txn.rxBuf); }
+//
+// Every engine call except stats() must come from one application task.
+// While the engine runs, it owns the PapilioSPI: do not use that object (or
+// clients attached to it) directly. Elsewhere there is no task, and
+// receive()/poll()/wait() perform the queued transfers.
+//
+// The engine holds its buffer pool (about PAPILIO_ENGINE_BUFFERS x
+// PAPILIO_ENGINE_BUFFER_SIZE bytes), so make it a global rather than a local.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOENGINE_H
+#define PAPILIOENGINE_H
+
+#include <Arduino.h>
+#include "PapilioSPI.h"
+#include "PapilioSpsc.h"
+
+#ifndef PAPILIO_ENGINE_DEPTH
+#define PAPILIO_ENGINE_DEPTH 8            // Transfers in flight (power of two)
+#endif
+#ifndef PAPILIO_ENGINE_BUFFERS
+#define PAPILIO_ENGINE_BUFFERS 8          // Pool buffers
+#endif
+#ifndef PAPILIO_ENGINE_BUFFER_SIZE
+#define PAPILIO_ENGINE_BUFFER_SIZE 1024   // Bytes per pool buffer (rounded up to a cache line)
+#endif
+#ifndef PAPILIO_ENGINE_CORE
+#define PAPILIO_ENGINE_CORE 0             // Core of the engine task
+#endif
+#ifndef PAPILIO_ENGINE_STACK
+#define PAPILIO_ENGINE_STACK 3072         // Engine task stack (bytes)
+#endif
+#ifndef PAPILIO_ENGINE_PRIORITY
+#define PAPILIO_ENGINE_PRIORITY PAPILIO_SPI_TASK_PRIORITY
+#endif
+#ifndef PAPILIO_ENGINE_SPIN
+#define PAPILIO_ENGINE_SPIN 32            // Empty queue checks before the task sleeps
+#endif
+
+// Engine counters (written by the engine task)
+struct PapilioEngineStats {
+    uint32_t transfers;       // Transfers completed
+    uint32_t bytes;           // Bytes transferred
+    uint32_t busyUs;          // Time spent in transfers
+    uint32_t wakeups;         // Times the task slept and was woken by submit()
+    uint32_t maxQueued;       // Deepest request queue seen by the task
+};
+
+class PapilioEngine {
+public:
+    PapilioEngine();
+    
+    // Start the engine for an initialized PapilioSPI (ESP32: create the task)
+    bool begin(PapilioSPI* spi, int core = PAPILIO_ENGINE_CORE);
+    void end();               // Waits for transfers in flight; unreceived results are dropped
+    
+    // Buffer pool
+    uint8_t* alloc();         // nullptr if all buffers are in use
+    bool release(uint8_t* buf);
+    size_t available() const { return _pool.available(); }
+    static size_t bufferSize() { return PapilioBufferPool<PAPILIO_ENGINE_BUFFER_SIZE, PAPILIO_ENGINE_BUFFERS>::bufferSize(); }
+    
+    // Queue a transfer (copied; its buffers must stay valid until received)
+    // false if not started or PAPILIO_ENGINE_DEPTH transfers are in flight.
+    bool submit(const PapilioTransaction& txn);
+    bool receive(PapilioTransaction& txn);        // Next finished transfer, in submission order
+    int poll(PapilioCallback callback);           // Receive all finished, callback for each
+    bool wait(uint32_t timeout_ms = UINT32_MAX);  // Until every transfer in flight has finished
+    size_t inFlight() const { return _inFlight; } // Submitted, not yet received
+    
+    // Counters since begin() (safe from any task)
+    PapilioEngineStats stats() const;
+    bool running() const { return _spi != nullptr; }
+    
+private:
+    PapilioSPI* _spi;
+    size_t _inFlight;         // Application side only
+    PapilioEngineStats _stats;
+    PapilioSpscQueue<PapilioTransaction, PAPILIO_ENGINE_DEPTH> _requests;   // Application -> engine
+    PapilioSpscQueue<PapilioTransaction, PAPILIO_ENGINE_DEPTH> _results;    // Engine -> application
+    PapilioBufferPool<PAPILIO_ENGINE_BUFFER_SIZE, PAPILIO_ENGINE_BUFFERS> _pool;
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t _task;
+    volatile bool _run;
+    bool _sleeping;           // Engine is about to block (seq_cst with the queue indices)
+    
+    void _wake();
+    static void _taskMain(void* arg);
+#else
+    void _service();
+#endif
+    
+    void _execute(const PapilioTransaction& txn);
+    
+    PapilioEngine(const PapilioEngine&);             // Not copyable
+    PapilioEngine& operator=(const PapilioEngine&);
+};
+
+#endif // PAPILIOENGINE_H
@@ -0,0 +1,148 @@
+// PapilioIdfTransport.cpp - Implementation
+//
+// ESP-IDF spi_master transport (ESP32 only).
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioIdfTransport.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <string.h>
+
+// Dummy TX data for reads; in .bss so it is DMA-capable (const data is in flash)
+static uint8_t s_zeros[PAPILIO_IDF_ZERO_CHUNK];
+
+// Constructor
+PapilioIdfTransport::PapilioIdfTransport() :
+    _host(SPI2_HOST),
+    _dev(nullptr),
+    _cs(-1),
+    _speed(0),
+    _mode(0),
+    _initialized(false)
+{
+}
+
+// Initialize the bus with DMA; the device is added on the first frame
+bool PapilioIdfTransport::begin(spi_host_device_t host, int sclk, int mosi, int miso, int cs) {
+    if (_initialized) end();
+    if (cs < 0) return false;
+    
+    spi_bus_config_t bus;
+    memset(&bus, 0, sizeof(bus));
+    bus.mosi_io_num = mosi;
+    bus.miso_io_num = miso;
+    bus.sclk_io_num = sclk;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = PAPILIO_IDF_MAX_TRANSFER;
+    bus.flags = SPICOMMON_BUSFLAG_MASTER;
+    if (spi_bus_initialize(host, &bus, SPI_DMA_CH_AUTO) != ESP_OK) return false;
+    
+    _host = host;
+    _cs = cs;
+    pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
+    _initialized = true;
+    return true;
+}
+
+// Release device and bus
+void PapilioIdfTransport::end() {
+    if (!_initialized) return;
+    if (_dev) spi_bus_remove_device(_dev);
+    spi_bus_free(_host);
+    _dev = nullptr;
+    _speed = 0;
+    _initialized = false;
+}
+
+// Lock the bus; clock and mode are fixed per IDF device, so a change
+// re-adds it (only when the settings differ from the last frame)
+void PapilioIdfTransport::beginTransaction(uint32_t speed, uint8_t mode) {
+    if (!_initialized) return;
+    if (!_dev || speed != _speed || mode != _mode) {
+        if (_dev) spi_bus_remove_device(_dev);
+        _dev = nullptr;
+        if (!_addDevice(speed, mode)) return;
+    }
+    spi_device_acquire_bus(_dev, portMAX_DELAY);
+}
+
+void PapilioIdfTransport::endTransaction() {
+    if (_dev) spi_device_release_bus(_dev);
+}
+
+// Drive CS (active low)
+void PapilioIdfTransport::select(bool active) {
+    digitalWrite(_cs, active ? LOW : HIGH);
+}
+
+uint8_t PapilioIdfTransport::transfer8(uint8_t data) {
+    uint8_t rx = 0;
+    _transmit(&data, &rx, 1);
+    return rx;
+}
+
+uint16_t PapilioIdfTransport::transfer16(uint16_t data) {
+    uint8_t tx[2] = { (uint8_t)(data >> 8), (uint8_t)data };
+    uint8_t rx[2] = { 0, 0 };
+    _transmit(tx, rx, 2);
+    return (uint16_t)((rx[0] << 8) | rx[1]);
+}
+
+uint32_t PapilioIdfTransport::transfer32(uint32_t data) {
+    uint8_t tx[4] = { (uint8_t)(data >> 24), (uint8_t)(data >> 16), (uint8_t)(data >> 8), (uint8_t)data };
+    uint8_t rx[4] = { 0, 0, 0, 0 };
+    _transmit(tx, rx, 4);
+    return ((uint32_t)rx[0] << 24) | ((uint32_t)rx[1] << 16) | ((uint32_t)rx[2] << 8) | rx[3];
+}
+
+// Bulk transfer, one DMA transaction per PAPILIO_IDF_MAX_TRANSFER bytes
+// In-place buffers (txBuf == rxBuf) work too: DMA reads each TX byte before
+// the matching RX byte is written.
+void PapilioIdfTransport::transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    size_t max = txBuf ? PAPILIO_IDF_MAX_TRANSFER : PAPILIO_IDF_ZERO_CHUNK;
+    
+    while (len > 0) {
+        size_t n = len < max ? len : max;
+        _transmit(txBuf ? txBuf : s_zeros, rxBuf, n);
+        if (txBuf) txBuf += n;
+        if (rxBuf) rxBuf += n;
+        len -= n;
+    }
+}
+
+// Internal: add the device with software CS
+bool PapilioIdfTransport::_addDevice(uint32_t speed, uint8_t mode) {
+    spi_device_interface_config_t dev;
+    memset(&dev, 0, sizeof(dev));
+    dev.mode = mode;
+    dev.clock_speed_hz = speed;
+    dev.spics_io_num = -1;            // select() drives CS across transactions
+    dev.queue_size = 1;
+    if (spi_bus_add_device(_host, &dev, &_dev) != ESP_OK) {
+        _dev = nullptr;
+        return false;
+    }
+    _speed = speed;
+    _mode = mode;
+    return true;
+}
+
+// Internal: one polled full-duplex transaction
+void PapilioIdfTransport::_transmit(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    if (!_dev) return;
+    
+    spi_transaction_t t;
+    memset(&t, 0, sizeof(t));
+    t.length = len * 8;
+    t.rxlength = rxBuf ? len * 8 : 0;
+    t.tx_buffer = txBuf;
+    t.rx_buffer = rxBuf;
+    spi_device_polling_transmit(_dev, &t);
+}
+
+#endif // ARDUINO_ARCH_ESP32
@@ -0,0 +1,64 @@
+// PapilioIdfTransport.h - ESP-IDF spi_master transport for PapilioSPI
+//
+// ESP32 only. Full-duplex frames through the IDF driver with DMA, so large
+// bursts go out as one DMA transaction each instead of 64-byte peripheral
+// loads. CS is a GPIO driven by the transport (a PapilioSPI frame spans
+// several driver transactions). Like PapilioQSPI it takes over a whole SPI
+// host, so use a different host from any Arduino SPIClass.
+//
+//   PapilioIdfTransport idf;
+//   idf.begin(SPI2_HOST, SCLK, MOSI, MISO, CS);
+//   spi.begin(&idf, 8000000, SPI_MODE0);
+//
+// Buffers passed to bursts must be DMA-capable (internal RAM, not PSRAM).
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOIDFTRANSPORT_H
+#define PAPILIOIDFTRANSPORT_H
+
+#include <Arduino.h>
+#include "PapilioTransport.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/spi_master.h>
+#include <freertos/FreeRTOS.h>
+
+#ifndef PAPILIO_IDF_MAX_TRANSFER
+#define PAPILIO_IDF_MAX_TRANSFER 4092     // Bytes per DMA transaction
+#endif
+#ifndef PAPILIO_IDF_ZERO_CHUNK
+#define PAPILIO_IDF_ZERO_CHUNK 256        // Dummy bytes per transaction when txBuf is null
+#endif
+
+class PapilioIdfTransport : public PapilioTransport {
+public:
+    PapilioIdfTransport();
+    
+    bool begin(spi_host_device_t host, int sclk, int mosi, int miso, int cs);
+    void end();
+    
+    void beginTransaction(uint32_t speed, uint8_t mode) override;
+    void endTransaction() override;
+    void select(bool active) override;
+    uint8_t transfer8(uint8_t data) override;
+    uint16_t transfer16(uint16_t data) override;
+    uint32_t transfer32(uint32_t data) override;
+    void transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) override;
+    
+private:
+    spi_host_device_t _host;
+    spi_device_handle_t _dev;
+    int _cs;
+    uint32_t _speed;          // Settings the device was added with
+    uint8_t _mode;
+    bool _initialized;
+    
+    bool _addDevice(uint32_t speed, uint8_t mode);
+    void _transmit(const uint8_t* txBuf, uint8_t* rxBuf, size_t len);
+};
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // PAPILIOIDFTRANSPORT_H
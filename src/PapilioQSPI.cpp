@@ -0,0 +1,114 @@
+// PapilioQSPI.cpp - Implementation
+// 
+// Dual/Quad SPI master for the spi_slave_qspi gateware (ESP32 only).
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioQSPI.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <string.h>
+
+// Constructor
+PapilioQSPI::PapilioQSPI() :
+    _host(SPI2_HOST),
+    _dev(nullptr),
+    _lanes(4),
+    _initialized(false)
+{
+}
+
+// Initialize bus and device
+bool PapilioQSPI::begin(spi_host_device_t host, int sclk, int cs, int io0, int io1,
+                        int io2, int io3, uint32_t speed, uint8_t lanes) {
+    if (_initialized) end();
+    if (lanes != 2 && lanes != 4) return false;
+    if (lanes == 4 && (io2 < 0 || io3 < 0)) return false;
+    
+    spi_bus_config_t bus;
+    memset(&bus, 0, sizeof(bus));
+    bus.mosi_io_num = io0;
+    bus.miso_io_num = io1;
+    bus.sclk_io_num = sclk;
+    bus.quadwp_io_num = (lanes == 4) ? io2 : -1;
+    bus.quadhd_io_num = (lanes == 4) ? io3 : -1;
+    bus.max_transfer_sz = PAPILIO_QSPI_MAX_TRANSFER;
+    bus.flags = SPICOMMON_BUSFLAG_MASTER |
+                (lanes == 4 ? SPICOMMON_BUSFLAG_QUAD : SPICOMMON_BUSFLAG_DUAL);
+    if (spi_bus_initialize(host, &bus, SPI_DMA_CH_AUTO) != ESP_OK) return false;
+    
+    spi_device_interface_config_t dev;
+    memset(&dev, 0, sizeof(dev));
+    dev.command_bits = 8;             // Single-line command phase
+    dev.mode = 0;                     // spi_slave_qspi is Mode 0
+    dev.clock_speed_hz = speed;
+    dev.spics_io_num = cs;
+    dev.flags = SPI_DEVICE_HALFDUPLEX;  // Required for multi-line data
+    dev.queue_size = 1;
+    if (spi_bus_add_device(host, &dev, &_dev) != ESP_OK) {
+        spi_bus_free(host);
+        return false;
+    }
+    
+    _host = host;
+    _lanes = lanes;
+    _initialized = true;
+    return true;
+}
+
+// Release device and bus
+void PapilioQSPI::end() {
+    if (!_initialized) return;
+    spi_bus_remove_device(_dev);
+    spi_bus_free(_host);
+    _dev = nullptr;
+    _initialized = false;
+}
+
+// Write a block
+bool PapilioQSPI::write(const uint8_t* buf, size_t len) {
+    if (!buf) return false;
+    return _transfer(CMD_WRITE, buf, nullptr, len);
+}
+
+// Read a block
+bool PapilioQSPI::read(uint8_t* buf, size_t len) {
+    if (!buf) return false;
+    return _transfer(CMD_READ, nullptr, buf, len);
+}
+
+// Internal: one frame per PAPILIO_QSPI_MAX_TRANSFER bytes
+// The data phase runs on all lanes; command (and dummy) stay single-line.
+bool PapilioQSPI::_transfer(uint8_t cmd, const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    if (!_initialized) return false;
+    
+    while (len > 0) {
+        size_t n = len < PAPILIO_QSPI_MAX_TRANSFER ? len : PAPILIO_QSPI_MAX_TRANSFER;
+        
+        spi_transaction_ext_t t;
+        memset(&t, 0, sizeof(t));
+        t.base.flags = (_lanes == 4) ? SPI_TRANS_MODE_QIO : SPI_TRANS_MODE_DIO;
+        t.base.cmd = cmd;
+        if (txBuf) {
+            t.base.length = n * 8;
+            t.base.tx_buffer = txBuf;
+        } else {
+            // Turnaround clocks while the slave enables its IO drivers
+            t.base.flags |= SPI_TRANS_VARIABLE_DUMMY;
+            t.dummy_bits = PAPILIO_QSPI_DUMMY_CYCLES;
+            t.base.rxlength = n * 8;
+            t.base.rx_buffer = rxBuf;
+        }
+        
+        if (spi_device_polling_transmit(_dev, &t.base) != ESP_OK) return false;
+        
+        if (txBuf) txBuf += n;
+        if (rxBuf) rxBuf += n;
+        len -= n;
+    }
+    return true;
+}
+
+#endif // ARDUINO_ARCH_ESP32
@@ -0,0 +1,58 @@
+// PapilioQSPI.h - Dual/Quad SPI master for the spi_slave_qspi gateware
+// 
+// ESP32 only. Uses the ESP-IDF spi_master driver in half-duplex DIO/QIO
+// mode (with DMA) on its own SPI host, so it cannot share a host with an
+// Arduino SPIClass. Frames match spi_slave_qspi:
+//   Write: [CMD_WRITE on IO0][data on 2/4 lines]
+//   Read:  [CMD_READ on IO0][PAPILIO_QSPI_DUMMY_CYCLES][data on 2/4 lines]
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOQSPI_H
+#define PAPILIOQSPI_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/spi_master.h>
+
+// Must match the gateware parameters (override with build flags)
+#ifndef PAPILIO_QSPI_DUMMY_CYCLES
+#define PAPILIO_QSPI_DUMMY_CYCLES 2       // spi_slave_qspi DUMMY_CYCLES
+#endif
+#ifndef PAPILIO_QSPI_MAX_TRANSFER
+#define PAPILIO_QSPI_MAX_TRANSFER 4092    // Bytes per DMA transaction (one CS frame)
+#endif
+
+class PapilioQSPI {
+public:
+    PapilioQSPI();
+    
+    // lanes = 2 (DIO, io2/io3 unused) or 4 (QIO). Takes over the whole host.
+    bool begin(spi_host_device_t host, int sclk, int cs, int io0, int io1,
+               int io2 = -1, int io3 = -1, uint32_t speed = 1000000, uint8_t lanes = 4);
+    void end();
+    
+    // Block transfers, split into PAPILIO_QSPI_MAX_TRANSFER byte frames.
+    // Words wider than 8 bits must be stored MSB first in the buffer.
+    bool write(const uint8_t* buf, size_t len);
+    bool read(uint8_t* buf, size_t len);
+    
+    uint8_t lanes() const { return _lanes; }
+    
+private:
+    static const uint8_t CMD_WRITE = 0x01;
+    static const uint8_t CMD_READ = 0x02;
+    
+    spi_host_device_t _host;
+    spi_device_handle_t _dev;
+    uint8_t _lanes;
+    bool _initialized;
+    
+    bool _transfer(uint8_t cmd, const uint8_t* txBuf, uint8_t* rxBuf, size_t len);
+};
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // PAPILIOQSPI_H
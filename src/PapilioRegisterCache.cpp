@@ -0,0 +1,197 @@
+// PapilioRegisterCache.cpp - Implementation
+//
+// Register shadow with write combining over PapilioWishbone.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioRegisterCache.h"
+
+// Constructor
+PapilioRegisterCache::PapilioRegisterCache() :
+    _wb(nullptr),
+    _base(0),
+    _count(0),
+    _dirtyCount(0),
+    _dirtySince(0),
+    _deadline(0),
+    _stats()
+{
+    memset(_value, 0, sizeof(_value));
+    memset(_flags, 0, sizeof(_flags));
+}
+
+// Attach to a Wishbone client and clear the shadow
+bool PapilioRegisterCache::begin(PapilioWishbone* wb, uint16_t base, size_t count) {
+    if (!wb || count == 0 || count > PAPILIO_REGCACHE_SIZE) return false;
+    if ((uint32_t)base + count > 0x10000UL) return false;
+    
+    _wb = wb;
+    _base = base;
+    _count = count;
+    memset(_value, 0, sizeof(_value));
+    memset(_flags, 0, sizeof(_flags));  // All volatile
+    _dirtyCount = 0;
+    return true;
+}
+
+// Set the policy of a range inside the window
+void PapilioRegisterCache::setPolicy(uint16_t addr, PapilioRegPolicy policy, size_t n) {
+    if (policy == PAPILIO_REG_VOLATILE) flush();  // Nothing may stay dirty there
+    
+    for (size_t k = 0; k < n; k++) {
+        size_t i;
+        if (!_slot((uint16_t)(addr + k), i)) continue;
+        _flags[i] = (_flags[i] & ~FLAG_POLICY) | (uint8_t)policy;
+        if (policy == PAPILIO_REG_VOLATILE) _flags[i] &= ~FLAG_VALID;
+    }
+}
+
+// Read a register, from the shadow if possible
+uint8_t PapilioRegisterCache::read(uint16_t addr) {
+    if (!_wb) return 0;
+    poll();
+    
+    size_t i;
+    if (!_slot(addr, i) || _policy(i) == PAPILIO_REG_VOLATILE) {
+        flush();  // Earlier writes land before this read
+        _stats.misses++;
+        return _wb->read(addr);
+    }
+    
+    if ((_flags[i] & FLAG_VALID) || _policy(i) == PAPILIO_REG_WRITE_ONLY) {
+        _stats.hits++;
+        return _value[i];
+    }
+    
+    _stats.misses++;
+    _value[i] = _wb->read(addr);
+    _flags[i] |= FLAG_VALID;
+    return _value[i];
+}
+
+// Write a register, combined into the next flush unless volatile
+void PapilioRegisterCache::write(uint16_t addr, uint8_t value) {
+    if (!_wb) return;
+    
+    size_t i;
+    if (!_slot(addr, i) || _policy(i) == PAPILIO_REG_VOLATILE) {
+        flush();
+        _wb->write(addr, value);
+        return;
+    }
+    
+    _stats.writes++;
+    uint8_t flags = _flags[i];
+    if (_policy(i) == PAPILIO_REG_CACHED && (flags & FLAG_VALID) && !(flags & FLAG_DIRTY) &&
+        _value[i] == value) {
+        return;  // FPGA already holds this value
+    }
+    
+    _value[i] = value;
+    if (!(flags & FLAG_DIRTY)) {
+        if (_dirtyCount++ == 0) _dirtySince = millis();
+    }
+    _flags[i] = flags | FLAG_VALID | FLAG_DIRTY;
+    poll();
+}
+
+// Read-modify-write (no bus traffic for a loaded cached register)
+void PapilioRegisterCache::modify(uint16_t addr, uint8_t clearMask, uint8_t setMask) {
+    write(addr, (uint8_t)((read(addr) & ~clearMask) | setMask));
+}
+
+// Burst-load cached registers that hold no newer value
+void PapilioRegisterCache::load(uint16_t addr, size_t n) {
+    if (!_wb || n == 0) return;
+    
+    uint8_t buf[PAPILIO_REGCACHE_SIZE];
+    if (n > sizeof(buf)) n = sizeof(buf);
+    _wb->readBlock(addr, buf, n);
+    
+    for (size_t k = 0; k < n; k++) {
+        size_t i;
+        if (!_slot((uint16_t)(addr + k), i)) continue;
+        if (_policy(i) != PAPILIO_REG_CACHED || (_flags[i] & FLAG_DIRTY)) continue;
+        _value[i] = buf[k];
+        _flags[i] |= FLAG_VALID;
+    }
+    _stats.misses += n;
+}
+
+// Forget loaded values (dirty registers keep theirs)
+void PapilioRegisterCache::invalidate(uint16_t addr, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        size_t i;
+        if (!_slot((uint16_t)(addr + k), i)) continue;
+        if (!(_flags[i] & FLAG_DIRTY)) _flags[i] &= ~FLAG_VALID;
+    }
+}
+
+void PapilioRegisterCache::invalidateAll() {
+    invalidate(_base, _count);
+}
+
+// Send dirty registers as runs of consecutive addresses
+size_t PapilioRegisterCache::flush() {
+    if (!_wb || _dirtyCount == 0) return 0;
+    
+    size_t frames = 0;
+    size_t i = 0;
+    while (i < _count) {
+        if (!(_flags[i] & FLAG_DIRTY)) {
+            i++;
+            continue;
+        }
+        
+        // Extend the run over dirty registers and short bridgeable gaps
+        size_t start = i;
+        size_t end = i + 1;
+        while (end < _count) {
+            if (_flags[end] & FLAG_DIRTY) {
+                end++;
+                continue;
+            }
+            size_t gap = end;
+            while (gap < _count && gap - end < PAPILIO_REGCACHE_MAX_GAP && _bridgeable(gap)) {
+                gap++;
+            }
+            if (gap < _count && (_flags[gap] & FLAG_DIRTY)) {
+                end = gap + 1;
+            } else {
+                break;
+            }
+        }
+        
+        _wb->writeBlock((uint16_t)(_base + start), _value + start, end - start);
+        for (size_t k = start; k < end; k++) {
+            _flags[k] &= ~FLAG_DIRTY;
+        }
+        frames++;
+        i = end;
+    }
+    
+    _dirtyCount = 0;
+    _stats.bursts += frames;
+    return frames;
+}
+
+// Flush once the deadline has passed
+void PapilioRegisterCache::poll() {
+    if (_deadline && _dirtyCount && (uint32_t)(millis() - _dirtySince) >= _deadline) {
+        flush();
+    }
+}
+
+// Internal: window index of addr
+bool PapilioRegisterCache::_slot(uint16_t addr, size_t& index) const {
+    if (addr < _base || (size_t)(addr - _base) >= _count) return false;
+    index = addr - _base;
+    return true;
+}
+
+// Internal: clean register that can be rewritten with the value it holds
+bool PapilioRegisterCache::_bridgeable(size_t index) const {
+    uint8_t flags = _flags[index];
+    return _policy(index) == PAPILIO_REG_CACHED && (flags & FLAG_VALID) && !(flags & FLAG_DIRTY);
+}
@@ -0,0 +1,106 @@
+// PapilioRegisterCache.h - Host-side register shadow over PapilioWishbone
+//
+// Keeps a copy of a window of FPGA registers so read-modify-write cycles
+// and repeated reads cost no bus traffic. Each register has a policy:
+// - Volatile (default): every access goes to the FPGA, after a flush so
+//   program order is kept
+// - Cached: reads are served from the shadow once loaded, writes only mark
+//   the register dirty (writing the value it already holds is dropped)
+// - Write-only: never read back; reads return the last value written
+// Dirty registers go out on flush() (or once the flush deadline passes) as
+// one writeBlock() frame per run of consecutive addresses. Short clean gaps
+// of loaded cached registers are rewritten with their own value so nearby
+// runs share a frame.
+//
+// Only declare registers cached if reading and rewriting them has no side
+// effects; use invalidate() when the FPGA may have changed one.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOREGISTERCACHE_H
+#define PAPILIOREGISTERCACHE_H
+
+#include <Arduino.h>
+#include "PapilioWishbone.h"
+
+#ifndef PAPILIO_REGCACHE_SIZE
+#define PAPILIO_REGCACHE_SIZE 256         // Registers in the shadow window
+#endif
+#ifndef PAPILIO_REGCACHE_MAX_GAP
+#define PAPILIO_REGCACHE_MAX_GAP 3        // Clean registers bridged (= one frame header)
+#endif
+
+enum PapilioRegPolicy {
+    PAPILIO_REG_VOLATILE = 0,   // Always on the bus
+    PAPILIO_REG_CACHED = 1,     // Shadowed reads, combined writes
+    PAPILIO_REG_WRITE_ONLY = 2  // Combined writes, reads from the shadow only
+};
+
+// Cache counters
+struct PapilioRegCacheStats {
+    uint32_t hits;            // Reads served from the shadow
+    uint32_t misses;          // Reads that went to the FPGA
+    uint32_t writes;          // Writes absorbed into the shadow
+    uint32_t bursts;          // Frames sent by flush()
+};
+
+class PapilioRegisterCache {
+public:
+    PapilioRegisterCache();
+    
+    // Shadow registers base .. base + count - 1 (count <= PAPILIO_REGCACHE_SIZE).
+    // Addresses outside the window behave as volatile.
+    bool begin(PapilioWishbone* wb, uint16_t base, size_t count);
+    
+    // Policy for n registers from addr (pending writes of registers made
+    // volatile are flushed first)
+    void setPolicy(uint16_t addr, PapilioRegPolicy policy, size_t n = 1);
+    
+    uint8_t read(uint16_t addr);
+    void write(uint16_t addr, uint8_t value);
+    // Read-modify-write: value = (value & ~clearMask) | setMask
+    void modify(uint16_t addr, uint8_t clearMask, uint8_t setMask);
+    
+    // Fill the shadow of n cached registers with one burst read. The bridge
+    // reads one address past the block, so addr + n must be safe to read.
+    void load(uint16_t addr, size_t n);
+    
+    // Drop loaded values; the next read of a cached register goes to the
+    // FPGA. Pending writes are kept.
+    void invalidate(uint16_t addr, size_t n = 1);
+    void invalidateAll();
+    
+    // Write all dirty registers, returns frames sent
+    size_t flush();
+    
+    // Flush automatically once the oldest pending write is ms old (0 = only
+    // on flush()). Checked on every access and by poll().
+    void setFlushDeadline(uint32_t ms) { _deadline = ms; }
+    void poll();
+    
+    size_t dirty() const { return _dirtyCount; }
+    PapilioRegCacheStats stats() const { return _stats; }
+    void resetStats() { _stats = PapilioRegCacheStats(); }
+    
+private:
+    static const uint8_t FLAG_POLICY = 0x03;
+    static const uint8_t FLAG_VALID = 0x04;   // Shadow holds the register's value
+    static const uint8_t FLAG_DIRTY = 0x08;   // Written, not yet flushed
+    
+    PapilioWishbone* _wb;
+    uint16_t _base;
+    size_t _count;
+    uint8_t _value[PAPILIO_REGCACHE_SIZE];
+    uint8_t _flags[PAPILIO_REGCACHE_SIZE];
+    size_t _dirtyCount;
+    uint32_t _dirtySince;     // millis() of the oldest pending write
+    uint32_t _deadline;
+    PapilioRegCacheStats _stats;
+    
+    bool _slot(uint16_t addr, size_t& index) const;
+    uint8_t _policy(size_t index) const { return _flags[index] & FLAG_POLICY; }
+    bool _bridgeable(size_t index) const;
+};
+
+#endif // PAPILIOREGISTERCACHE_H
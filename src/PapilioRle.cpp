@@ -0,0 +1,80 @@
+// PapilioRle.cpp - Implementation
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioRle.h"
+
+// Constructor
+PapilioRleDecoder::PapilioRleDecoder() {
+    reset(1);
+}
+
+// Start a new stream
+void PapilioRleDecoder::reset(uint8_t wordBytes) {
+    _wordBytes = (wordBytes == 2 || wordBytes == 4) ? wordBytes : 1;
+    memset(_prev, 0, sizeof(_prev));
+    _havePrev = false;
+    _expectCount = false;
+    _pending = 0;
+}
+
+// Expand encoded words into out
+size_t PapilioRleDecoder::decode(const uint8_t* in, size_t inLen, size_t* consumed,
+                                 uint8_t* out, size_t outLen) {
+    const size_t wb = _wordBytes;
+    size_t written = _flush(out, outLen);
+    size_t used = 0;
+    
+    if (in) {
+        while (_pending == 0 && used + wb <= inLen) {
+            const uint8_t* w = in + used;
+            
+            if (_expectCount) {
+                // Count (MSB first): that many more copies of _prev
+                uint32_t count = 0;
+                for (size_t i = 0; i < wb; i++) {
+                    count = (count << 8) | w[i];
+                }
+                _pending = count;
+                _expectCount = false;
+                _havePrev = false;
+                used += wb;
+                written += _flush(out + written, outLen - written);
+                continue;
+            }
+            
+            if (written + wb > outLen) break;
+            
+            if (_havePrev && memcmp(w, _prev, wb) == 0) {
+                _expectCount = true;           // Second copy: a count follows
+            } else {
+                memcpy(_prev, w, wb);
+                _havePrev = true;
+            }
+            memcpy(out + written, w, wb);
+            written += wb;
+            used += wb;
+        }
+    }
+    
+    if (consumed) *consumed = used;
+    return written;
+}
+
+// Internal: write pending run samples that fit
+size_t PapilioRleDecoder::_flush(uint8_t* out, size_t outLen) {
+    const size_t wb = _wordBytes;
+    size_t n = outLen / wb;
+    if (n > _pending) n = _pending;
+    
+    if (wb == 1) {
+        memset(out, _prev[0], n);
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            memcpy(out + i * wb, _prev, wb);
+        }
+    }
+    _pending -= (uint32_t)n;
+    return n * wb;
+}
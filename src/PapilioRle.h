@@ -0,0 +1,50 @@
+// PapilioRle.h - Streaming decoder for the rle_encoder gateware
+//
+// rle_encoder sends every sample word as is, except that a word equal to
+// the one before it is followed by a count word: A A n means 2 + n copies
+// of A, and the word after a count always starts afresh. Data without
+// repeats costs nothing extra; a run costs 3 words per 2^width + 1 samples.
+//
+// The decoder keeps its state between calls, so input can be fed in any
+// pieces and output drained into any spans (such as the two halves of a
+// wrapping ring). PapilioSPI::setStreamRle() uses it to expand captures
+// straight into the stream ring.
+//
+// Words are in wire order (MSB first), as PapilioSPI bursts store them.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIORLE_H
+#define PAPILIORLE_H
+
+#include <Arduino.h>
+
+class PapilioRleDecoder {
+public:
+    PapilioRleDecoder();
+    
+    // Start a new stream of 1, 2 or 4-byte words
+    void reset(uint8_t wordBytes = 1);
+    
+    // Expand whole words of in into out. Stops when the input is used up
+    // or out has no room for the next sample; *consumed (may be null) gets
+    // the input bytes taken. Returns bytes written to out.
+    // A count word is always taken; samples it leaves over come out on the
+    // next call, which may have no input (decode(nullptr, 0, ...)).
+    size_t decode(const uint8_t* in, size_t inLen, size_t* consumed, uint8_t* out, size_t outLen);
+    
+    uint32_t pending() const { return _pending; }  // Run samples not yet written
+    uint8_t wordBytes() const { return _wordBytes; }
+    
+private:
+    uint8_t _wordBytes;
+    uint8_t _prev[4];         // Last literal (the run value)
+    bool _havePrev;           // _prev can start a run
+    bool _expectCount;        // Previous two literals matched, next word is the count
+    uint32_t _pending;
+    
+    size_t _flush(uint8_t* out, size_t outLen);
+};
+
+#endif // PAPILIORLE_H
@@ -8,111 +8,684 @@
 
 #include "PapilioSPI.h"
 
+// CRC-16/CCITT-FALSE (poly 0x1021), one entry per byte value - matches
+// crc16_word() in spi_slave_crc.v
+static const uint16_t CRC16_TABLE[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+#if !defined(ARDUINO_ARCH_ESP32)
+PapilioSPI* PapilioSPI::_irqOwner = nullptr;
+#endif
+
 // Constructor
 PapilioSPI::PapilioSPI() : 
     _spi(nullptr),
+    _transport(nullptr),
     _cs(-1),
     _speed(1000000),
     _mode(SPI_MODE0),
     _bitWidth(8),
-    _initialized(false)
+    _initialized(false),
+    _settings(1000000, MSBFIRST, SPI_MODE0),
+    _statusHeader(false),
+    _statusTxWords(0),
+    _txCredit(0),
+    _crcFraming(false),
+    _wrSeq(0),
+    _rdSeq(0),
+    _statusWrSeq(0),
+    _statusRdSeq(0),
+    _rdSkip(0),
+    _lastReadWords(0),
+    _linkStats(),
+    _calibration(),
+#if PAPILIO_SPI_STATS
+    _stats(),
+    _statsPath(PAPILIO_PATH_FRAME),
+    _statsStart(0),
+    _statsWire(0),
+#endif
+    _csMode(PAPILIO_CS_SOFTWARE),
+    _csSetupNs(0),
+    _csHoldNs(0),
+    _csSetupDelay(0),
+    _csHoldDelay(0),
+#if defined(ARDUINO_ARCH_ESP32)
+    _csMask(0),
+    _csSetReg(0),
+    _csClrReg(0),
+#endif
+    _pending(0),
+#if defined(ARDUINO_ARCH_ESP32)
+    _submitQueue(nullptr),
+    _doneQueue(nullptr),
+    _worker(nullptr),
+#else
+    _queueHead(0),
+#endif
+    _irqPin(-1),
+    _irqHandler(nullptr),
+    _irqUser(nullptr),
+    _irqFlag(false),
+#if defined(ARDUINO_ARCH_ESP32)
+    _irqSignal(nullptr),
+    _irqTask(nullptr),
+    _irqRun(false),
+#endif
+    _streamBuf(nullptr),
+    _streamSize(0),
+    _streamWatermark(0),
+    _streamHead(0),
+    _streamTail(0),
+    _streamCallback(nullptr),
+    _streamUser(nullptr),
+    _streamStalled(false),
+    _streamStats(),
+    _streamRle(false),
+    _rleStageLen(0),
+    _rleStagePos(0)
+#if defined(ARDUINO_ARCH_ESP32)
+    ,
+    _streamTask(nullptr),
+    _streamRun(false)
+#endif
 {
+    setTimingProfile(PAPILIO_SPI_SYS_CLOCK_HZ, PAPILIO_SPI_SYNC_STAGES);
 }
 
 // Initialize SPI interface
 bool PapilioSPI::begin(SPIClass* spi, int cs_pin, uint32_t speed, uint8_t mode) {
     _spi = spi;
+    _transport = nullptr;
     _cs = cs_pin;
     _speed = speed;
     _mode = mode;
+    _settings = SPISettings(_speed, MSBFIRST, _mode);
     _bitWidth = 8;  // Default to 8-bit
     
     // Configure CS pin
     pinMode(_cs, OUTPUT);
     digitalWrite(_cs, HIGH);  // CS idle high
+    _csMode = PAPILIO_CS_SOFTWARE;
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    // Precompute the set/clear registers so CS toggles are single writes
+    _csMask = (_cs >= 0) ? (1UL << (_cs & 31)) : 0;
+#if SOC_GPIO_PIN_COUNT > 32
+    _csSetReg = (_cs >= 32) ? GPIO_OUT1_W1TS_REG : GPIO_OUT_W1TS_REG;
+    _csClrReg = (_cs >= 32) ? GPIO_OUT1_W1TC_REG : GPIO_OUT_W1TC_REG;
+#else
+    _csSetReg = GPIO_OUT_W1TS_REG;
+    _csClrReg = GPIO_OUT_W1TC_REG;
+#endif
+#endif
+    _updateCsDelays();  // CPU clock is known now
+#if PAPILIO_SPI_STATS
+    resetStats();
+#endif
     
     _initialized = true;
+    if (speed == PAPILIO_SPI_AUTO_SPEED) {
+        _speed = PAPILIO_SPI_CAL_MIN_HZ;
+        _settings = SPISettings(_speed, MSBFIRST, _mode);
+        if (calibrate() == 0) {
+            _initialized = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Initialize over a transport backend
+bool PapilioSPI::begin(PapilioTransport* transport, uint32_t speed, uint8_t mode) {
+    if (!transport) return false;
+    _spi = nullptr;
+    _transport = transport;
+    _cs = -1;
+    _speed = speed;
+    _mode = mode;
+    _bitWidth = 8;
+    _csMode = PAPILIO_CS_SOFTWARE;
+    _updateCsDelays();
+#if PAPILIO_SPI_STATS
+    resetStats();
+#endif
+    
+    _initialized = true;
+    if (speed == PAPILIO_SPI_AUTO_SPEED) {
+        _speed = PAPILIO_SPI_CAL_MIN_HZ;
+        if (calibrate() == 0) {
+            _initialized = false;
+            return false;
+        }
+    }
     return true;
 }
 
 // Release SPI interface
 void PapilioSPI::end() {
+    detachDataReady();
+    stopStream();
+    wait();  // Let queued transfers finish before the bus goes away
+#if defined(ARDUINO_ARCH_ESP32)
+    _stopWorker();
+#endif
     _initialized = false;
     _spi = nullptr;
+    _transport = nullptr;
 }
 
 // 8-bit transfer
 uint8_t PapilioSPI::transfer8(uint8_t data) {
-    if (!_initialized || !_spi) return 0;
-    
-    uint8_t result;
-    _beginTransaction();
-    _csLow();
-    result = _spi->transfer(data);
-    _csHigh();
-    _endTransaction();
-    
+    if (!_beginFrame(PAPILIO_PATH_TRANSFER8)) return 0;
+    uint8_t result = put8(data);
+    endFrame();
     return result;
 }
 
 // 16-bit transfer (MSB first)
 uint16_t PapilioSPI::transfer16(uint16_t data) {
-    if (!_initialized || !_spi) return 0;
+    if (!_beginFrame(PAPILIO_PATH_TRANSFER16)) return 0;
+    uint16_t result = put16(data);
+    endFrame();
+    return result;
+}
+
+// 32-bit transfer (MSB first)
+uint32_t PapilioSPI::transfer32(uint32_t data) {
+    if (!_beginFrame(PAPILIO_PATH_TRANSFER32)) return 0;
+    uint32_t result = put32(data);
+    endFrame();
+    return result;
+}
+
+// Burst transfer - efficient for multiple bytes
+// The whole buffer is handed to the SPI driver in bulk; txBuf may equal rxBuf.
+void PapilioSPI::transferBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    if (len == 0 || !_beginFrame(PAPILIO_PATH_BURST)) return;
+    putBurst(txBuf, rxBuf, len);
+    endFrame();
+}
+
+// 16-bit word burst
+void PapilioSPI::transferBurst16(const uint16_t* txBuf, uint16_t* rxBuf, size_t count) {
+    if (count == 0 || !_beginFrame(PAPILIO_PATH_BURST)) return;
+    putBurst16(txBuf, rxBuf, count);
+    endFrame();
+}
+
+// 32-bit word burst
+void PapilioSPI::transferBurst32(const uint32_t* txBuf, uint32_t* rxBuf, size_t count) {
+    if (count == 0 || !_beginFrame(PAPILIO_PATH_BURST)) return;
+    putBurst32(txBuf, rxBuf, count);
+    endFrame();
+}
+
+// Scatter-gather burst in one frame
+bool PapilioSPI::transferv(const PapilioSegment* segs, size_t n) {
+    if (!segs) return false;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t width = segs[i].width;
+        if (width != 0 && width != 8 && width != 16 && width != 32) return false;
+    }
+    if (!_beginFrame(PAPILIO_PATH_BURST)) return false;
+    putv(segs, n);
+    endFrame();
+    return true;
+}
+
+// Take the bus and assert CS for a multi-word frame
+bool PapilioSPI::beginFrame() {
+    return _beginFrame(PAPILIO_PATH_FRAME);
+}
+
+// Release CS and the bus
+void PapilioSPI::endFrame() {
+#if PAPILIO_SPI_STATS
+    uint32_t wireEnd = _statsNow();
+    _csHigh();
+    _statsRecord(wireEnd);  // Stamps were stored under the bus too, so tasks never race here
+#else
+    _csHigh();
+#endif
+    _endTransaction();
+}
+
+// In-frame 8-bit word
+uint8_t PapilioSPI::put8(uint8_t data) {
+    _statsBytes(1, 1);
+    if (_transport) return _transport->transfer8(data);
+    return _spi->transfer(data);
+}
+
+// In-frame 16-bit word - single native frame (MSB first)
+uint16_t PapilioSPI::put16(uint16_t data) {
+    _statsBytes(2, 2);
+    if (_transport) return _transport->transfer16(data);
+    return _spi->transfer16(data);
+}
+
+// In-frame 32-bit word - single native frame where the driver supports it
+uint32_t PapilioSPI::put32(uint32_t data) {
+    _statsBytes(4, 4);
+    if (_transport) return _transport->transfer32(data);
+#if defined(ARDUINO_ARCH_ESP32)
+    return _spi->transfer32(data);
+#else
+    uint32_t result = ((uint32_t)_spi->transfer16(data >> 16) << 16);
+    result |= _spi->transfer16(data & 0xFFFF);
+    return result;
+#endif
+}
+
+// In-frame scatter-gather - each segment through its width's burst path
+bool PapilioSPI::putv(const PapilioSegment* segs, size_t n) {
+    if (!segs) return false;
     
-    uint16_t result;
-    _beginTransaction();
-    _csLow();
+    for (size_t i = 0; i < n; i++) {
+        const PapilioSegment& seg = segs[i];
+        if (seg.count == 0) continue;
+        switch (seg.width) {
+            case 0:
+            case 8:
+                putBurst(static_cast<const uint8_t*>(seg.txBuf), static_cast<uint8_t*>(seg.rxBuf), seg.count);
+                break;
+            case 16:
+                putBurst16(static_cast<const uint16_t*>(seg.txBuf), static_cast<uint16_t*>(seg.rxBuf), seg.count);
+                break;
+            case 32:
+                putBurst32(static_cast<const uint32_t*>(seg.txBuf), static_cast<uint32_t*>(seg.rxBuf), seg.count);
+                break;
+            default:
+                return false;  // Earlier segments are already on the wire
+        }
+    }
+    return true;
+}
+
+// In-frame burst
+void PapilioSPI::putBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    if (len > 0) {
+        _transferBytes(txBuf, rxBuf, len);
+    }
+}
+
+// In-frame 16-bit burst
+// Words are swapped to MSB-first byte order one chunk at a time into a
+// staging buffer, shifted in place, and swapped back into rxBuf.
+void PapilioSPI::putBurst16(const uint16_t* txBuf, uint16_t* rxBuf, size_t count) {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (txBuf && !rxBuf && !_transport) {
+        _statsBytes(count * 2, 0);
+        _spi->writePixels(txBuf, count * 2);  // Driver swaps 16-bit words itself
+        return;
+    }
+#endif
+    uint16_t stage[BURST_CHUNK_SIZE / 2];
     
-    // Send/receive high byte first
-    uint8_t high = _spi->transfer((data >> 8) & 0xFF);
-    uint8_t low = _spi->transfer(data & 0xFF);
+    while (count > 0) {
+        size_t n = count < BURST_CHUNK_SIZE / 2 ? count : BURST_CHUNK_SIZE / 2;
+        if (txBuf) {
+            _swap16(stage, txBuf, n);
+            txBuf += n;
+        } else {
+            memset(stage, 0, n * 2);
+        }
+        _transferBytes((uint8_t*)stage, rxBuf ? (uint8_t*)stage : nullptr, n * 2);
+        if (rxBuf) {
+            _swap16(rxBuf, stage, n);
+            rxBuf += n;
+        }
+        count -= n;
+    }
+}
+
+// In-frame 32-bit burst (same staging as putBurst16)
+void PapilioSPI::putBurst32(const uint32_t* txBuf, uint32_t* rxBuf, size_t count) {
+    uint32_t stage[BURST_CHUNK_SIZE / 4];
     
-    _csHigh();
-    _endTransaction();
+    while (count > 0) {
+        size_t n = count < BURST_CHUNK_SIZE / 4 ? count : BURST_CHUNK_SIZE / 4;
+        if (txBuf) {
+            _swap32(stage, txBuf, n);
+            txBuf += n;
+        } else {
+            memset(stage, 0, n * 4);
+        }
+        _transferBytes((uint8_t*)stage, rxBuf ? (uint8_t*)stage : nullptr, n * 4);
+        if (rxBuf) {
+            _swap32(rxBuf, stage, n);
+            rxBuf += n;
+        }
+        count -= n;
+    }
+}
+
+// Scoped frame - acquire on construction
+PapilioSPI::Transaction::Transaction(PapilioSPI& spi) :
+    _owner(spi),
+    _active(spi.beginFrame())
+{
+}
+
+// Scoped frame - release on destruction
+PapilioSPI::Transaction::~Transaction() {
+    if (_active) {
+        _owner.endFrame();
+    }
+}
+
+uint8_t PapilioSPI::Transaction::put8(uint8_t data) {
+    return _active ? _owner.put8(data) : 0;
+}
+
+uint16_t PapilioSPI::Transaction::put16(uint16_t data) {
+    return _active ? _owner.put16(data) : 0;
+}
+
+uint32_t PapilioSPI::Transaction::put32(uint32_t data) {
+    return _active ? _owner.put32(data) : 0;
+}
+
+void PapilioSPI::Transaction::putBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    if (_active) {
+        _owner.putBurst(txBuf, rxBuf, len);
+    }
+}
+
+void PapilioSPI::Transaction::putBurst16(const uint16_t* txBuf, uint16_t* rxBuf, size_t count) {
+    if (_active) {
+        _owner.putBurst16(txBuf, rxBuf, count);
+    }
+}
+
+void PapilioSPI::Transaction::putBurst32(const uint32_t* txBuf, uint32_t* rxBuf, size_t count) {
+    if (_active) {
+        _owner.putBurst32(txBuf, rxBuf, count);
+    }
+}
+
+bool PapilioSPI::Transaction::putv(const PapilioSegment* segs, size_t n) {
+    return _active && _owner.putv(segs, n);
+}
+
+// Queue a burst transfer without waiting for it
+// Returns false if not initialized or PAPILIO_SPI_QUEUE_DEPTH transfers are pending.
+bool PapilioSPI::submit(PapilioTransaction* txn, PapilioCallback callback) {
+    if (!_initialized || !_hasBus() || !txn) return false;
+    if (_pending >= PAPILIO_SPI_QUEUE_DEPTH) return false;
     
-    result = ((uint16_t)high << 8) | low;
-    return result;
+    QueueEntry entry = { txn, callback };
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    if (!_worker && !_startWorker()) return false;
+    if (xQueueSend(_submitQueue, &entry, 0) != pdTRUE) return false;
+#else
+    _queue[(_queueHead + _pending) % PAPILIO_SPI_QUEUE_DEPTH] = entry;
+#endif
+    
+    _pending++;
+    return true;
 }
 
-// 32-bit transfer (MSB first)
-uint32_t PapilioSPI::transfer32(uint32_t data) {
-    if (!_initialized || !_spi) return 0;
+// Run callbacks for finished transfers
+// Without a worker task, performs the oldest queued transfer first.
+int PapilioSPI::poll() {
+    int completed = 0;
     
-    uint32_t result;
-    _beginTransaction();
-    _csLow();
+#if defined(ARDUINO_ARCH_ESP32)
+    QueueEntry entry;
+    while (_doneQueue && xQueueReceive(_doneQueue, &entry, 0) == pdTRUE) {
+        _complete(entry);
+        completed++;
+    }
+#else
+    if (_pending > 0) {
+        QueueEntry entry = _queue[_queueHead];
+        _queueHead = (_queueHead + 1) % PAPILIO_SPI_QUEUE_DEPTH;
+        transferBurst(entry.txn->txBuf, entry.txn->rxBuf, entry.txn->len);
+        _complete(entry);
+        completed++;
+    }
+    if (streaming()) {
+        _streamDrain();
+    }
+    if (_irqHandler && _irqFlag) {
+        _irqFlag = false;
+        if (_dataReadyDrain() > 0) completed++;
+    }
+#endif
     
-    // Send/receive bytes in big-endian order
-    uint8_t b3 = _spi->transfer((data >> 24) & 0xFF);
-    uint8_t b2 = _spi->transfer((data >> 16) & 0xFF);
-    uint8_t b1 = _spi->transfer((data >> 8) & 0xFF);
-    uint8_t b0 = _spi->transfer(data & 0xFF);
+    completed += _streamDeliver();
+    return completed;
+}
+
+// Block until every submitted transfer has completed and its callback has run
+// Returns false on timeout.
+bool PapilioSPI::wait(uint32_t timeout_ms) {
+    uint32_t start = millis();
     
-    _csHigh();
-    _endTransaction();
+    while (_pending > 0) {
+        uint32_t elapsed = millis() - start;
+        if (timeout_ms != UINT32_MAX && elapsed >= timeout_ms) return false;
+        
+#if defined(ARDUINO_ARCH_ESP32)
+        TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY
+                                                      : pdMS_TO_TICKS(timeout_ms - elapsed);
+        QueueEntry entry;
+        if (xQueueReceive(_doneQueue, &entry, ticks) != pdTRUE) return false;
+        _complete(entry);
+#else
+        poll();
+#endif
+    }
     
-    result = ((uint32_t)b3 << 24) | ((uint32_t)b2 << 16) | 
-             ((uint32_t)b1 << 8) | b0;
-    return result;
+    return true;
 }
 
-// Burst transfer - efficient for multiple bytes
-void PapilioSPI::transferBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
-    if (!_initialized || !_spi || len == 0) return;
+// Number of submitted transfers whose callback has not run yet
+size_t PapilioSPI::pending() const {
+    return _pending;
+}
+
+// Start continuous capture into a caller-owned ring buffer
+// size must be a multiple of the word size; one word of it stays unused.
+bool PapilioSPI::startStream(uint8_t* ring, size_t size, PapilioStreamCallback callback,
+                             size_t watermark, void* user) {
+    size_t wordBytes = _bitWidth / 8;
+    if (!_initialized || !_hasBus() || !_statusHeader || streaming() || _pending > 0) return false;
+    if (!ring || size < 2 * wordBytes || size % wordBytes != 0) return false;
     
-    _beginTransaction();
-    _csLow();
+    _streamSize = size;
+    _streamWatermark = (watermark == 0 || watermark >= size) ? size / 2 : watermark;
+    _streamHead = 0;
+    _streamTail = 0;
+    _streamCallback = callback;
+    _streamUser = user;
+    _streamStalled = false;
+    _streamStats = PapilioStreamStats();
+    _rle.reset((uint8_t)wordBytes);
+    _rleStageLen = 0;
+    _rleStagePos = 0;
+    _streamBuf = ring;
     
-    for (size_t i = 0; i < len; i++) {
-        uint8_t txByte = txBuf ? txBuf[i] : 0x00;
-        uint8_t rxByte = _spi->transfer(txByte);
-        if (rxBuf) {
-            rxBuf[i] = rxByte;
+#if defined(ARDUINO_ARCH_ESP32)
+    _streamRun = true;
+    if (xTaskCreatePinnedToCore(_streamTaskMain, "papilio_stream", PAPILIO_SPI_STREAM_STACK,
+                                this, PAPILIO_SPI_STREAM_PRIORITY, &_streamTask,
+                                PAPILIO_SPI_STREAM_CORE) != pdPASS) {
+        _streamTask = nullptr;
+        _streamRun = false;
+        _streamBuf = nullptr;
+        return false;
+    }
+#endif
+    return true;
+}
+
+// Expand rle_encoder output while streaming
+bool PapilioSPI::setStreamRle(bool enable) {
+    if (streaming()) return false;
+    _streamRle = enable;
+    return true;
+}
+
+// Stop capture; bytes not yet released stay in the ring
+void PapilioSPI::stopStream() {
+    if (!streaming()) return;
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    _streamRun = false;
+    while (_streamTask) {
+        vTaskDelay(1);  // Task finishes its current frame, then clears the handle
+    }
+#endif
+    _streamBuf = nullptr;
+}
+
+// Bytes captured and not yet released
+size_t PapilioSPI::streamAvailable() const {
+    if (!streaming()) return 0;
+    size_t head = _streamHead;
+    size_t tail = _streamTail;
+    return (head >= tail) ? head - tail : _streamSize - tail + head;
+}
+
+// Oldest buffered bytes, up to the end of the ring (call again after
+// releasing to get the part that wrapped to the start)
+size_t PapilioSPI::streamPeek(const uint8_t** data) const {
+    if (!streaming() || !data) return 0;
+    size_t head = _streamHead;
+    size_t tail = _streamTail;
+    *data = _streamBuf + tail;
+    return (head >= tail) ? head - tail : _streamSize - tail;
+}
+
+// Give consumed bytes back to the drain side
+void PapilioSPI::streamRelease(size_t len) {
+    size_t available = streamAvailable();
+    if (len > available) len = available;
+    if (len == 0) return;
+    
+    __sync_synchronize();  // Finish reading the span before the drain side may refill it
+    _streamTail = (_streamTail + len) % _streamSize;
+}
+
+// Watch the FPGA's data-ready line; with a handler, drain on every edge
+bool PapilioSPI::attachDataReady(int pin, size_t threshold, PapilioDataReadyHandler handler,
+                                 void* user) {
+    if (!_initialized || !_hasBus() || pin < 0 || _irqPin >= 0) return false;
+    if (!_statusHeader) return false;  // Without it the words announced by irq are not kept
+#if !defined(ARDUINO_ARCH_ESP32)
+    if (_irqOwner) return false;
+#endif
+    
+    (void)threshold;
+    _irqPin = pin;
+    _irqHandler = handler;
+    _irqUser = user;
+    _irqFlag = false;
+    pinMode(pin, INPUT);
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    _irqSignal = xSemaphoreCreateBinary();
+    _irqRun = true;
+    if (!_irqSignal ||
+        (handler && xTaskCreate(_irqTaskMain, "papilio_irq", PAPILIO_SPI_IRQ_STACK, this,
+                                PAPILIO_SPI_IRQ_PRIORITY, &_irqTask) != pdPASS)) {
+        _irqTask = nullptr;
+        _irqRun = false;
+        if (_irqSignal) vSemaphoreDelete(_irqSignal);
+        _irqSignal = nullptr;
+        _irqPin = -1;
+        return false;
+    }
+    attachInterruptArg(digitalPinToInterrupt(pin), _irqIsr, this, RISING);
+    if (digitalRead(pin) == HIGH) {
+        xSemaphoreGive(_irqSignal);  // Data was already waiting
+    }
+#else
+    _irqOwner = this;
+    attachInterrupt(digitalPinToInterrupt(pin), _irqIsr, RISING);
+    if (digitalRead(pin) == HIGH) _irqFlag = true;
+#endif
+    return true;
+}
+
+// Stop watching the data-ready line (waits for a drain in progress)
+void PapilioSPI::detachDataReady() {
+    if (_irqPin < 0) return;
+    detachInterrupt(digitalPinToInterrupt(_irqPin));
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    _irqRun = false;
+    if (_irqTask) {
+        xSemaphoreGive(_irqSignal);
+        while (_irqTask) {
+            vTaskDelay(1);  // Task finishes its current drain, then clears the handle
         }
     }
+    vSemaphoreDelete(_irqSignal);
+    _irqSignal = nullptr;
+#else
+    _irqOwner = nullptr;
+#endif
+    _irqPin = -1;
+    _irqHandler = nullptr;
+}
+
+// Block until the data-ready line rises (or is already high)
+bool PapilioSPI::waitDataReady(uint32_t timeout_ms) {
+    if (_irqPin < 0 || _irqHandler) return false;  // The drain task owns the events
+    if (digitalRead(_irqPin) == HIGH) return true;
     
-    _csHigh();
-    _endTransaction();
+#if defined(ARDUINO_ARCH_ESP32)
+    TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (xSemaphoreTake(_irqSignal, ticks) == pdTRUE) return true;
+#else
+    uint32_t start = millis();
+    while (!_irqFlag) {
+        if (timeout_ms != UINT32_MAX && millis() - start >= timeout_ms) break;
+        yield();
+    }
+    if (_irqFlag) {
+        _irqFlag = false;
+        return true;
+    }
+#endif
+    return digitalRead(_irqPin) == HIGH;
 }
 
 // Set bit width (8, 16, or 32)
@@ -125,77 +698,805 @@ void PapilioSPI::setBitWidth(uint8_t width) {
 // Set SPI speed
 void PapilioSPI::setSpeed(uint32_t hz) {
     _speed = hz;
+    _settings = SPISettings(_speed, MSBFIRST, _mode);
 }
 
 // Set SPI mode
 void PapilioSPI::setMode(uint8_t mode) {
     if (mode <= SPI_MODE3) {
         _mode = mode;
+        _settings = SPISettings(_speed, MSBFIRST, _mode);
     }
 }
 
-// Check if any data available (basic heuristic)
-// Note: This is a simplified implementation. For true FIFO status,
-// you would need a status register in your FPGA design.
+// Derive CS setup/hold from the slave's synchronizer depth and system clock
+// CS needs sync_stages cycles to reach the slave's logic and SCLK edges one more,
+// so setup covers a full SCLK synchronizer pass and hold adds one cycle of
+// uncertainty on top so the last edge is seen before CS releases.
+void PapilioSPI::setTimingProfile(uint32_t sys_clock_hz, uint8_t sync_stages) {
+    if (sys_clock_hz == 0) return;
+    
+    uint32_t setup_cycles = sync_stages + 1;
+    uint32_t hold_cycles = sync_stages + 2;
+    uint32_t setup_ns = (uint32_t)(((uint64_t)setup_cycles * 1000000000ULL + sys_clock_hz - 1) / sys_clock_hz);
+    uint32_t hold_ns = (uint32_t)(((uint64_t)hold_cycles * 1000000000ULL + sys_clock_hz - 1) / sys_clock_hz);
+    setCsTiming(setup_ns, hold_ns);
+}
+
+// Set minimum CS setup/hold explicitly (0 = no delay beyond driver overhead)
+void PapilioSPI::setCsTiming(uint32_t setup_ns, uint32_t hold_ns) {
+    _csSetupNs = setup_ns;
+    _csHoldNs = hold_ns;
+    _updateCsDelays();
+}
+
+// Select software or peripheral-driven CS
+// Hardware CS needs the CS pin passed to SPIClass::begin() as its SS pin.
+bool PapilioSPI::setCsMode(PapilioCsMode mode) {
+    if (!_initialized || !_hasBus()) return false;
+    if (_transport) return mode == PAPILIO_CS_SOFTWARE;  // Transport owns CS
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    if (mode == _csMode) return true;
+    
+    if (mode == PAPILIO_CS_HARDWARE) {
+        _spi->setHwCs(true);
+    } else {
+        _spi->setHwCs(false);
+        pinMode(_cs, OUTPUT);       // Take the pin back from the peripheral
+        digitalWrite(_cs, HIGH);
+    }
+    _csMode = mode;
+    return true;
+#else
+    return mode == PAPILIO_CS_SOFTWARE;
+#endif
+}
+
+// Enable the spi_slave_fifo status header protocol
+void PapilioSPI::setStatusHeader(bool enable) {
+    _statusHeader = enable;
+    if (!enable) _crcFraming = false;
+    _statusTxWords = 0;
+    _txCredit = 0;
+}
+
+// Status-only frame
+bool PapilioSPI::updateStatus() {
+    if (!_statusHeader || !_beginFrame(PAPILIO_PATH_FIFO)) return false;
+    _readStatus();
+    endFrame();
+    return true;
+}
+
+// Words available from the FPGA TX FIFO
+// The cached count can only be low (the FPGA adds, we remove), so only
+// ask the FPGA again when it has run out.
 int PapilioSPI::rxAvailable() {
-    // Placeholder - would need protocol support on FPGA side
-    // For now, return 0 (not implemented)
-    return 0;
+    if (!_statusHeader) return 0;
+    if (_statusTxWords == 0) updateStatus();
+    return (int)_statusTxWords;
 }
 
-// Check if TX ready (basic heuristic)
+// Check if the FPGA RX FIFO has room
 bool PapilioSPI::txReady() {
-    // Placeholder - would need protocol support on FPGA side
-    // For now, always return true
-    return true;
+    if (!_statusHeader) return true;
+    if (_txCredit == 0) updateStatus();
+    return _txCredit > 0;
 }
 
 // Read one byte from FIFO
 uint8_t PapilioSPI::readFifo() {
-    return transfer8(0x00);
+    if (!_statusHeader) return transfer8(0x00);
+    
+    uint8_t data = 0;
+    readFifo(&data, 1);
+    return data;
 }
 
-// Write one byte to FIFO
+// Write one byte to FIFO (dropped if the FPGA is almost full - check txReady())
 void PapilioSPI::writeFifo(uint8_t data) {
-    transfer8(data);
+    if (!_statusHeader) {
+        transfer8(data);
+        return;
+    }
+    writeFifo(&data, 1);
 }
 
-// Check if FPGA is responding
-bool PapilioSPI::isReady() {
-    if (!_initialized || !_spi) return false;
+// Drain up to maxLen bytes - exactly what the header says is there
+size_t PapilioSPI::readFifo(uint8_t* buf, size_t maxLen) {
+    if (_crcFraming && buf) return _crcRead(buf, maxLen);
+    if (!_statusHeader || !buf || !_beginFrame(PAPILIO_PATH_FIFO)) return 0;
+    
+    _readStatus();
+    size_t wordBytes = _bitWidth / 8;
+    size_t words = maxLen / wordBytes;
+    if (words > _statusTxWords) words = _statusTxWords;
+    putBurst(nullptr, buf, words * wordBytes);
+    endFrame();
+    
+    _statusTxWords -= words;
+    return words * wordBytes;
+}
+
+// Send up to len bytes without overflowing the FPGA RX FIFO
+size_t PapilioSPI::writeFifo(const uint8_t* buf, size_t len) {
+    if (_crcFraming && buf) return _crcWrite(buf, len);
+    if (!_statusHeader || !buf || !_beginFrame(PAPILIO_PATH_FIFO)) return 0;
+    
+    _readStatus();
+    size_t wordBytes = _bitWidth / 8;
+    size_t words = len / wordBytes;
+    if (words > _txCredit) words = _txCredit;
+    putBurst(buf, nullptr, words * wordBytes);
+    endFrame();
+    
+    _txCredit -= words;
+    return words * wordBytes;
+}
+
+// Internal: exchange the header word of a FIFO frame and cache it
+// [width-1] = RX almost full, [width-2:0] = TX FIFO level
+// CRC framing: [width-2] = rd_seq, [width-3] = wr_seq, [width-4:0] = level,
+// and command goes out in the same word.
+void PapilioSPI::_readStatus(uint32_t command) {
+    uint32_t status = _putWord(command);
+    uint32_t fullBit = 1UL << (_bitWidth - 1);
     
-    // Perform a simple loopback test with known pattern
-    uint8_t testPattern = 0xA5;
-    uint8_t response = transfer8(testPattern);
+    if (_crcFraming) {
+        _statusRdSeq = (status >> (_bitWidth - 2)) & 1;
+        _statusWrSeq = (status >> (_bitWidth - 3)) & 1;
+        _statusTxWords = status & ((fullBit >> 2) - 1);
+    } else {
+        _statusTxWords = status & (fullBit - 1);
+    }
+    _txCredit = (status & fullBit) ? 0 : PAPILIO_SPI_FIFO_HEADROOM;
+}
+
+// Internal: one word at the current bit width
+uint32_t PapilioSPI::_putWord(uint32_t data) {
+    if (_bitWidth == 32) return put32(data);
+    if (_bitWidth == 16) return put16((uint16_t)data);
+    return put8((uint8_t)data);
+}
+
+// Internal: CRC field of a CRC frame (two words at 8 bits, else one word
+// with the CRC in the low 16 bits); returns what came back
+uint16_t PapilioSPI::_putCrc(uint16_t crc) {
+    if (_bitWidth == 8) {
+        uint16_t hi = put8((uint8_t)(crc >> 8));
+        return (uint16_t)((hi << 8) | put8((uint8_t)crc));
+    }
+    return (uint16_t)_putWord(crc);
+}
+
+// Enable CRC framing and pick up the FPGA's sequence bits
+bool PapilioSPI::setCrcFraming(bool enable) {
+    _crcFraming = false;
+    setStatusHeader(enable);
+    if (!enable) return true;
     
-    // In loopback mode, should echo back
-    // In other modes, may return different data
-    // This is a basic check - enhance based on your protocol
-    return true;  // Optimistic - can be enhanced
+    _crcFraming = true;
+    _rdSkip = 0;
+    _lastReadWords = 0;
+    if (!updateStatus()) return false;
+    _wrSeq = _statusWrSeq;
+    _rdSeq = _statusRdSeq;
+    return true;
 }
 
-// Internal: Begin SPI transaction
+// Internal: CRC-checked read - [cmd][data][CRC from FPGA][our ACK]
+// The FPGA only releases the words on ACK, so a bad frame is simply read
+// again. If our ACK got lost the FPGA sends those words once more; rd_seq
+// in the next header shows that and the copies are dropped here.
+size_t PapilioSPI::_crcRead(uint8_t* buf, size_t maxLen) {
+    size_t wordBytes = _bitWidth / 8;
+    size_t want = maxLen / wordBytes;
+    size_t maxCount = (1UL << (_bitWidth - 2)) - 1;
+    if (want > maxCount) want = maxCount;
+    if (want == 0) return 0;
+    uint32_t ack = 0xA5A5A5A5UL >> (32 - _bitWidth);
+    
+    for (int attempt = 0; attempt <= PAPILIO_SPI_CRC_RETRIES; attempt++) {
+        if (!_beginFrame(PAPILIO_PATH_FIFO)) return 0;
+        _readStatus(want);
+        if (_statusRdSeq != _rdSeq) {
+            _rdSkip = _lastReadWords;
+            _rdSeq = _statusRdSeq;
+        }
+        
+        size_t words = want < _statusTxWords ? want : _statusTxWords;
+        if (words == 0) {
+            endFrame();
+            return 0;
+        }
+        
+        size_t len = words * wordBytes;
+        putBurst(nullptr, buf, len);
+        bool ok = _putCrc(0) == _crc16(0xFFFF, buf, len);
+        _putWord(ok ? ack : 0);
+        endFrame();
+        _linkStats.frames++;
+        
+        if (ok) {
+            _rdSeq ^= 1;
+            _lastReadWords = words;
+            _statusTxWords -= words;
+            size_t skip = _rdSkip < words ? _rdSkip : words;
+            _rdSkip -= skip;
+            if (skip > 0) {
+                memmove(buf, buf + skip * wordBytes, (words - skip) * wordBytes);
+            }
+            return (words - skip) * wordBytes;
+        }
+        
+        _linkStats.crcErrors++;
+        if (attempt < PAPILIO_SPI_CRC_RETRIES) _linkStats.retries++;
+    }
+    
+    _linkStats.failures++;
+    return 0;
+}
+
+// Internal: CRC-checked write - [cmd][data][CRC][2 pad][FPGA verdict]
+// A retransmit reuses the sequence bit, so the FPGA drops it if the first
+// copy was committed and only the verdict was lost.
+size_t PapilioSPI::_crcWrite(const uint8_t* buf, size_t len) {
+    size_t wordBytes = _bitWidth / 8;
+    size_t words = len / wordBytes;
+    size_t maxCount = (1UL << (_bitWidth - 2)) - 1;
+    if (_txCredit == 0) updateStatus();
+    if (words > _txCredit) words = _txCredit;
+    if (words > maxCount) words = maxCount;
+    if (words == 0) return 0;
+    
+    len = words * wordBytes;
+    uint16_t crc = _crc16(0xFFFF, buf, len);
+    uint32_t ack = 0xA5A5A5A5UL >> (32 - _bitWidth);
+    
+    for (int attempt = 0; attempt <= PAPILIO_SPI_CRC_RETRIES; attempt++) {
+        if (!_beginFrame(PAPILIO_PATH_FIFO)) return 0;
+        uint32_t command = (1UL << (_bitWidth - 1)) | ((uint32_t)_wrSeq << (_bitWidth - 2)) | words;
+        _readStatus(command);
+        putBurst(buf, nullptr, len);
+        _putCrc(crc);
+        _putWord(0);
+        _putWord(0);
+        uint32_t verdict = _putWord(0);
+        endFrame();
+        _linkStats.frames++;
+        
+        if (verdict == ack) {
+            _wrSeq ^= 1;
+            _txCredit = _txCredit > words ? _txCredit - words : 0;
+            return len;
+        }
+        if (_txCredit == 0) {
+            return 0;  // FPGA was almost full - flow control, not a link error
+        }
+        
+        _linkStats.crcErrors++;
+        if (attempt < PAPILIO_SPI_CRC_RETRIES) _linkStats.retries++;
+    }
+    
+    _linkStats.failures++;
+    return 0;
+}
+
+// Internal: table-driven CRC-16/CCITT, MSB first
+uint16_t PapilioSPI::_crc16(uint16_t crc, const uint8_t* data, size_t len) {
+    while (len--) {
+        crc = (uint16_t)((crc << 8) ^ CRC16_TABLE[(uint8_t)((crc >> 8) ^ *data++)]);
+    }
+    return crc;
+}
+
+// Sweep SCLK upward until the echo pattern breaks, then back off
+uint32_t PapilioSPI::calibrate(uint32_t minHz, uint32_t maxHz) {
+    PapilioCalibration cal = PapilioCalibration();
+    if (!_initialized || !_hasBus() || minHz == 0 || maxHz < minHz) return 0;
+    
+    uint32_t previous = _speed;
+    uint32_t hz = minHz;
+    while (true) {
+        cal.steps++;
+        uint32_t errors = _echoErrors(hz, PAPILIO_SPI_CAL_WORDS);
+        if (errors > 0) {
+            cal.firstFailing = hz;
+            cal.errors = errors;
+            break;
+        }
+        cal.maxClean = hz;
+        if (hz >= maxHz) break;
+        uint32_t next = hz + hz / 4;
+        hz = (next > maxHz || next < hz) ? maxHz : next;
+    }
+    
+    if (cal.maxClean > 0) {
+        // Back off by the margin, never below the slowest clean rate,
+        // and make sure the chosen rate really is clean
+        uint32_t chosen = (uint32_t)((uint64_t)cal.maxClean * PAPILIO_SPI_CAL_MARGIN / 100);
+        if (chosen < minHz) chosen = minHz;
+        if (chosen != cal.maxClean && _echoErrors(chosen, PAPILIO_SPI_CAL_WORDS) > 0) chosen = minHz;
+        cal.speed = chosen;
+    }
+    
+    _calibration = cal;
+    setSpeed(cal.speed > 0 ? cal.speed : previous);
+    return cal.speed;
+}
+
+// Internal: count echo mismatches in `words` words at one rate - one word
+// per frame, each frame returns the word sent in the frame before
+uint32_t PapilioSPI::_echoErrors(uint32_t hz, uint32_t words) {
+    setSpeed(hz);
+    uint32_t mask = 0xFFFFFFFFUL >> (32 - _bitWidth);
+    uint32_t lfsr = 0xACE1u;
+    uint32_t sent = 0x55555555UL & mask;
+    uint32_t errors = 0;
+    
+    if (!beginFrame()) return words;
+    _putWord(sent);  // Prime - returns whatever the slave held
+    endFrame();
+    
+    for (uint32_t i = 0; i < words; i++) {
+        // Fixed toggling patterns first, then a 32-bit Galois LFSR
+        uint32_t word;
+        switch (i) {
+            case 0: word = 0x00000000UL; break;
+            case 1: word = 0xFFFFFFFFUL; break;
+            case 2: word = 0xAAAAAAAAUL; break;
+            case 3: word = 0x55555555UL; break;
+            default:
+                lfsr = (lfsr >> 1) ^ ((0u - (lfsr & 1u)) & 0xA3000000UL);
+                word = lfsr;
+                break;
+        }
+        word &= mask;
+        
+        if (!beginFrame()) return words;
+        uint32_t echo = _putWord(word) & mask;
+        endFrame();
+        if (echo != sent) errors++;
+        sent = word;
+    }
+    return errors;
+}
+
+// Check if FPGA is responding: a short echo run at the current speed.
+// The fixed 0x00/0xFF/0xAA/0x55 words come first, so a floating or
+// stuck MISO line fails.
+bool PapilioSPI::isReady() {
+    if (!_initialized || !_hasBus()) return false;
+    return _echoErrors(_speed, PAPILIO_SPI_READY_WORDS) == 0;
+}
+
+#if PAPILIO_SPI_STATS
+// Clear the instrumentation counters
+void PapilioSPI::resetStats() {
+    _stats = PapilioStats();
+#if defined(ARDUINO_ARCH_ESP32)
+    _stats.cyclesPerUs = ESP.getCpuFreqMHz();
+#else
+    _stats.cyclesPerUs = 1;  // micros() timebase
+#endif
+}
+#endif
+
+// Internal: beginFrame() tagged with the API path for the stats histogram
+bool PapilioSPI::_beginFrame(uint8_t path) {
+    if (!_initialized || !_hasBus()) return false;
+    
+#if PAPILIO_SPI_STATS
+    // Stamps of the frame in progress belong to the bus holder: only
+    // store them once the bus is ours (the wait for it still counts)
+    uint32_t start = _statsNow();
+    _beginTransaction();
+    _statsPath = path;
+    _statsStart = start;
+#else
+    (void)path;
+    _beginTransaction();
+#endif
+    _csLow();
+#if PAPILIO_SPI_STATS
+    _statsWire = _statsNow();
+#endif
+    return true;
+}
+
+// Internal: Begin SPI transaction (settings are prebuilt when speed/mode change)
 void PapilioSPI::_beginTransaction() {
-    if (_spi) {
-        _spi->beginTransaction(SPISettings(_speed, MSBFIRST, _mode));
+    if (_transport) {
+        _transport->beginTransaction(_speed, _mode);
+    } else if (_spi) {
+        _spi->beginTransaction(_settings);
     }
 }
 
 // Internal: End SPI transaction
 void PapilioSPI::_endTransaction() {
-    if (_spi) {
+    if (_transport) {
+        _transport->endTransaction();
+    } else if (_spi) {
         _spi->endTransaction();
     }
 }
 
+// Internal: Move a buffer with CS already asserted
+// ESP32 uses the HAL bulk calls, which load the peripheral's 64-byte data
+// buffer per hardware transaction instead of one driver call per byte.
+// Other cores use the in-place SPIClass::transfer(buf, count).
+// A null txBuf clocks out 0x00 (0xFF is a command byte for spi_bram_controller,
+// and is what the ESP32 HAL sends for a null buffer).
+void PapilioSPI::_transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    static const uint8_t zeros[BURST_CHUNK_SIZE] = {0};
+    
+    _statsBytes(len, rxBuf ? len : 0);
+    if (_transport) {
+        _transport->transferBytes(txBuf, rxBuf, len);
+        return;
+    }
+#if defined(ARDUINO_ARCH_ESP32)
+    if (txBuf && rxBuf) {
+        _spi->transferBytes(txBuf, rxBuf, len);  // Safe in place (tx == rx)
+    } else if (txBuf) {
+        _spi->writeBytes(txBuf, len);
+    } else {
+        while (len > 0) {
+            size_t n = len < BURST_CHUNK_SIZE ? len : BURST_CHUNK_SIZE;
+            _spi->transferBytes(zeros, rxBuf, n);
+            if (rxBuf) rxBuf += n;
+            len -= n;
+        }
+    }
+#else
+    if (rxBuf) {
+        // Stage TX data (or dummy zeros) in the RX buffer, then swap in place
+        if (!txBuf) {
+            memset(rxBuf, 0x00, len);
+        } else if (txBuf != rxBuf) {
+            memcpy(rxBuf, txBuf, len);
+        }
+        _spi->transfer(rxBuf, len);
+    } else {
+        // Nothing to keep - transfer through a small stack buffer
+        uint8_t chunk[BURST_CHUNK_SIZE];
+        while (len > 0) {
+            size_t n = len < BURST_CHUNK_SIZE ? len : BURST_CHUNK_SIZE;
+            memcpy(chunk, txBuf ? txBuf : zeros, n);
+            _spi->transfer(chunk, n);
+            if (txBuf) txBuf += n;
+            len -= n;
+        }
+    }
+#endif
+}
+
+// Internal: Retire a finished transfer
+// The slot is released before the callback so it can submit the next buffer.
+void PapilioSPI::_complete(const QueueEntry& entry) {
+    _pending--;
+    if (entry.callback) {
+        entry.callback(entry.txn);
+    }
+}
+
+// Internal: One streaming drain frame - status header, then a burst straight
+// into the ring sized to what the FPGA holds and what fits before the read
+// position or the end of the ring. With RLE the burst goes to a small
+// staging buffer and is expanded into the ring; leftover input and runs
+// are expanded first, and no frame is read until they fit.
+// Returns bytes captured.
+size_t PapilioSPI::_streamDrain() {
+    size_t wordBytes = _bitWidth / 8;
+    size_t len = 0;           // Bytes into the ring
+    
+    if (_streamRle) {
+        len = _streamExpand();
+        if (_rle.pending() > 0 || _rleStagePos < _rleStageLen) return len;  // Ring full
+    }
+    
+    size_t head = _streamHead;
+    size_t tail = _streamTail;
+    size_t used = (head >= tail) ? head - tail : _streamSize - tail + head;
+    size_t space = _streamSize - used - wordBytes;            // Total free
+    size_t span = (head >= tail) ? _streamSize - head : tail - head - wordBytes;
+    if (span > space) span = space;                            // Contiguous free
+    
+    size_t wire = 0;
+    uint32_t level;           // TX level reported by this frame's header
+    uint32_t levelMax;
+    if (_streamRle) {
+        // Never more encoded words than free samples, so literals always fit
+        size_t limit = space < sizeof(_rleStage) ? space : sizeof(_rleStage);
+        if (!_streamRead(_rleStage, limit - limit % wordBytes, wire, level, levelMax)) return len;
+        _rleStageLen = wire;
+        _rleStagePos = 0;
+        len += _streamExpand();
+    } else {
+        if (!_streamRead(_streamBuf + head, span, wire, level, levelMax)) return 0;
+        len = wire;
+        _streamStats.bytes += len;
+        if (len > 0) {
+            __sync_synchronize();  // Data lands before the consumer sees the new head
+            _streamHead = (head + len) % _streamSize;
+        }
+    }
+    
+    // Counters
+    bool stalled = level * wordBytes > space;
+    if (stalled && !_streamStalled) _streamStats.overruns++;
+    _streamStalled = stalled;
+    if (level >= levelMax) _streamStats.saturated++;
+    _streamStats.frames++;
+    _streamStats.wireBytes += wire;
+    used = streamAvailable();
+    if (used > _streamStats.maxFill) _streamStats.maxFill = used;
+    return len;
+}
+
+// Internal: One drain frame of at most maxLen bytes (whole words) into dst
+// Returns false if the frame could not be sent.
+bool PapilioSPI::_streamRead(uint8_t* dst, size_t maxLen, size_t& len, uint32_t& level,
+                             uint32_t& levelMax) {
+    size_t wordBytes = _bitWidth / 8;
+    len = 0;
+    
+    if (_crcFraming) {
+        // CRC-checked read straight into dst
+        if (maxLen >= wordBytes) {
+            len = _crcRead(dst, maxLen);
+        } else if (!updateStatus()) {
+            return false;
+        }
+        level = _statusTxWords + len / wordBytes;
+        levelMax = (1UL << (_bitWidth - 3)) - 1;
+    } else {
+        if (!_beginFrame(PAPILIO_PATH_FIFO)) return false;
+        _readStatus();
+        size_t words = maxLen / wordBytes;
+        if (words > _statusTxWords) words = _statusTxWords;
+        len = words * wordBytes;
+        if (len > 0) {
+            putBurst(nullptr, dst, len);
+        }
+        endFrame();
+        level = _statusTxWords;
+        levelMax = (1UL << (_bitWidth - 1)) - 1;
+        _statusTxWords -= words;
+    }
+    return true;
+}
+
+// Internal: Expand staged RLE input and pending runs into the ring, up to
+// both contiguous free spans. Returns bytes added.
+size_t PapilioSPI::_streamExpand() {
+    size_t wordBytes = _bitWidth / 8;
+    size_t total = 0;
+    
+    for (int pass = 0; pass < 2; pass++) {
+        size_t head = _streamHead;
+        size_t tail = _streamTail;
+        size_t used = (head >= tail) ? head - tail : _streamSize - tail + head;
+        size_t space = _streamSize - used - wordBytes;
+        size_t span = (head >= tail) ? _streamSize - head : tail - head - wordBytes;
+        if (span > space) span = space;
+        if (span < wordBytes) break;
+        
+        size_t consumed;
+        size_t n = _rle.decode(_rleStage + _rleStagePos, _rleStageLen - _rleStagePos, &consumed,
+                               _streamBuf + head, span);
+        _rleStagePos += consumed;
+        if (n > 0) {
+            __sync_synchronize();  // Data lands before the consumer sees the new head
+            _streamHead = (head + n) % _streamSize;
+            total += n;
+        }
+        if (n < span) break;  // Input used up before the span filled
+    }
+    _streamStats.bytes += total;
+    return total;
+}
+
+// Internal: Hand buffered data to the stream callback once past the watermark
+// Returns the number of spans delivered (two when the data wraps).
+int PapilioSPI::_streamDeliver() {
+    if (!_streamCallback || streamAvailable() < _streamWatermark) return 0;
+    
+    int spans = 0;
+    const uint8_t* data;
+    size_t len;
+    while (spans < 2 && (len = streamPeek(&data)) > 0) {
+        _streamCallback(data, len, _streamUser);
+        streamRelease(len);
+        spans++;
+    }
+    return spans;
+}
+
+// Internal: Drain while the data-ready line is high - it drops during every
+// frame and rises again if enough data is left, so a missed level here
+// always comes back as a new edge
+size_t PapilioSPI::_dataReadyDrain() {
+    uint8_t buf[PAPILIO_SPI_IRQ_BUFFER];
+    size_t total = 0;
+    
+    while (digitalRead(_irqPin) == HIGH) {
+        // The header reports exactly what the FPGA holds
+        size_t len = readFifo(buf, sizeof(buf));
+        if (len == 0) break;
+        
+        _irqHandler(buf, len, _irqUser);
+        total += len;
+    }
+    return total;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Internal: Data-ready edge - wake the drain task or waitDataReady()
+void IRAM_ATTR PapilioSPI::_irqIsr(void* arg) {
+    PapilioSPI* self = static_cast<PapilioSPI*>(arg);
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->_irqSignal, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Internal: Deferred ISR task - drains after each data-ready edge
+void PapilioSPI::_irqTaskMain(void* arg) {
+    PapilioSPI* self = static_cast<PapilioSPI*>(arg);
+    
+    while (self->_irqRun) {
+        if (xSemaphoreTake(self->_irqSignal, portMAX_DELAY) == pdTRUE && self->_irqRun) {
+            self->_dataReadyDrain();
+        }
+    }
+    
+    self->_irqTask = nullptr;
+    vTaskDelete(nullptr);
+}
+#else
+// Internal: Data-ready edge - poll() drains
+void PapilioSPI::_irqIsr() {
+    if (_irqOwner) _irqOwner->_irqFlag = true;
+}
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Internal: Create the worker task and its queues on first submit()
+bool PapilioSPI::_startWorker() {
+    _submitQueue = xQueueCreate(PAPILIO_SPI_QUEUE_DEPTH, sizeof(QueueEntry));
+    _doneQueue = xQueueCreate(PAPILIO_SPI_QUEUE_DEPTH, sizeof(QueueEntry));
+    
+    if (!_submitQueue || !_doneQueue ||
+        xTaskCreate(_workerTask, "papilio_spi", PAPILIO_SPI_TASK_STACK, this,
+                    PAPILIO_SPI_TASK_PRIORITY, &_worker) != pdPASS) {
+        _worker = nullptr;
+        _stopWorker();
+        return false;
+    }
+    return true;
+}
+
+// Internal: Delete the worker task (only called with nothing pending,
+// so the task is blocked on its queue and does not hold the bus)
+void PapilioSPI::_stopWorker() {
+    if (_worker) {
+        vTaskDelete(_worker);
+        _worker = nullptr;
+    }
+    if (_submitQueue) {
+        vQueueDelete(_submitQueue);
+        _submitQueue = nullptr;
+    }
+    if (_doneQueue) {
+        vQueueDelete(_doneQueue);
+        _doneQueue = nullptr;
+    }
+}
+
+// Internal: Worker task - runs submitted transfers back to back
+void PapilioSPI::_workerTask(void* arg) {
+    PapilioSPI* self = static_cast<PapilioSPI*>(arg);
+    QueueEntry entry;
+    
+    for (;;) {
+        if (xQueueReceive(self->_submitQueue, &entry, portMAX_DELAY) == pdTRUE) {
+            self->transferBurst(entry.txn->txBuf, entry.txn->rxBuf, entry.txn->len);
+            xQueueSend(self->_doneQueue, &entry, portMAX_DELAY);
+        }
+    }
+}
+
+// Internal: Stream task - drains back to back while the FPGA has data and
+// sleeps a tick when it had none (the FPGA FIFO covers that gap)
+void PapilioSPI::_streamTaskMain(void* arg) {
+    PapilioSPI* self = static_cast<PapilioSPI*>(arg);
+    
+    while (self->_streamRun) {
+        if (self->_streamDrain() == 0) {
+            vTaskDelay(1);
+        }
+    }
+    
+    self->_streamTask = nullptr;
+    vTaskDelete(nullptr);
+}
+#endif
+
+// Internal: Convert CS setup/hold to busy-wait units
+void PapilioSPI::_updateCsDelays() {
+#if defined(ARDUINO_ARCH_ESP32)
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    _csSetupDelay = (uint32_t)(((uint64_t)_csSetupNs * mhz + 999) / 1000);
+    _csHoldDelay = (uint32_t)(((uint64_t)_csHoldNs * mhz + 999) / 1000);
+#else
+    _csSetupDelay = (_csSetupNs + 999) / 1000;
+    _csHoldDelay = (_csHoldNs + 999) / 1000;
+#endif
+}
+
+// Internal: Busy-wait for a CS delay (cycle counter on ESP32)
+void PapilioSPI::_csDelay(uint32_t delay) {
+    if (delay == 0) return;
+#if defined(ARDUINO_ARCH_ESP32)
+    uint32_t start = ESP.getCycleCount();
+    while ((uint32_t)(ESP.getCycleCount() - start) < delay) {
+    }
+#else
+    delayMicroseconds(delay);
+#endif
+}
+
 // Internal: Assert CS (active low)
 void PapilioSPI::_csLow() {
-    digitalWrite(_cs, LOW);
-    delayMicroseconds(1);  // Small delay for setup time
+    if (_csMode == PAPILIO_CS_HARDWARE) return;  // Peripheral frames CS itself
+    
+    if (_transport) {
+        _transport->select(true);
+    } else {
+#if defined(ARDUINO_ARCH_ESP32)
+        REG_WRITE(_csClrReg, _csMask);
+#else
+        digitalWrite(_cs, LOW);
+#endif
+    }
+    _csDelay(_csSetupDelay);  // CS setup before first SCLK edge
 }
 
 // Internal: Deassert CS (idle high)
 void PapilioSPI::_csHigh() {
-    delayMicroseconds(1);  // Small delay before releasing
-    digitalWrite(_cs, HIGH);
+    if (_csMode == PAPILIO_CS_HARDWARE) return;
+    
+    _csDelay(_csHoldDelay);   // CS hold after last SCLK edge
+    if (_transport) {
+        _transport->select(false);
+    } else {
+#if defined(ARDUINO_ARCH_ESP32)
+        REG_WRITE(_csSetReg, _csMask);
+#else
+        digitalWrite(_cs, HIGH);
+#endif
+    }
+}
+
+// Internal: swap byte order of 16-bit words, two at a time
+void PapilioSPI::_swap16(uint16_t* dst, const uint16_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        uint32_t v;
+        memcpy(&v, src + i, 4);
+        v = ((v & 0x00FF00FFUL) << 8) | ((v >> 8) & 0x00FF00FFUL);
+        memcpy(dst + i, &v, 4);
+    }
+    if (i < count) {
+        dst[i] = (uint16_t)((src[i] << 8) | (src[i] >> 8));
+    }
+}
+
+// Internal: swap byte order of 32-bit words
+void PapilioSPI::_swap32(uint32_t* dst, const uint32_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = __builtin_bswap32(src[i]);
+    }
 }
@@ -12,6 +12,182 @@
 
 #include <Arduino.h>
 #include <SPI.h>
+#include "PapilioTransport.h"
+#include "PapilioRle.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+#include <soc/soc_caps.h>
+#endif
+
+// Reference gateware timing: spi_slave.v on a 27 MHz system clock,
+// with a 2-stage synchronizer on CS (SCLK edges take one stage more)
+#define PAPILIO_SPI_SYS_CLOCK_HZ 27000000
+#define PAPILIO_SPI_SYNC_STAGES 2
+
+// Async queue configuration (override with build flags)
+#ifndef PAPILIO_SPI_QUEUE_DEPTH
+#define PAPILIO_SPI_QUEUE_DEPTH 4         // Max transactions submitted at once
+#endif
+#ifndef PAPILIO_SPI_TASK_STACK
+#define PAPILIO_SPI_TASK_STACK 4096       // ESP32 worker task stack (bytes)
+#endif
+#ifndef PAPILIO_SPI_TASK_PRIORITY
+#define PAPILIO_SPI_TASK_PRIORITY 5       // ESP32 worker task priority
+#endif
+
+// Streaming capture task (ESP32, override with build flags)
+#ifndef PAPILIO_SPI_STREAM_STACK
+#define PAPILIO_SPI_STREAM_STACK 3072     // Stream task stack (bytes)
+#endif
+#ifndef PAPILIO_SPI_STREAM_PRIORITY
+#define PAPILIO_SPI_STREAM_PRIORITY PAPILIO_SPI_TASK_PRIORITY
+#endif
+#ifndef PAPILIO_SPI_STREAM_CORE
+#define PAPILIO_SPI_STREAM_CORE tskNO_AFFINITY  // Pin to 0 to keep it off loop()'s core
+#endif
+#ifndef PAPILIO_SPI_RLE_CHUNK
+#define PAPILIO_SPI_RLE_CHUNK 64          // Encoded bytes per drain frame with setStreamRle()
+#endif
+
+// Words the FPGA RX FIFO is guaranteed to accept while not almost full
+// (spi_slave_fifo ALMOST_FULL_THRESHOLD)
+#ifndef PAPILIO_SPI_FIFO_HEADROOM
+#define PAPILIO_SPI_FIFO_HEADROOM 16
+#endif
+
+// Data-ready interrupt (attachDataReady)
+#ifndef PAPILIO_SPI_IRQ_BUFFER
+#define PAPILIO_SPI_IRQ_BUFFER 256        // Bytes per drain burst (on the drain stack)
+#endif
+#ifndef PAPILIO_SPI_IRQ_STACK
+#define PAPILIO_SPI_IRQ_STACK 3072        // Deferred drain task stack (bytes)
+#endif
+#ifndef PAPILIO_SPI_IRQ_PRIORITY
+#define PAPILIO_SPI_IRQ_PRIORITY (PAPILIO_SPI_TASK_PRIORITY + 1)
+#endif
+
+// Retransmissions of a CRC frame before readFifo()/writeFifo() give up
+#ifndef PAPILIO_SPI_CRC_RETRIES
+#define PAPILIO_SPI_CRC_RETRIES 3
+#endif
+
+// Hot-path instrumentation (stats()): 1 records per-frame counters and
+// latency histograms, 0 compiles every hook out
+#ifndef PAPILIO_SPI_STATS
+#define PAPILIO_SPI_STATS 0
+#endif
+
+// Speed calibration (calibrate() / begin() with PAPILIO_SPI_AUTO_SPEED)
+#define PAPILIO_SPI_AUTO_SPEED 0
+#ifndef PAPILIO_SPI_CAL_MIN_HZ
+#define PAPILIO_SPI_CAL_MIN_HZ 1000000    // Slowest rate tried
+#endif
+#ifndef PAPILIO_SPI_CAL_MAX_HZ
+#define PAPILIO_SPI_CAL_MAX_HZ 40000000   // Fastest rate tried
+#endif
+#ifndef PAPILIO_SPI_CAL_WORDS
+#define PAPILIO_SPI_CAL_WORDS 256         // Echo words per rate
+#endif
+#ifndef PAPILIO_SPI_CAL_MARGIN
+#define PAPILIO_SPI_CAL_MARGIN 80         // Percent of the fastest clean rate to use
+#endif
+#ifndef PAPILIO_SPI_READY_WORDS
+#define PAPILIO_SPI_READY_WORDS 8         // Echo words checked by isReady()
+#endif
+
+// Who drives the chip select line
+enum PapilioCsMode {
+    PAPILIO_CS_SOFTWARE = 0,  // Library drives CS (direct GPIO register writes on ESP32)
+    PAPILIO_CS_HARDWARE = 1   // SPI peripheral drives CS (ESP32 only)
+};
+
+// Queued burst transfer for PapilioSPI::submit()
+// Buffers must stay valid until the completion callback has run.
+struct PapilioTransaction {
+    const uint8_t* txBuf;     // Transmit buffer (nullptr sends 0x00)
+    uint8_t* rxBuf;           // Receive buffer (nullptr discards)
+    size_t len;               // Bytes to transfer
+    void* user;               // Application context, not touched by the library
+};
+
+// One piece of a scatter-gather frame for PapilioSPI::transferv()
+// 16/32-bit segments use uint16_t/uint32_t buffers, each word MSB first on the wire.
+struct PapilioSegment {
+    const void* txBuf;        // Transmit buffer (nullptr sends zeros)
+    void* rxBuf;              // Receive buffer (nullptr discards)
+    size_t count;             // Words of this segment's width
+    uint8_t width;            // 8 (or 0), 16 or 32 bits per word
+};
+
+// Completion callback, run from poll()/wait() in the caller's context
+typedef void (*PapilioCallback)(PapilioTransaction* txn);
+
+// CRC framing counters (spi_slave_crc)
+struct PapilioLinkStats {
+    uint32_t frames;          // CRC-checked data frames on the bus
+    uint32_t crcErrors;       // Frames rejected by either side's CRC check
+    uint32_t retries;         // Frames sent again after an error
+    uint32_t failures;        // Transfers abandoned after PAPILIO_SPI_CRC_RETRIES
+};
+
+// Result of PapilioSPI::calibrate()
+struct PapilioCalibration {
+    uint32_t speed;           // Rate selected (0 = even the slowest rate failed)
+    uint32_t maxClean;        // Fastest rate with zero errors
+    uint32_t firstFailing;    // Rate that stopped the sweep (0 = none failed)
+    uint32_t errors;          // Mismatched words at firstFailing
+    uint8_t steps;            // Rates tried
+};
+
+// Data-ready drain callback: data is only valid during the call
+typedef void (*PapilioDataReadyHandler)(const uint8_t* data, size_t len, void* user);
+
+// Streaming data callback, run from poll() in the caller's context.
+// data points into the ring buffer and is released when the callback returns.
+typedef void (*PapilioStreamCallback)(const uint8_t* data, size_t len, void* user);
+
+// Streaming capture counters
+struct PapilioStreamStats {
+    uint32_t bytes;           // Bytes captured into the ring
+    uint32_t wireBytes;       // Bytes read from the FPGA (fewer than bytes with RLE)
+    uint32_t frames;          // Drain frames on the bus
+    uint32_t overruns;        // Times the ring filled up while the FPGA had data
+    uint32_t saturated;       // Headers with the TX level at its maximum (FPGA FIFO near full)
+    size_t maxFill;           // Ring high-water mark (bytes)
+};
+
+// API paths with their own latency histogram in PapilioStats
+enum PapilioStatsPath {
+    PAPILIO_PATH_FRAME = 0,   // beginFrame()/Transaction and other frames
+    PAPILIO_PATH_TRANSFER8,
+    PAPILIO_PATH_TRANSFER16,
+    PAPILIO_PATH_TRANSFER32,
+    PAPILIO_PATH_BURST,       // transferBurst*(), transferv(), queued transfers
+    PAPILIO_PATH_FIFO,        // FIFO, CRC and stream drain frames
+    PAPILIO_PATH_COUNT
+};
+
+#if PAPILIO_SPI_STATS
+// Instrumentation counters (PAPILIO_SPI_STATS = 1). Times are CPU cycles
+// from ESP.getCycleCount() on ESP32 and microseconds elsewhere;
+// cyclesPerUs converts either to time.
+struct PapilioStats {
+    uint32_t transactions;    // CS frames
+    uint64_t bytesTx;         // Bytes clocked out
+    uint64_t bytesRx;         // Bytes returned to the caller
+    uint64_t csCycles;        // CS asserted (wire time plus CS setup/hold)
+    uint64_t wireCycles;      // Data on the wire, from CS setup to hold
+    uint64_t overheadCycles;  // Rest of each call: bus lock, SPI setup, CS delays
+    uint32_t cyclesPerUs;
+    uint32_t histogram[PAPILIO_PATH_COUNT][32];  // Frames by log2(call cycles)
+};
+#endif
 
 class PapilioSPI {
 public:
@@ -19,46 +195,346 @@ public:
     PapilioSPI();
     
     // Initialization and configuration
+    // speed = PAPILIO_SPI_AUTO_SPEED runs calibrate() with the default range
+    // and fails if no rate passes.
     bool begin(SPIClass* spi = &SPI, int cs_pin = SS, uint32_t speed = 1000000, uint8_t mode = SPI_MODE0);
+    // Run over a PapilioTransport (IDF DMA, software loopback, host models)
+    // instead of SPIClass; the transport drives CS, so CS is software only.
+    bool begin(PapilioTransport* transport, uint32_t speed = 1000000, uint8_t mode = SPI_MODE0);
     void end();
     
+    // Find the fastest reliable SCLK rate (needs echo gateware such as
+    // examples/loopback_test, where each word returns the previous one).
+    // Sweeps upward from minHz in ~25% steps at the current bit width, stops
+    // at the first rate with an echo error and selects PAPILIO_SPI_CAL_MARGIN
+    // percent of the fastest clean rate, re-verified. Returns the selected
+    // rate, or 0 (speed unchanged) if even minHz fails.
+    uint32_t calibrate(uint32_t minHz = PAPILIO_SPI_CAL_MIN_HZ, uint32_t maxHz = PAPILIO_SPI_CAL_MAX_HZ);
+    PapilioCalibration calibration() const { return _calibration; }
+    uint32_t speed() const { return _speed; }
+    
     // Basic transfer methods
     uint8_t transfer8(uint8_t data);
     uint16_t transfer16(uint16_t data);
     uint32_t transfer32(uint32_t data);
     
-    // Burst transfer (multiple bytes)
+    // Burst transfer (multiple bytes, single CS assertion)
+    // txBuf == nullptr sends 0x00, rxBuf == nullptr discards, txBuf == rxBuf is allowed
     void transferBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len);
     
+    // Word bursts for TRANSFER_WIDTH 16/32 gateware - count is in words.
+    // Each word goes out MSB first; byte order is converted a chunk at a time.
+    void transferBurst16(const uint16_t* txBuf, uint16_t* rxBuf, size_t count);
+    void transferBurst32(const uint32_t* txBuf, uint32_t* rxBuf, size_t count);
+    
+    // Scatter-gather: every segment back to back in one CS frame, straight
+    // from and into the segment buffers. false (nothing sent) on a bad width.
+    bool transferv(const PapilioSegment* segs, size_t n);
+    
+    // Manual framing (what Transaction does); frames do not nest
+    bool beginFrame();        // Take the bus and assert CS, false if not initialized
+    void endFrame();          // Release CS and the bus
+    
+    // In-frame transfers - only valid between beginFrame() and endFrame()
+    // Return the word received while sending (MSB first).
+    uint8_t put8(uint8_t data);
+    uint16_t put16(uint16_t data);
+    uint32_t put32(uint32_t data);
+    void putBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len);
+    void putBurst16(const uint16_t* txBuf, uint16_t* rxBuf, size_t count);
+    void putBurst32(const uint32_t* txBuf, uint32_t* rxBuf, size_t count);
+    bool putv(const PapilioSegment* segs, size_t n);
+    
+    // Asynchronous burst transfers (same semantics as transferBurst)
+    // On ESP32 a worker task drives the bus while the caller keeps running,
+    // so the next buffer can be filled while the previous one is on the wire.
+    // Elsewhere poll() performs queued transfers one at a time.
+    bool submit(PapilioTransaction* txn, PapilioCallback callback = nullptr);
+    int poll();                                   // Run finished callbacks, returns count
+    bool wait(uint32_t timeout_ms = UINT32_MAX);  // Wait for all submitted transfers
+    size_t pending() const;                       // Submitted, callback not yet run
+    
+    // Continuous capture (needs setStatusHeader(true))
+    // Drains the FPGA TX FIFO straight into a caller-owned ring buffer, one
+    // burst per status header, sized to what the FPGA holds and what fits.
+    // On ESP32 a task keeps draining while loop() is busy; elsewhere poll()
+    // runs one drain pass. Once watermark bytes (default size/2) are buffered,
+    // poll() hands them to the callback as spans of the ring - no copies.
+    // Without a callback use streamPeek()/streamRelease().
+    // Other transfers on this object must wait until stopStream().
+    bool startStream(uint8_t* ring, size_t size, PapilioStreamCallback callback,
+                     size_t watermark = 0, void* user = nullptr);
+    void stopStream();
+    bool streaming() const { return _streamBuf != nullptr; }
+    // Captures from rle_encoder gateware: expand them into the ring as they
+    // are drained (set before startStream())
+    bool setStreamRle(bool enable);
+    bool streamRle() const { return _streamRle; }
+    size_t streamAvailable() const;                 // Bytes buffered, not yet released
+    size_t streamPeek(const uint8_t** data) const;  // Contiguous bytes at the read position
+    void streamRelease(size_t len);                 // Hand bytes back to the ring
+    PapilioStreamStats streamStats() const { return _streamStats; }
+    
     // Configuration
     void setBitWidth(uint8_t width);  // 8, 16, or 32
     void setSpeed(uint32_t hz);
     void setMode(uint8_t mode);       // SPI_MODE0, SPI_MODE1, etc.
     
+    // CS timing - minimum CS setup (before first SCLK edge) and hold (after last edge)
+    // Defaults are derived from the reference gateware (27 MHz, 2 sync stages).
+    void setTimingProfile(uint32_t sys_clock_hz, uint8_t sync_stages = PAPILIO_SPI_SYNC_STAGES);
+    void setCsTiming(uint32_t setup_ns, uint32_t hold_ns);
+    // Hardware CS frames each peripheral transaction (up to 64 bytes on ESP32),
+    // so keep software CS for longer bursts. Returns false if unsupported.
+    bool setCsMode(PapilioCsMode mode);
+    
     // FIFO operations (if using spi_slave_fifo on FPGA side)
     // Note: These are convenience methods for common patterns
     // For simple modules without FIFO, use basic transfer methods
-    int rxAvailable();        // Returns estimated bytes available (based on protocol)
-    bool txReady();           // Returns true if ready to send
+    //
+    // With setStatusHeader(true) (gateware built with STATUS_HEADER=1) every
+    // FIFO frame starts with a status word; the library caches it and sizes
+    // bursts to what the FPGA actually holds. Without it rxAvailable() is 0
+    // and txReady() is always true.
+    void setStatusHeader(bool enable);
+    bool updateStatus();      // Status-only frame, refreshes the cache
+    int rxAvailable();        // Words waiting in the FPGA TX FIFO
+    bool txReady();           // FPGA RX FIFO can take more words
     uint8_t readFifo();       // Read one byte from RX FIFO
     void writeFifo(uint8_t data);  // Write one byte to TX FIFO
+    // Bulk FIFO access in one frame (status header only), returns bytes moved
+    size_t readFifo(uint8_t* buf, size_t maxLen);
+    size_t writeFifo(const uint8_t* buf, size_t len);
+    
+    // CRC framing for spi_slave_crc gateware (enables the status header).
+    // Bulk readFifo()/writeFifo() then send one CRC-16 checked frame per
+    // call and retransmit failed frames; a lost acknowledgement never
+    // duplicates or drops data. linkStats() gives the error rate.
+    bool setCrcFraming(bool enable);    // false if the FPGA did not answer
+    PapilioLinkStats linkStats() const { return _linkStats; }
+    void resetLinkStats() { _linkStats = PapilioLinkStats(); }
+    
+#if PAPILIO_SPI_STATS
+    // Frame counters and per-path latency histograms since begin() or
+    // resetStats(). Updated while the bus is held; read between frames.
+    const PapilioStats& stats() const { return _stats; }
+    void resetStats();
+#endif
+    
+    // Data-ready line (spi_slave_fifo irq output, IRQ_THRESHOLD > 0).
+    // Needs setStatusHeader(true) and STATUS_HEADER = 1 in the gateware.
+    // With a handler, every rising edge drains the TX FIFO while the line
+    // stays high, each burst sized by the status header (threshold is the
+    // gateware's IRQ_THRESHOLD, for reference only). On ESP32 the drain
+    // and handler run in a task woken from the ISR; elsewhere poll() does it.
+    // Without a handler, waitDataReady() blocks until the line rises.
+    // While draining, other FIFO reads on this object are not allowed.
+    bool attachDataReady(int pin, size_t threshold, PapilioDataReadyHandler handler = nullptr,
+                         void* user = nullptr);
+    void detachDataReady();
+    bool waitDataReady(uint32_t timeout_ms = UINT32_MAX);  // true if data is ready
     
     // Utility
-    bool isReady();           // Check if FPGA is responding
+    // Short echo check at the current speed (same echo gateware as
+    // calibrate()): true if PAPILIO_SPI_READY_WORDS words all came back
+    bool isReady();
+    
+    // Scoped frame: takes the bus and asserts CS once, releases both when it
+    // goes out of scope. Words inside the frame skip all per-call setup.
+    //
+    //   {
+    //       PapilioSPI::Transaction t(spi);
+    //       t.put8(cmd); t.put16(addr); value = t.get8();
+    //   }
+    class Transaction {
+    public:
+        explicit Transaction(PapilioSPI& spi);
+        ~Transaction();
+        
+        bool active() const { return _active; }  // false if spi not initialized
+        
+        uint8_t put8(uint8_t data);
+        uint16_t put16(uint16_t data);
+        uint32_t put32(uint32_t data);
+        uint8_t get8() { return put8(0x00); }
+        uint16_t get16() { return put16(0x0000); }
+        uint32_t get32() { return put32(0x00000000); }
+        void putBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len);
+        void putBurst16(const uint16_t* txBuf, uint16_t* rxBuf, size_t count);
+        void putBurst32(const uint32_t* txBuf, uint32_t* rxBuf, size_t count);
+        bool putv(const PapilioSegment* segs, size_t n);
+        
+    private:
+        PapilioSPI& _owner;
+        bool _active;
+        
+        Transaction(const Transaction&);             // Not copyable
+        Transaction& operator=(const Transaction&);
+    };
     
 private:
+    static const size_t BURST_CHUNK_SIZE = 64;  // ESP32 SPI data buffer size
+    
     SPIClass* _spi;
+    PapilioTransport* _transport;  // Replaces _spi when set
     int _cs;
     uint32_t _speed;
     uint8_t _mode;
     uint8_t _bitWidth;
     bool _initialized;
+    SPISettings _settings;    // Rebuilt only when speed or mode changes
+    
+    // Cached FIFO status (status header protocol)
+    bool _statusHeader;
+    uint32_t _statusTxWords;  // Words the FPGA can send us
+    uint32_t _txCredit;       // Words we can send without overflowing its RX FIFO
+    
+    // CRC framing state (alternating-bit sequence numbers)
+    bool _crcFraming;
+    uint8_t _wrSeq;           // seq bit for the next write frame
+    uint8_t _rdSeq;           // rd_seq the FPGA reports if our last ACK arrived
+    uint8_t _statusWrSeq;     // Sequence bits from the last status word
+    uint8_t _statusRdSeq;
+    size_t _rdSkip;           // Words the FPGA will resend that we already have
+    size_t _lastReadWords;
+    PapilioLinkStats _linkStats;
+    
+    PapilioCalibration _calibration;
+    
+#if PAPILIO_SPI_STATS
+    // Instrumentation: cycle stamps of the frame in progress
+    PapilioStats _stats;
+    uint8_t _statsPath;
+    uint32_t _statsStart;     // beginFrame() entry
+    uint32_t _statsWire;      // CS setup done
+#endif
+    
+    // CS control
+    PapilioCsMode _csMode;
+    uint32_t _csSetupNs;
+    uint32_t _csHoldNs;
+    uint32_t _csSetupDelay;   // CPU cycles on ESP32, microseconds elsewhere
+    uint32_t _csHoldDelay;
+#if defined(ARDUINO_ARCH_ESP32)
+    uint32_t _csMask;         // Direct GPIO register writes
+    uint32_t _csSetReg;
+    uint32_t _csClrReg;
+#endif
+    
+    // Async queue state
+    struct QueueEntry {
+        PapilioTransaction* txn;
+        PapilioCallback callback;
+    };
+    size_t _pending;
+#if defined(ARDUINO_ARCH_ESP32)
+    QueueHandle_t _submitQueue;
+    QueueHandle_t _doneQueue;
+    TaskHandle_t _worker;
+#else
+    QueueEntry _queue[PAPILIO_SPI_QUEUE_DEPTH];
+    size_t _queueHead;
+#endif
+    
+    // Data-ready state
+    int _irqPin;              // -1 = not attached
+    PapilioDataReadyHandler _irqHandler;
+    void* _irqUser;
+    volatile bool _irqFlag;   // Edge seen, not yet handled
+#if defined(ARDUINO_ARCH_ESP32)
+    SemaphoreHandle_t _irqSignal;
+    TaskHandle_t _irqTask;
+    volatile bool _irqRun;
+#else
+    static PapilioSPI* _irqOwner;  // attachInterrupt() has no argument here
+#endif
+    
+    // Streaming state - _streamHead is written only by the drain side,
+    // _streamTail only by the consumer; one word stays free so head == tail
+    // always means empty
+    uint8_t* _streamBuf;
+    size_t _streamSize;
+    size_t _streamWatermark;
+    volatile size_t _streamHead;
+    volatile size_t _streamTail;
+    PapilioStreamCallback _streamCallback;
+    void* _streamUser;
+    bool _streamStalled;
+    PapilioStreamStats _streamStats;
+    bool _streamRle;
+    PapilioRleDecoder _rle;
+    uint8_t _rleStage[PAPILIO_SPI_RLE_CHUNK];  // Encoded words not yet expanded
+    size_t _rleStageLen;
+    size_t _rleStagePos;
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t _streamTask;
+    volatile bool _streamRun;
+#endif
     
     // Internal helpers
+    bool _hasBus() const { return _spi || _transport; }
+    bool _beginFrame(uint8_t path);
     void _beginTransaction();
     void _endTransaction();
     void _csLow();
     void _csHigh();
+    void _updateCsDelays();
+    void _readStatus(uint32_t command = 0);
+    uint32_t _putWord(uint32_t data);
+    uint32_t _echoErrors(uint32_t hz, uint32_t words);
+    uint16_t _putCrc(uint16_t crc);
+    size_t _crcRead(uint8_t* buf, size_t maxLen);
+    size_t _crcWrite(const uint8_t* buf, size_t len);
+    static uint16_t _crc16(uint16_t crc, const uint8_t* data, size_t len);
+    static void _csDelay(uint32_t delay);
+    void _transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len);
+    static void _swap16(uint16_t* dst, const uint16_t* src, size_t count);
+    static void _swap32(uint32_t* dst, const uint32_t* src, size_t count);
+    void _complete(const QueueEntry& entry);
+    size_t _streamDrain();
+    bool _streamRead(uint8_t* dst, size_t maxLen, size_t& len, uint32_t& level, uint32_t& levelMax);
+    size_t _streamExpand();
+    int _streamDeliver();
+    size_t _dataReadyDrain();
+#if defined(ARDUINO_ARCH_ESP32)
+    bool _startWorker();
+    void _stopWorker();
+    static void _workerTask(void* arg);
+    static void _streamTaskMain(void* arg);
+    static void _irqTaskMain(void* arg);
+    static void _irqIsr(void* arg);
+#else
+    static void _irqIsr();
+#endif
+    
+    // Stats hooks, inlined so an enabled build stays within a few dozen
+    // cycles per frame and a disabled one has none at all
+#if PAPILIO_SPI_STATS
+    static inline uint32_t _statsNow() {
+#if defined(ARDUINO_ARCH_ESP32)
+        return ESP.getCycleCount();
+#else
+        return micros();
+#endif
+    }
+    
+    inline void _statsBytes(size_t tx, size_t rx) {
+        _stats.bytesTx += tx;
+        _stats.bytesRx += rx;
+    }
+    
+    inline void _statsRecord(uint32_t wireEnd) {
+        uint32_t total = _statsNow() - _statsStart;
+        uint32_t wire = wireEnd - _statsWire;
+        _stats.transactions++;
+        _stats.wireCycles += wire;
+        _stats.csCycles += wire + _csSetupDelay + _csHoldDelay;
+        _stats.overheadCycles += total - wire;
+        _stats.histogram[_statsPath][31 - __builtin_clz(total | 1)]++;
+    }
+#else
+    inline void _statsBytes(size_t, size_t) {}
+#endif
 };
 
 #endif // PAPILIOSPI_H
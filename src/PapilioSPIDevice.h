@@ -0,0 +1,234 @@
+// PapilioSPIDevice.h - Compile-time configured SPI slave device
+//
+// Header-only counterpart of PapilioSPI for fixed hardware: CS pin, clock,
+// SPI mode and word width are template parameters, so the clock divider,
+// CS register and word size are constants and the transfer paths are
+// inlined. On ESP32 frames go straight to the HAL (no SPISettings, no
+// divider search, no runtime width dispatch) and CS is a single GPIO
+// register write.
+//
+//   PapilioSPIDevice<3, 4000000, SPI_MODE0, 16> fpga;
+//   fpga.begin(&fpgaSPI);
+//   uint16_t v = fpga.transfer(0x1234);
+//
+// No state checks on the hot path: call begin() first. Use PapilioSPI when
+// the settings change at run time or for FIFO/stream/async features.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOSPIDEVICE_H
+#define PAPILIOSPIDEVICE_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "PapilioSPI.h"
+
+// SPI peripheral source clock (ESP32 family: APB)
+#ifndef PAPILIO_SPI_APB_HZ
+#if defined(APB_CLK_FREQ)
+#define PAPILIO_SPI_APB_HZ APB_CLK_FREQ
+#else
+#define PAPILIO_SPI_APB_HZ 80000000
+#endif
+#endif
+
+// Word type for a transfer width
+template <uint8_t Width> struct PapilioWord;
+template <> struct PapilioWord<8> { typedef uint8_t type; };
+template <> struct PapilioWord<16> { typedef uint16_t type; };
+template <> struct PapilioWord<32> { typedef uint32_t type; };
+
+namespace papilio_spi_detail {
+
+// ESP32 SPI_CLOCK_REG: [31] equ_sysclk, [30:18] clkdiv_pre, [17:12] clkcnt_n,
+// [11:6] clkcnt_h, [5:0] clkcnt_l - SCLK = APB / ((pre + 1) * (n + 1)).
+// Same encoding as the Arduino core's spiFrequencyToClockDiv(), but the
+// search runs in the compiler and never picks a rate above the request.
+constexpr uint32_t clockPre(uint64_t hz, uint32_t n) {
+    return ((PAPILIO_SPI_APB_HZ + (n + 1) * hz - 1) / ((n + 1) * hz)) > 0x2000 ? 0x1FFF
+         : (uint32_t)((PAPILIO_SPI_APB_HZ + (n + 1) * hz - 1) / ((n + 1) * hz)) - 1;
+}
+
+constexpr uint32_t clockReg(uint32_t pre, uint32_t n) {
+    return (pre << 18) | (n << 12) | ((n + 1) / 2);
+}
+
+constexpr uint32_t clockRegHz(uint32_t reg) {
+    return (reg & 0x80000000UL) ? PAPILIO_SPI_APB_HZ
+         : PAPILIO_SPI_APB_HZ / ((((reg >> 18) & 0x1FFF) + 1) * (((reg >> 12) & 0x3F) + 1));
+}
+
+constexpr uint32_t fasterReg(uint32_t a, uint32_t b) {
+    return clockRegHz(b) > clockRegHz(a) ? b : a;  // Ties keep the smaller n
+}
+
+constexpr uint32_t searchReg(uint32_t hz, uint32_t n) {
+    return n == 0x3F ? clockReg(clockPre(hz, n), n)
+         : fasterReg(clockReg(clockPre(hz, n), n), searchReg(hz, n + 1));
+}
+
+constexpr uint32_t clockDiv(uint32_t hz) {
+    return hz >= PAPILIO_SPI_APB_HZ ? 0x80000000UL : searchReg(hz, 1);
+}
+
+// CS setup/hold of the reference gateware (see PapilioSPI::setTimingProfile)
+constexpr uint32_t cyclesToNs(uint32_t cycles) {
+    return (uint32_t)(((uint64_t)cycles * 1000000000ULL + PAPILIO_SPI_SYS_CLOCK_HZ - 1) / PAPILIO_SPI_SYS_CLOCK_HZ);
+}
+
+} // namespace papilio_spi_detail
+
+template <int CsPin, uint32_t SpeedHz = 1000000, uint8_t Mode = SPI_MODE0, uint8_t Width = 8>
+class PapilioSPIDevice {
+public:
+    static_assert(Width == 8 || Width == 16 || Width == 32, "Width must be 8, 16, or 32");
+    static_assert(SpeedHz > 0, "SpeedHz must be non-zero");
+    static_assert(CsPin >= 0, "CsPin must be a GPIO number");
+    
+    typedef typename PapilioWord<Width>::type Word;
+    
+    static constexpr uint32_t CLOCK_DIV = papilio_spi_detail::clockDiv(SpeedHz);
+    static constexpr uint32_t ACTUAL_HZ = papilio_spi_detail::clockRegHz(CLOCK_DIV);  // ESP32 rate
+    static constexpr uint32_t CS_SETUP_NS = papilio_spi_detail::cyclesToNs(PAPILIO_SPI_SYNC_STAGES + 1);
+    static constexpr uint32_t CS_HOLD_NS = papilio_spi_detail::cyclesToNs(PAPILIO_SPI_SYNC_STAGES + 2);
+    
+    PapilioSPIDevice() : _spi(nullptr), _csSetupDelay(0), _csHoldDelay(0) {}
+    
+    // Take an SPIClass whose pins are already set up; CS idles high
+    void begin(SPIClass* spi = &SPI) {
+        _spi = spi;
+        pinMode(CsPin, OUTPUT);
+        digitalWrite(CsPin, HIGH);
+#if defined(ARDUINO_ARCH_ESP32)
+        uint32_t mhz = ESP.getCpuFreqMHz();
+        _csSetupDelay = (CS_SETUP_NS * mhz + 999) / 1000;
+        _csHoldDelay = (CS_HOLD_NS * mhz + 999) / 1000;
+#else
+        _csSetupDelay = (CS_SETUP_NS + 999) / 1000;
+        _csHoldDelay = (CS_HOLD_NS + 999) / 1000;
+#endif
+    }
+    
+    // One word in its own CS frame
+    inline Word transfer(Word data) {
+        beginFrame();
+        Word result = put(data);
+        endFrame();
+        return result;
+    }
+    
+    // Bytes in one CS frame (txBuf == nullptr sends 0x00, rxBuf == nullptr
+    // discards); words wider than 8 bits are stored MSB first
+    inline void transferBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+        beginFrame();
+        putBurst(txBuf, rxBuf, len);
+        endFrame();
+    }
+    
+    // Manual framing
+    inline void beginFrame() {
+#if defined(ARDUINO_ARCH_ESP32)
+        spiTransaction(_spi->bus(), CLOCK_DIV, Mode, MSBFIRST);
+#else
+        _spi->beginTransaction(SPISettings(SpeedHz, MSBFIRST, Mode));
+#endif
+        _csLow();
+    }
+    
+    inline void endFrame() {
+        _csHigh();
+#if defined(ARDUINO_ARCH_ESP32)
+        spiEndTransaction(_spi->bus());
+#else
+        _spi->endTransaction();
+#endif
+    }
+    
+    // In-frame word at the compile-time width (MSB first)
+    inline Word put(Word data) {
+        return _put(data, PapilioWord<Width>());
+    }
+    
+    inline void putBurst(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+#if defined(ARDUINO_ARCH_ESP32)
+        if (txBuf) {
+            if (rxBuf) {
+                spiTransferBytesNL(_spi->bus(), txBuf, rxBuf, len);
+            } else {
+                spiWriteNL(_spi->bus(), txBuf, len);
+            }
+            return;
+        }
+        // Read only: clock out zeros a chunk at a time
+        uint8_t chunk[64];
+        while (len > 0) {
+            size_t n = len < sizeof(chunk) ? len : sizeof(chunk);
+            memset(chunk, 0, n);
+            spiTransferBytesNL(_spi->bus(), chunk, rxBuf ? rxBuf : chunk, n);
+            if (rxBuf) rxBuf += n;
+            len -= n;
+        }
+#else
+        for (size_t i = 0; i < len; i++) {
+            uint8_t v = _spi->transfer(txBuf ? txBuf[i] : 0x00);
+            if (rxBuf) rxBuf[i] = v;
+        }
+#endif
+    }
+    
+private:
+    SPIClass* _spi;
+    uint32_t _csSetupDelay;   // CPU cycles on ESP32, microseconds elsewhere
+    uint32_t _csHoldDelay;
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    static constexpr uint32_t CS_MASK = 1UL << (CsPin & 31);
+#if SOC_GPIO_PIN_COUNT > 32
+    static constexpr uint32_t CS_SET_REG = (CsPin >= 32) ? GPIO_OUT1_W1TS_REG : GPIO_OUT_W1TS_REG;
+    static constexpr uint32_t CS_CLR_REG = (CsPin >= 32) ? GPIO_OUT1_W1TC_REG : GPIO_OUT_W1TC_REG;
+#else
+    static constexpr uint32_t CS_SET_REG = GPIO_OUT_W1TS_REG;
+    static constexpr uint32_t CS_CLR_REG = GPIO_OUT_W1TC_REG;
+#endif
+    
+    inline uint8_t _put(uint8_t data, PapilioWord<8>) { return spiTransferByteNL(_spi->bus(), data); }
+    inline uint16_t _put(uint16_t data, PapilioWord<16>) { return spiTransferShortNL(_spi->bus(), data); }
+    inline uint32_t _put(uint32_t data, PapilioWord<32>) { return spiTransferLongNL(_spi->bus(), data); }
+    
+    inline void _csDelay(uint32_t delay) {
+        uint32_t start = ESP.getCycleCount();
+        while ((uint32_t)(ESP.getCycleCount() - start) < delay) {
+        }
+    }
+    
+    inline void _csLow() {
+        REG_WRITE(CS_CLR_REG, CS_MASK);
+        _csDelay(_csSetupDelay);
+    }
+    
+    inline void _csHigh() {
+        _csDelay(_csHoldDelay);
+        REG_WRITE(CS_SET_REG, CS_MASK);
+    }
+#else
+    inline uint8_t _put(uint8_t data, PapilioWord<8>) { return _spi->transfer(data); }
+    inline uint16_t _put(uint16_t data, PapilioWord<16>) { return _spi->transfer16(data); }
+    inline uint32_t _put(uint32_t data, PapilioWord<32>) {
+        uint32_t result = ((uint32_t)_spi->transfer16(data >> 16) << 16);
+        return result | _spi->transfer16(data & 0xFFFF);
+    }
+    
+    inline void _csLow() {
+        digitalWrite(CsPin, LOW);
+        if (_csSetupDelay) delayMicroseconds(_csSetupDelay);
+    }
+    
+    inline void _csHigh() {
+        if (_csHoldDelay) delayMicroseconds(_csHoldDelay);
+        digitalWrite(CsPin, HIGH);
+    }
+#endif
+};
+
+#endif // PAPILIOSPIDEVICE_H
@@ -0,0 +1,136 @@
+// PapilioSpsc.h - Lock-free queue and fixed buffer pool for PapilioEngine
+//
+// PapilioSpscQueue: ring of values with exactly one producer task and one
+// consumer task, possibly on different cores. No locks or critical
+// sections: each index has a single writer, published with release stores
+// and read with acquire loads. The two indices sit on separate cache lines.
+//
+// PapilioBufferPool: Count buffers of Size bytes (rounded up to a cache
+// line), each starting on a cache line boundary, so DMA and cache
+// maintenance never split a line with neighbouring data. alloc() and
+// release() are O(1) and not thread-safe - call them from one task.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOSPSC_H
+#define PAPILIOSPSC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PAPILIO_CACHE_LINE
+#define PAPILIO_CACHE_LINE 64             // Bytes (ESP32: 32, ESP32-S3: up to 64)
+#endif
+
+template <typename T, size_t Depth>
+class PapilioSpscQueue {
+public:
+    static_assert(Depth > 0 && (Depth & (Depth - 1)) == 0, "Depth must be a power of two");
+    
+    PapilioSpscQueue() :
+        _head(0),
+        _tail(0)
+    {
+    }
+    
+    // Producer: false if full
+    bool push(const T& item) {
+        uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+        if (tail - __atomic_load_n(&_head, __ATOMIC_ACQUIRE) >= Depth) return false;
+        _slots[tail & (Depth - 1)] = item;
+        __atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+    
+    // Consumer: false if empty
+    bool pop(T& item) {
+        uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&_tail, __ATOMIC_ACQUIRE) == head) return false;
+        item = _slots[head & (Depth - 1)];
+        __atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+    
+    // Either side; exact only from a task that is not pushing or popping
+    size_t size() const {
+        uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+        return tail - __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+    }
+    bool empty() const { return size() == 0; }
+    static size_t capacity() { return Depth; }
+    
+private:
+    alignas(PAPILIO_CACHE_LINE) uint32_t _head;   // Written by the consumer only
+    alignas(PAPILIO_CACHE_LINE) uint32_t _tail;   // Written by the producer only
+    alignas(PAPILIO_CACHE_LINE) T _slots[Depth];
+    
+    PapilioSpscQueue(const PapilioSpscQueue&);             // Not copyable
+    PapilioSpscQueue& operator=(const PapilioSpscQueue&);
+};
+
+template <size_t Size, size_t Count>
+class PapilioBufferPool {
+public:
+    static_assert(Size > 0 && Count > 0 && Count <= 65535, "Pool needs 1..65535 buffers");
+    
+    static const size_t BUFFER_SIZE = (Size + PAPILIO_CACHE_LINE - 1) / PAPILIO_CACHE_LINE * PAPILIO_CACHE_LINE;
+    
+    PapilioBufferPool() {
+        reset();
+    }
+    
+    // Free buffer, or nullptr if all are in use
+    uint8_t* alloc() {
+        if (_free == 0) return nullptr;
+        uint16_t index = _stack[--_free];
+        _used[index] = true;
+        return _buffers[index];
+    }
+    
+    // Return a buffer from alloc(); false for foreign pointers and double releases
+    bool release(uint8_t* buf) {
+        size_t index = 0;
+        if (!_index(buf, index) || !_used[index]) return false;
+        _used[index] = false;
+        _stack[_free++] = (uint16_t)index;
+        return true;
+    }
+    
+    // Every buffer free again (outstanding pointers become invalid)
+    void reset() {
+        for (size_t i = 0; i < Count; i++) {
+            _stack[i] = (uint16_t)(Count - 1 - i);
+            _used[i] = false;
+        }
+        _free = Count;
+    }
+    
+    bool owns(const uint8_t* buf) const {
+        size_t index = 0;
+        return _index(buf, index);
+    }
+    size_t available() const { return _free; }
+    static size_t bufferSize() { return BUFFER_SIZE; }
+    static size_t count() { return Count; }
+    
+private:
+    alignas(PAPILIO_CACHE_LINE) uint8_t _buffers[Count][BUFFER_SIZE];
+    uint16_t _stack[Count];   // Free buffer indices, top at _free - 1
+    bool _used[Count];
+    size_t _free;
+    
+    bool _index(const uint8_t* buf, size_t& index) const {
+        const uint8_t* base = &_buffers[0][0];
+        if (!buf || buf < base || buf >= base + sizeof(_buffers)) return false;
+        size_t offset = (size_t)(buf - base);
+        if (offset % BUFFER_SIZE != 0) return false;
+        index = offset / BUFFER_SIZE;
+        return true;
+    }
+    
+    PapilioBufferPool(const PapilioBufferPool&);           // Not copyable
+    PapilioBufferPool& operator=(const PapilioBufferPool&);
+};
+
+#endif // PAPILIOSPSC_H
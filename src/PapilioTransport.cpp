@@ -0,0 +1,79 @@
+// PapilioTransport.cpp - Implementation
+//
+// Arduino SPIClass transport for PapilioSPI.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioTransport.h"
+
+// Constructor
+PapilioSPIClassTransport::PapilioSPIClassTransport() :
+    _spi(nullptr),
+    _cs(-1),
+    _speed(1000000),
+    _mode(SPI_MODE0),
+    _settings(1000000, MSBFIRST, SPI_MODE0)
+{
+}
+
+// Attach to a started SPIClass, CS idle high
+bool PapilioSPIClassTransport::begin(SPIClass* spi, int cs_pin) {
+    if (!spi || cs_pin < 0) return false;
+    _spi = spi;
+    _cs = cs_pin;
+    pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
+    return true;
+}
+
+// Lock the bus with the frame's settings
+void PapilioSPIClassTransport::beginTransaction(uint32_t speed, uint8_t mode) {
+    if (speed != _speed || mode != _mode) {
+        _speed = speed;
+        _mode = mode;
+        _settings = SPISettings(_speed, MSBFIRST, _mode);
+    }
+    _spi->beginTransaction(_settings);
+}
+
+void PapilioSPIClassTransport::endTransaction() {
+    _spi->endTransaction();
+}
+
+// Drive CS (active low)
+void PapilioSPIClassTransport::select(bool active) {
+    digitalWrite(_cs, active ? LOW : HIGH);
+}
+
+uint8_t PapilioSPIClassTransport::transfer8(uint8_t data) {
+    return _spi->transfer(data);
+}
+
+uint16_t PapilioSPIClassTransport::transfer16(uint16_t data) {
+    return _spi->transfer16(data);
+}
+
+// Bulk transfer through the in-place SPIClass::transfer(buf, count)
+void PapilioSPIClassTransport::transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) {
+    static const uint8_t zeros[CHUNK_SIZE] = {0};
+    
+    if (rxBuf) {
+        // Stage TX data (or dummy zeros) in the RX buffer, then swap in place
+        if (!txBuf) {
+            memset(rxBuf, 0x00, len);
+        } else if (txBuf != rxBuf) {
+            memcpy(rxBuf, txBuf, len);
+        }
+        _spi->transfer(rxBuf, len);
+    } else {
+        uint8_t chunk[CHUNK_SIZE];
+        while (len > 0) {
+            size_t n = len < CHUNK_SIZE ? len : CHUNK_SIZE;
+            memcpy(chunk, txBuf ? txBuf : zeros, n);
+            _spi->transfer(chunk, n);
+            if (txBuf) txBuf += n;
+            len -= n;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// PapilioTransport.h - Pluggable byte transport for PapilioSPI
+//
+// PapilioSPI keeps framing, status headers, CRC, queues and streaming; a
+// transport only moves bytes and drives CS. PapilioSPI::begin(SPIClass*)
+// keeps its built-in path (ESP32 HAL calls, GPIO register CS), so existing
+// code is unchanged; begin(PapilioTransport*) routes the bus through one
+// of these instead:
+// - PapilioSPIClassTransport: any Arduino SPIClass, digitalWrite() CS
+// - PapilioIdfTransport (PapilioIdfTransport.h): ESP-IDF spi_master + DMA
+// - PapilioLoopbackTransport: software echo, no hardware at all
+// The host bench in tests/host adds a backend driving a Verilator model
+// of the gateware, so protocol layers can be profiled on a desktop.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOTRANSPORT_H
+#define PAPILIOTRANSPORT_H
+
+#include <Arduino.h>
+#include <SPI.h>
+
+class PapilioTransport {
+public:
+    virtual ~PapilioTransport() {}
+    
+    // Take the bus with these settings for one frame, and give it back
+    virtual void beginTransaction(uint32_t speed, uint8_t mode) { (void)speed; (void)mode; }
+    virtual void endTransaction() {}
+    
+    // Assert (true) or release CS; PapilioSPI adds its CS setup/hold delays
+    virtual void select(bool active) = 0;
+    
+    // Words go out MSB first
+    virtual uint8_t transfer8(uint8_t data) = 0;
+    virtual uint16_t transfer16(uint16_t data) {
+        uint16_t result = (uint16_t)(transfer8((uint8_t)(data >> 8)) << 8);
+        return result | transfer8((uint8_t)data);
+    }
+    virtual uint32_t transfer32(uint32_t data) {
+        uint32_t result = (uint32_t)transfer16((uint16_t)(data >> 16)) << 16;
+        return result | transfer16((uint16_t)data);
+    }
+    
+    // txBuf == nullptr sends 0x00, rxBuf == nullptr discards, txBuf == rxBuf is allowed
+    virtual void transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) = 0;
+};
+
+// Arduino SPIClass and a GPIO chip select
+class PapilioSPIClassTransport : public PapilioTransport {
+public:
+    PapilioSPIClassTransport();
+    
+    // spi must already be started (SPI.begin())
+    bool begin(SPIClass* spi, int cs_pin);
+    
+    void beginTransaction(uint32_t speed, uint8_t mode) override;
+    void endTransaction() override;
+    void select(bool active) override;
+    uint8_t transfer8(uint8_t data) override;
+    uint16_t transfer16(uint16_t data) override;
+    void transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) override;
+    
+private:
+    static const size_t CHUNK_SIZE = 64;
+    
+    SPIClass* _spi;
+    int _cs;
+    uint32_t _speed;
+    uint8_t _mode;
+    SPISettings _settings;    // Rebuilt only when speed or mode changes
+};
+
+// Software loopback: every byte returns the byte sent before it, like the
+// examples/loopback_test gateware. Counts traffic for profiling.
+class PapilioLoopbackTransport : public PapilioTransport {
+public:
+    PapilioLoopbackTransport() : _last(0), _frames(0), _bytes(0) {}
+    
+    void select(bool active) override {
+        if (active) _frames++;
+    }
+    
+    uint8_t transfer8(uint8_t data) override {
+        uint8_t result = _last;
+        _last = data;
+        _bytes++;
+        return result;
+    }
+    
+    void transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) override {
+        for (size_t i = 0; i < len; i++) {
+            uint8_t out = txBuf ? txBuf[i] : 0x00;  // Read before rxBuf[i] may overwrite it
+            if (rxBuf) rxBuf[i] = _last;
+            _last = out;
+        }
+        _bytes += len;
+    }
+    
+    uint32_t frames() const { return _frames; }   // CS assertions
+    uint64_t bytes() const { return _bytes; }     // Bytes on the wire
+    void reset() { _frames = 0; _bytes = 0; }
+    
+private:
+    uint8_t _last;
+    uint32_t _frames;
+    uint64_t _bytes;
+};
+
+#endif // PAPILIOTRANSPORT_H
@@ -0,0 +1,189 @@
+// PapilioWishbone.cpp - Implementation
+// 
+// Client for the simple_spi_wb_bridge gateware (framed or pipelined).
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioWishbone.h"
+
+// Constructor
+PapilioWishbone::PapilioWishbone() :
+    _spi(nullptr),
+    _pipelined(false),
+    _late(0),
+    _dropped(0)
+{
+}
+
+// Attach to SPI bus
+bool PapilioWishbone::begin(PapilioSPI* spi) {
+    _spi = spi;
+    return _spi != nullptr;
+}
+
+// Read one register
+uint8_t PapilioWishbone::read(uint16_t addr) {
+    if (!_spi) return 0;
+    if (_pipelined) {
+        uint8_t value = 0xFF;
+        _pipeline(CMD_READ, addr, nullptr, nullptr, &value, 1);
+        return value;
+    }
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return 0;
+    
+    _header(txn, CMD_READ, addr);
+    return txn.get8();  // Bridge drives read data during the 4th byte
+}
+
+// Write one register
+bool PapilioWishbone::write(uint16_t addr, uint8_t value) {
+    if (!_spi) return false;
+    if (_pipelined) return _pipeline(CMD_WRITE, addr, nullptr, &value, nullptr, 1);
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return false;
+    
+    _header(txn, CMD_WRITE, addr);
+    txn.put8(value);
+    return true;
+}
+
+// Read n consecutive registers
+void PapilioWishbone::readBlock(uint16_t addr, uint8_t* buf, size_t n) {
+    if (!_spi || !buf || n == 0) return;
+    if (_pipelined) {
+        _pipeline(CMD_READ, addr, nullptr, nullptr, buf, n);  // No read-ahead
+        return;
+    }
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return;
+    
+    _header(txn, CMD_READ_BURST, addr);
+    txn.putBurst(nullptr, buf, n);
+}
+
+// Write n consecutive registers
+bool PapilioWishbone::writeBlock(uint16_t addr, const uint8_t* buf, size_t n) {
+    if (!_spi || !buf || n == 0) return false;
+    if (_pipelined) return _pipeline(CMD_WRITE, addr, nullptr, buf, nullptr, n);
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return false;
+    
+    _header(txn, CMD_WRITE, addr);
+    txn.putBurst(buf, nullptr, n);
+    return true;
+}
+
+// Read scattered registers
+// Framed bridges get one read() frame per register.
+bool PapilioWishbone::readv(const uint16_t* addrs, uint8_t* values, size_t n) {
+    if (!_spi || !addrs || !values) return false;
+    if (_pipelined) return _pipeline(CMD_READ, 0, addrs, nullptr, values, n);
+    
+    for (size_t i = 0; i < n; i++) {
+        values[i] = read(addrs[i]);
+    }
+    return true;
+}
+
+// Send command and address bytes
+void PapilioWishbone::_header(PapilioSPI::Transaction& txn, uint8_t cmd, uint16_t addr) {
+    txn.put8(cmd);
+    txn.put8((uint8_t)(addr >> 8));
+    txn.put8((uint8_t)(addr & 0xFF));
+}
+
+// Internal: n pipelined accesses, PAPILIO_WB_PIPE_BATCH per frame
+// Access i uses addrs[i], or addr + i without addrs. Only accesses the
+// bridge dropped are re-sent; a late one was issued and may still run, so
+// it fails instead (reads return 0xFF).
+bool PapilioWishbone::_pipeline(uint8_t cmd, uint16_t addr, const uint16_t* addrs,
+                                const uint8_t* txBuf, uint8_t* rxBuf, size_t n) {
+    bool ok = true;
+    
+    for (size_t base = 0; base < n; base += PAPILIO_WB_PIPE_BATCH) {
+        uint16_t index[PAPILIO_WB_PIPE_BATCH];   // Access behind each slot
+        uint16_t slotAddr[PAPILIO_WB_PIPE_BATCH];
+        uint8_t slotData[PAPILIO_WB_PIPE_BATCH];
+        uint8_t slotRx[PAPILIO_WB_PIPE_BATCH];
+        uint8_t status[PAPILIO_WB_PIPE_BATCH];
+        size_t count = n - base < PAPILIO_WB_PIPE_BATCH ? n - base : PAPILIO_WB_PIPE_BATCH;
+        
+        for (size_t i = 0; i < count; i++) {
+            index[i] = (uint16_t)(base + i);
+            slotAddr[i] = addrs ? addrs[base + i] : (uint16_t)(addr + base + i);
+            slotData[i] = txBuf ? txBuf[base + i] : 0x00;
+        }
+        
+        for (int attempt = 0; count > 0; attempt++) {
+            if (!_pipeFrame(cmd, slotAddr, slotData, slotRx, status, count)) return false;
+            
+            // Keep results, compact the dropped accesses for the next frame
+            size_t again = 0;
+            for (size_t i = 0; i < count; i++) {
+                if (status[i] == STATUS_DONE) {
+                    if (rxBuf) rxBuf[index[i]] = slotRx[i];
+                    continue;
+                }
+                if (status[i] != STATUS_DROPPED) {
+                    _late++;
+                    if (rxBuf) rxBuf[index[i]] = 0xFF;
+                    ok = false;
+                    continue;
+                }
+                _dropped++;
+                index[again] = index[i];
+                slotAddr[again] = slotAddr[i];
+                slotData[again] = slotData[i];
+                again++;
+            }
+            count = again;
+            
+            if (count > 0 && attempt == PAPILIO_WB_PIPE_RETRIES) {
+                for (size_t i = 0; i < count; i++) {
+                    if (rxBuf) rxBuf[index[i]] = 0xFF;
+                }
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+// Internal: one CS frame of n slots plus the no-op slot that collects the
+// last response. The response to slot i arrives in slot i + 1; status[i]
+// is its STATUS byte, or STATUS_LATE if the echoes do not match.
+bool PapilioWishbone::_pipeFrame(uint8_t cmd, const uint16_t* addrs, const uint8_t* txData,
+                                 uint8_t* rxData, uint8_t* status, size_t n) {
+    uint8_t frame[(PAPILIO_WB_PIPE_BATCH + 1) * 4];
+    uint8_t* p = frame;
+    
+    for (size_t i = 0; i < n; i++) {
+        *p++ = cmd;
+        *p++ = (uint8_t)(addrs[i] >> 8);
+        *p++ = (uint8_t)(addrs[i] & 0xFF);
+        *p++ = txData[i];
+    }
+    memset(p, CMD_NOP, 4);
+    
+    {
+        PapilioSPI::Transaction txn(*_spi);
+        if (!txn.active()) return false;
+        txn.putBurst(frame, frame, (n + 1) * 4);   // In place
+    }
+    
+    // Response: [CMD][ADDR_LO][READ DATA][STATUS]
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* r = frame + (i + 1) * 4;
+        bool match = r[0] == cmd && r[1] == (uint8_t)(addrs[i] & 0xFF);
+        status[i] = match ? r[3] : STATUS_LATE;   // Unknown: it may have run
+        rxData[i] = r[2];
+    }
+    return true;
+}
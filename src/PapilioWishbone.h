@@ -0,0 +1,75 @@
+// PapilioWishbone.h - Client for the simple_spi_wb_bridge gateware
+// 
+// Issues [CMD][ADDR_HI][ADDR_LO][DATA]... frames over a PapilioSPI bus.
+// Every call is a single CS frame; block calls use the bridge's address
+// auto-increment so N registers cost N + 3 bytes.
+// setPipelined(true) talks to a PIPELINED=1 bridge instead: every access
+// is a 4-byte slot, up to PAPILIO_WB_PIPE_BATCH per frame, and responses
+// (one slot behind) are matched to requests by their echoes. Accesses the
+// bridge dropped are re-sent; late ones were issued and fail instead.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOWISHBONE_H
+#define PAPILIOWISHBONE_H
+
+#include <Arduino.h>
+#include "PapilioSPI.h"
+
+// Pipelined mode: accesses per CS frame, and re-sends of a dropped access
+#ifndef PAPILIO_WB_PIPE_BATCH
+#define PAPILIO_WB_PIPE_BATCH 16
+#endif
+#ifndef PAPILIO_WB_PIPE_RETRIES
+#define PAPILIO_WB_PIPE_RETRIES 2
+#endif
+
+class PapilioWishbone {
+public:
+    PapilioWishbone();
+    
+    // Attach to an initialized PapilioSPI (bridge expects SPI Mode 0)
+    bool begin(PapilioSPI* spi);
+    
+    // Single register access. Writes return false if the frame could not
+    // be sent or (pipelined) the bridge did not confirm the write.
+    uint8_t read(uint16_t addr);
+    bool write(uint16_t addr, uint8_t value);
+    
+    // Consecutive registers addr .. addr + n - 1 in one frame
+    void readBlock(uint16_t addr, uint8_t* buf, size_t n);
+    bool writeBlock(uint16_t addr, const uint8_t* buf, size_t n);
+    
+    // Pipelined protocol (the bridge must be built with PIPELINED=1)
+    void setPipelined(bool enable) { _pipelined = enable; }
+    bool pipelined() const { return _pipelined; }
+    
+    // Scattered registers addrs[0..n-1] (pipelined only); false if any
+    // access was late, or still dropped after PAPILIO_WB_PIPE_RETRIES re-sends
+    bool readv(const uint16_t* addrs, uint8_t* values, size_t n);
+    uint32_t lateCount() const { return _late; }      // Late responses seen (not re-sent)
+    uint32_t dropCount() const { return _dropped; }   // Dropped slots seen (re-sent)
+    
+private:
+    static const uint8_t CMD_READ = 0x00;
+    static const uint8_t CMD_WRITE = 0x01;
+    static const uint8_t CMD_READ_BURST = 0x02;  // Auto-incrementing read
+    static const uint8_t CMD_NOP = 0xFF;         // Pipelined: collects the last response
+    static const uint8_t STATUS_LATE = 0x00;     // Issued, may still run
+    static const uint8_t STATUS_DONE = 0x01;
+    static const uint8_t STATUS_DROPPED = 0x02;  // Never issued, safe to re-send
+    
+    PapilioSPI* _spi;
+    bool _pipelined;
+    uint32_t _late;
+    uint32_t _dropped;
+    
+    void _header(PapilioSPI::Transaction& txn, uint8_t cmd, uint16_t addr);
+    bool _pipeline(uint8_t cmd, uint16_t addr, const uint16_t* addrs,
+                   const uint8_t* txBuf, uint8_t* rxBuf, size_t n);
+    bool _pipeFrame(uint8_t cmd, const uint16_t* addrs, const uint8_t* txData,
+                    uint8_t* rxData, uint8_t* status, size_t n);
+};
+
+#endif // PAPILIOWISHBONE_H
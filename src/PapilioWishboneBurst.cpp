@@ -0,0 +1,120 @@
+// PapilioWishboneBurst.cpp - Implementation
+//
+// Client for the spi_wb_burst_bridge gateware.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include "PapilioWishboneBurst.h"
+
+// Constructor
+PapilioWishboneBurst::PapilioWishboneBurst() : _spi(nullptr), _addrBytes(4), _dataBytes(4), _addrStep(1) {
+}
+
+// Attach to SPI bus
+bool PapilioWishboneBurst::begin(PapilioSPI* spi, uint8_t addrBytes, uint8_t dataBytes, uint32_t addrStep) {
+    if (!spi || addrBytes == 0 || addrBytes > 4) return false;
+    if (dataBytes != 1 && dataBytes != 2 && dataBytes != 4) return false;
+    _spi = spi;
+    _addrBytes = addrBytes;
+    _dataBytes = dataBytes;
+    _addrStep = addrStep;
+    return true;
+}
+
+// Read one word
+uint32_t PapilioWishboneBurst::read(uint32_t addr) {
+    if (!_spi) return 0;
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return 0;
+    
+    _header(txn, CMD_READ, addr, 1);
+    txn.put8(0x00);  // Turnaround: the bridge fetches the word here
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < _dataBytes; i++) {
+        value = (value << 8) | txn.get8();
+    }
+    return value;
+}
+
+// Write one word
+void PapilioWishboneBurst::write(uint32_t addr, uint32_t value) {
+    if (!_spi) return;
+    
+    PapilioSPI::Transaction txn(*_spi);
+    if (!txn.active()) return;
+    
+    _header(txn, CMD_WRITE, addr, 1);
+    for (int i = _dataBytes - 1; i >= 0; i--) {
+        txn.put8((uint8_t)(value >> (8 * i)));
+    }
+}
+
+// Read n consecutive words, one frame per 65535
+bool PapilioWishboneBurst::readBlock(uint32_t addr, void* buf, size_t n) {
+    if (!_spi || !buf) return false;
+    
+    uint8_t* p = static_cast<uint8_t*>(buf);
+    while (n > 0) {
+        size_t len = n < MAX_LEN ? n : MAX_LEN;
+        
+        PapilioSPI::Transaction txn(*_spi);
+        if (!txn.active()) return false;
+        
+        _header(txn, CMD_READ, addr, len);
+        txn.put8(0x00);
+        _words(txn, nullptr, p, len);
+        
+        p += len * _dataBytes;
+        addr += len * _addrStep;
+        n -= len;
+    }
+    return true;
+}
+
+// Write n consecutive words, one frame per 65535
+bool PapilioWishboneBurst::writeBlock(uint32_t addr, const void* buf, size_t n) {
+    if (!_spi || !buf) return false;
+    
+    const uint8_t* p = static_cast<const uint8_t*>(buf);
+    while (n > 0) {
+        size_t len = n < MAX_LEN ? n : MAX_LEN;
+        
+        PapilioSPI::Transaction txn(*_spi);
+        if (!txn.active()) return false;
+        
+        _header(txn, CMD_WRITE, addr, len);
+        _words(txn, p, nullptr, len);
+        
+        p += len * _dataBytes;
+        addr += len * _addrStep;
+        n -= len;
+    }
+    return true;
+}
+
+// Send command, address (MSB first) and word count
+void PapilioWishboneBurst::_header(PapilioSPI::Transaction& txn, uint8_t cmd, uint32_t addr, size_t len) {
+    txn.put8(cmd);
+    for (int i = _addrBytes - 1; i >= 0; i--) {
+        txn.put8((uint8_t)(addr >> (8 * i)));
+    }
+    txn.put8((uint8_t)(len >> 8));
+    txn.put8((uint8_t)(len & 0xFF));
+}
+
+// Data words at the bridge's width (MSB first on the wire)
+void PapilioWishboneBurst::_words(PapilioSPI::Transaction& txn, const void* txBuf, void* rxBuf, size_t n) {
+    switch (_dataBytes) {
+        case 1:
+            txn.putBurst(static_cast<const uint8_t*>(txBuf), static_cast<uint8_t*>(rxBuf), n);
+            break;
+        case 2:
+            txn.putBurst16(static_cast<const uint16_t*>(txBuf), static_cast<uint16_t*>(rxBuf), n);
+            break;
+        default:
+            txn.putBurst32(static_cast<const uint32_t*>(txBuf), static_cast<uint32_t*>(rxBuf), n);
+            break;
+    }
+}
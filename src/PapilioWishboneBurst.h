@@ -0,0 +1,51 @@
+// PapilioWishboneBurst.h - Client for the spi_wb_burst_bridge gateware
+//
+// Issues length-framed bursts over a PapilioSPI bus:
+//   Read:  [0x00][ADDR][LEN_HI][LEN_LO][turnaround][D0]...[Dn-1]
+//   Write: [0x01][ADDR][LEN_HI][LEN_LO][D0]...[Dn-1]
+// ADDR is addrBytes long and every word dataBytes long, MSB first; both
+// must match the bridge's ADDR_WIDTH and DATA_WIDTH. Blocks longer than
+// 65535 words are split into several frames.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOWISHBONEBURST_H
+#define PAPILIOWISHBONEBURST_H
+
+#include <Arduino.h>
+#include "PapilioSPI.h"
+
+class PapilioWishboneBurst {
+public:
+    PapilioWishboneBurst();
+    
+    // Attach to an initialized PapilioSPI (bridge expects SPI Mode 0).
+    // addrStep is the bridge's ADDR_STEP (address increment per word).
+    bool begin(PapilioSPI* spi, uint8_t addrBytes = 4, uint8_t dataBytes = 4, uint32_t addrStep = 1);
+    
+    // Single word access (value right-aligned)
+    uint32_t read(uint32_t addr);
+    void write(uint32_t addr, uint32_t value);
+    
+    // n words at addr, addr + addrStep, ...; buf holds uint8_t, uint16_t or
+    // uint32_t elements to match dataBytes. Reads stop at n words, so
+    // registers with read side effects are safe here.
+    bool readBlock(uint32_t addr, void* buf, size_t n);
+    bool writeBlock(uint32_t addr, const void* buf, size_t n);
+    
+private:
+    static const uint8_t CMD_READ = 0x00;
+    static const uint8_t CMD_WRITE = 0x01;
+    static const size_t MAX_LEN = 0xFFFF;     // Words per frame (16-bit length)
+    
+    PapilioSPI* _spi;
+    uint8_t _addrBytes;
+    uint8_t _dataBytes;
+    uint32_t _addrStep;
+    
+    void _header(PapilioSPI::Transaction& txn, uint8_t cmd, uint32_t addr, size_t len);
+    void _words(PapilioSPI::Transaction& txn, const void* txBuf, void* rxBuf, size_t n);
+};
+
+#endif // PAPILIOWISHBONEBURST_H
@@ -0,0 +1,59 @@
+// Arduino.h - Minimal Arduino core for building the library on a desktop
+//
+// Just enough for the generic (non-ESP32) paths of src/: timing comes from
+// std::chrono, GPIO and interrupts are no-ops. Used by run_host_bench.sh.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define RISING 0x1
+#define FALLING 0x2
+#define CHANGE 0x3
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SS 10
+#define IRAM_ATTR
+
+typedef bool boolean;
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int irq, void (*isr)(void), int mode);
+void detachInterrupt(int irq);
+void noInterrupts();
+void interrupts();
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Serial prints to stdout
+class HostSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    operator bool() const { return true; }
+    size_t print(const char* s) { return (size_t)fputs(s, stdout); }
+    size_t println(const char* s = "") { return (size_t)printf("%s\n", s); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+extern HostSerial Serial;
+
+#endif // ARDUINO_HOST_H
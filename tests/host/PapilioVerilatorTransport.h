@@ -0,0 +1,81 @@
+// PapilioVerilatorTransport.h - PapilioTransport driving a Verilated model
+//
+// Bit-bangs SPI mode 0 into a Verilator model with the top.v port names
+// (clk, spi_sclk, spi_mosi, spi_cs_n -> spi_miso). Each SCLK half period
+// is halfBit system clocks, so the gateware sees the same oversampling
+// ratio it would on hardware (27 MHz / 4 MHz is about 3.4 per half bit).
+//
+//   Vtop model;
+//   PapilioVerilatorTransport<Vtop> wire(model, 4);
+//   spi.begin(&wire);
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef PAPILIOVERILATORTRANSPORT_H
+#define PAPILIOVERILATORTRANSPORT_H
+
+#include "PapilioTransport.h"
+
+template <class Model>
+class PapilioVerilatorTransport : public PapilioTransport {
+public:
+    PapilioVerilatorTransport(Model& model, uint32_t halfBit = 4) :
+        _model(model),
+        _halfBit(halfBit ? halfBit : 1),
+        _cycles(0),
+        _bytes(0)
+    {
+        _model.spi_cs_n = 1;
+        _model.spi_sclk = 0;
+        _model.spi_mosi = 0;
+        _tick(32);    // Let the model's reset counter expire
+    }
+    
+    void select(bool active) override {
+        _model.spi_cs_n = active ? 0 : 1;
+        _tick(_halfBit * 2);    // CS setup / frame gap
+    }
+    
+    uint8_t transfer8(uint8_t data) override {
+        uint8_t result = 0;
+        for (int bit = 7; bit >= 0; bit--) {
+            _model.spi_mosi = (data >> bit) & 1;
+            _tick(_halfBit);
+            _model.spi_sclk = 1;    // Slave samples MOSI on the rising edge
+            _tick(_halfBit);
+            result = (uint8_t)((result << 1) | (_model.spi_miso & 1));
+            _model.spi_sclk = 0;
+        }
+        _bytes++;
+        return result;
+    }
+    
+    void transferBytes(const uint8_t* txBuf, uint8_t* rxBuf, size_t len) override {
+        for (size_t i = 0; i < len; i++) {
+            uint8_t in = transfer8(txBuf ? txBuf[i] : 0x00);
+            if (rxBuf) rxBuf[i] = in;
+        }
+    }
+    
+    uint64_t cycles() const { return _cycles; }   // System clocks simulated
+    uint64_t bytes() const { return _bytes; }     // Bytes on the wire
+    
+private:
+    Model& _model;
+    uint32_t _halfBit;
+    uint64_t _cycles;
+    uint64_t _bytes;
+    
+    void _tick(uint32_t n) {
+        for (uint32_t i = 0; i < n; i++) {
+            _model.clk = 0;
+            _model.eval();
+            _model.clk = 1;
+            _model.eval();
+        }
+        _cycles += n;
+    }
+};
+
+#endif // PAPILIOVERILATORTRANSPORT_H
@@ -0,0 +1,37 @@
+// SPI.h - SPIClass placeholder for host builds
+//
+// Host builds run PapilioSPI over a PapilioTransport; this SPIClass only
+// has to link. Transfers return 0x00.
+//
+// Author: Papilio Labs
+// License: MIT
+
+#ifndef SPI_HOST_H
+#define SPI_HOST_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+
+class SPISettings {
+public:
+    SPISettings() {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) { (void)clock; (void)bitOrder; (void)dataMode; }
+};
+
+class SPIClass {
+public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(SPISettings settings) { (void)settings; }
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data) { (void)data; return 0; }
+    uint16_t transfer16(uint16_t data) { (void)data; return 0; }
+    void transfer(void* buf, size_t count) { memset(buf, 0, count); }
+};
+extern SPIClass SPI;
+
+#endif // SPI_HOST_H
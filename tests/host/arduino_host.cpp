@@ -0,0 +1,55 @@
+// arduino_host.cpp - Arduino core functions for host builds
+//
+// Author: Papilio Labs
+// License: MIT
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+SPIClass SPI;
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+
+void pinMode(int pin, int mode) { (void)pin; (void)mode; }
+void digitalWrite(int pin, int value) { (void)pin; (void)value; }
+int digitalRead(int pin) { (void)pin; return HIGH; }
+int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int irq, void (*isr)(void), int mode) { (void)irq; (void)isr; (void)mode; }
+void detachInterrupt(int irq) { (void)irq; }
+void noInterrupts() {}
+void interrupts() {}
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - s_start).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - s_start).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Busy-wait like the real core (0 returns at once, as the bench needs)
+void delayMicroseconds(unsigned int us) {
+    unsigned long start = micros();
+    while (micros() - start < us) {
+    }
+}
+
+void yield() {}
+
+size_t HostSerial::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n > 0 ? (size_t)n : 0;
+}
@@ -0,0 +1,62 @@
+#!/bin/bash
+# Host Profiling Bench
+# Builds tests/host/bench_host.cpp against src/ with the desktop Arduino
+# shim in tests/host and runs it. Profile the binary it leaves in
+# test_logs/host_build (perf record, valgrind --tool=callgrind).
+#
+# Usage:
+#   ./run_host_bench.sh                    # Software loopback backend
+#   ./run_host_bench.sh 1000000            # Iteration count
+#   BACKEND=verilator ./run_host_bench.sh  # Verilated examples/loopback_test top.v
+#
+# CXXFLAGS adds compiler flags, e.g. CXXFLAGS="-DPAPILIO_SPI_STATS=1 -g".
+
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+LIB_ROOT="$(dirname "$SCRIPT_DIR")"
+HOST_DIR="$SCRIPT_DIR/host"
+SRC_DIR="$LIB_ROOT/src"
+GATEWARE_DIR="$LIB_ROOT/gateware"
+TOP_FILE="$LIB_ROOT/examples/loopback_test/gateware/top.v"
+WORK_DIR="$SCRIPT_DIR/test_logs/host_build"
+BACKEND="${BACKEND:-loopback}"
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:-}"
+
+mkdir -p "$WORK_DIR"
+
+SOURCES=("$HOST_DIR/bench_host.cpp" "$HOST_DIR/arduino_host.cpp" "$SRC_DIR"/*.cpp)
+
+echo "========================================"
+echo "Papilio SPI Slave - Host Profiling Bench"
+echo "========================================"
+echo ""
+
+if [ "$BACKEND" = "verilator" ]; then
+    if ! command -v verilator &> /dev/null; then
+        echo "[ERROR] verilator not found in PATH"
+        exit 1
+    fi
+    BIN="$WORK_DIR/obj_dir/Vtop"
+    verilator --cc --exe --build -O2 -Wno-fatal -Wno-lint -Wno-style \
+        --top-module top --Mdir "$WORK_DIR/obj_dir" \
+        -CFLAGS "-O2 -std=gnu++17 -DPAPILIO_HOST_VERILATOR -I$HOST_DIR -I$SRC_DIR $CXXFLAGS" \
+        "$TOP_FILE" "$GATEWARE_DIR"/*.v "${SOURCES[@]}" > "$WORK_DIR/compile.log" 2>&1 || {
+        cat "$WORK_DIR/compile.log"
+        exit 1
+    }
+else
+    if ! command -v "$CXX" &> /dev/null; then
+        echo "[ERROR] $CXX not found in PATH"
+        exit 1
+    fi
+    BIN="$WORK_DIR/bench_host"
+    $CXX -O2 -g -std=gnu++17 -I"$HOST_DIR" -I"$SRC_DIR" $CXXFLAGS \
+        -o "$BIN" "${SOURCES[@]}" > "$WORK_DIR/compile.log" 2>&1 || {
+        cat "$WORK_DIR/compile.log"
+        exit 1
+    }
+fi
+
+"$BIN" "$@"
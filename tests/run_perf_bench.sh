@@ -0,0 +1,100 @@
+#!/bin/bash
+# Datapath Performance Bench
+# Runs tests/sim/tb_perf_datapath.v over the standard configurations and
+# prints each one's speed ceiling.
+#
+# Usage:
+#   ./run_perf_bench.sh                       # Standard matrix
+#   ./run_perf_bench.sh MODE=2 PREFETCH=4     # One configuration
+#   SIM=verilator ./run_perf_bench.sh         # Verilator 5 (--timing) instead of iverilog
+#
+# Parameters are the tb_perf_datapath parameters (MODE, SCLK_DOMAIN, BURST,
+# FIFO_DEPTH, BACKPRESSURE, TX_PREFILL, PREFETCH, SCAN_SPLIT, SYS_MHZ, RATIO_START,
+# RATIO_STEP, RATIO_MIN, CS_SETUP, CS_GAP).
+
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+LIB_ROOT="$(dirname "$SCRIPT_DIR")"
+GATEWARE_DIR="$LIB_ROOT/gateware"
+TB_FILE="$SCRIPT_DIR/sim/tb_perf_datapath.v"
+TB_NAME="tb_perf_datapath"
+LOG_DIR="$SCRIPT_DIR/test_logs"
+WORK_DIR="$LOG_DIR/perf_build"
+SIM="${SIM:-iverilog}"
+
+mkdir -p "$WORK_DIR"
+
+# Standard matrix: one line of parameter overrides per run
+MATRIX=(
+    "MODE=0"
+    "MODE=0 SCLK_DOMAIN=1"
+    "MODE=1"
+    "MODE=1 BACKPRESSURE=2"
+    "MODE=1 BACKPRESSURE=3 FIFO_DEPTH=16"
+    "MODE=1 SCLK_DOMAIN=1"
+    "MODE=2"
+    "MODE=2 PREFETCH=4"
+    "MODE=2 PREFETCH=4 SCAN_SPLIT=1"
+)
+if [ $# -gt 0 ]; then
+    MATRIX=("$*")
+fi
+
+# Compile and run one configuration, output goes to stdout
+run_config() {
+    local ARGS=()
+    local P
+    for P in $1; do
+        if [ "$SIM" = "verilator" ]; then
+            ARGS+=("-G$P")
+        else
+            ARGS+=("-P$TB_NAME.$P")
+        fi
+    done
+
+    if [ "$SIM" = "verilator" ]; then
+        verilator --binary --timing -Wno-fatal -Wno-lint -Wno-style \
+            --top-module "$TB_NAME" --Mdir "$WORK_DIR/obj_dir" \
+            "${ARGS[@]}" "$TB_FILE" "$GATEWARE_DIR"/*.v > "$WORK_DIR/compile.log" 2>&1
+        "$WORK_DIR/obj_dir/V$TB_NAME"
+    else
+        iverilog -g2012 -o "$WORK_DIR/perf.vvp" -s "$TB_NAME" "${ARGS[@]}" \
+            "$TB_FILE" "$GATEWARE_DIR"/*.v > "$WORK_DIR/compile.log" 2>&1
+        vvp -n "$WORK_DIR/perf.vvp"
+    fi
+}
+
+if ! command -v "$SIM" &> /dev/null; then
+    echo "[ERROR] $SIM not found in PATH"
+    exit 1
+fi
+
+echo "========================================"
+echo "Papilio SPI Slave - Datapath Performance"
+echo "========================================"
+echo ""
+
+SUMMARY=()
+for CONFIG in "${MATRIX[@]}"; do
+    LOG="$LOG_DIR/perf_$(echo "$CONFIG" | tr ' =' '_-').log"
+    if ! run_config "$CONFIG" > "$LOG" 2>&1; then
+        cat "$WORK_DIR/compile.log" "$LOG"
+        SUMMARY+=("$(printf '%-40s %s' "$CONFIG" "build failed")")
+        continue
+    fi
+    cat "$LOG"
+    echo ""
+
+    MIN=$(sed -n 's/^Minimum working sys-clocks per SPI bit: \([0-9.]*\).*/\1/p' "$LOG")
+    MBPS=$(sed -n 's/^Sustained throughput at minimum: \([0-9.]*\).*/\1/p' "$LOG")
+    SUMMARY+=("$(printf '%-40s %8s %8s' "$CONFIG" "${MIN:--}" "${MBPS:--}")")
+done
+
+echo "========================================"
+echo "Summary"
+echo "========================================"
+printf '%-40s %8s %8s\n' "Configuration" "clk/bit" "Mbit/s"
+for LINE in "${SUMMARY[@]}"; do
+    echo "$LINE"
+done
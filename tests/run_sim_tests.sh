@@ -47,13 +47,18 @@ run_testbench() {
     
     cd "$TEST_DIR"
     
-    # Compile
+    # Example testbenches also get the example's own top.v
+    local SOURCES=("$GATEWARE_DIR"/*.v)
+    if [ -d "$TEST_DIR/../gateware" ]; then
+        SOURCES+=("$TEST_DIR/../gateware"/*.v)
+    fi
+    
+    # Compile (every library module, so any gateware edit is checked)
     echo "  Compiling..."
-    if ! iverilog -o sim.vvp \
+    if ! iverilog -g2012 -o sim.vvp -s "$TB_NAME" \
         -I"$GATEWARE_DIR" \
         "$TB_FILE" \
-        "$GATEWARE_DIR/spi_slave.v" \
-        "$GATEWARE_DIR/fifo_sync.v" \
+        "${SOURCES[@]}" \
         2>&1 | tee "$LOG_DIR/${TB_NAME}_compile.log"; then
         echo "  [FAIL] Compilation failed"
         FAILED=$((FAILED + 1))
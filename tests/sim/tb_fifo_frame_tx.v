@@ -0,0 +1,225 @@
+// Directed test: spi_slave_fifo TX frame timing (no status header)
+// Words pushed into the TX FIFO between frames must not be popped while CS
+// is high, and the next frame must return exactly those words in order,
+// starting with word 0, then filler once the FIFO is empty. Both shift
+// engines (SCLK_DOMAIN 0 and 1) run side by side on the same SPI bus.
+//
+// Run through tests/run_sim_tests.sh (prints PASS or FAIL).
+`timescale 1ns/1ps
+
+module tb_fifo_frame_tx;
+
+parameter real SYS_MHZ = 27.0;
+parameter real CLK_PER_BIT = 8.0;  // sys clocks per SPI bit
+parameter CS_SETUP = 4;            // sys clocks from CS low to the first SCLK edge
+parameter IDLE_WAIT = 200;         // sys clocks of CS high after the last push
+
+localparam MAX_WORDS = 32;
+localparam FIFO_DEPTH = 64;
+localparam FILLER = 2;             // Words clocked after the queued ones
+
+// Clock and reset
+reg clk;
+reg rst;
+real clk_half;
+
+initial begin
+    clk_half = 500.0 / SYS_MHZ;
+    clk = 0;
+    forever #(clk_half) clk = ~clk;
+end
+
+// SPI signals (one MISO per engine)
+reg spi_sclk;
+reg spi_mosi;
+reg spi_cs_n;
+wire [1:0] spi_miso;
+real bit_half;
+
+// Application pushes: push_n words of pat_tx(push_base + j)
+reg push_en;
+integer push_base;
+integer push_n;
+
+function [7:0] pat_tx;
+    input integer j;
+    pat_tx = (j * 53 + 5) & 8'hFF;
+endfunction
+
+// =========================================================================
+// Devices under test
+// =========================================================================
+genvar e;
+generate
+    for (e = 0; e < 2; e = e + 1) begin : g_eng
+        integer pushed;
+        wire tx_fifo_ready;
+        wire tx_fifo_valid = push_en && (pushed < push_n);
+        wire [$clog2(FIFO_DEPTH):0] tx_fifo_count;
+        
+        spi_slave_fifo #(
+            .TRANSFER_WIDTH(8),
+            .RX_FIFO_DEPTH(FIFO_DEPTH),
+            .TX_FIFO_DEPTH(FIFO_DEPTH),
+            .SCLK_DOMAIN(e)
+        ) dut (
+            .clk(clk), .rst_n(!rst), .app_clk(clk),
+            .spi_sclk(spi_sclk), .spi_mosi(spi_mosi),
+            .spi_miso(spi_miso[e]), .spi_cs_n(spi_cs_n),
+            .rx_fifo_data(), .rx_fifo_valid(),
+            .rx_fifo_ready(1'b1), .rx_fifo_empty(),
+            .rx_fifo_almost_full(), .rx_fifo_count(),
+            .tx_fifo_data(pat_tx(push_base + pushed)), .tx_fifo_valid(tx_fifo_valid),
+            .tx_fifo_ready(tx_fifo_ready), .tx_fifo_full(),
+            .tx_fifo_almost_empty(), .tx_fifo_count(tx_fifo_count),
+            .irq(),
+            .stats_clear(1'b0),
+            .stat_rx_overflows(), .stat_tx_underflows(),
+            .stat_rx_peak(), .stat_tx_peak()
+        );
+        
+        always @(posedge clk) begin
+            if (rst || !push_en)
+                pushed <= 0;
+            else if (tx_fifo_valid && tx_fifo_ready)
+                pushed <= pushed + 1;
+        end
+    end
+endgenerate
+
+// =========================================================================
+// SPI master (Mode 0, MISO sampled at the end of the high phase)
+// =========================================================================
+reg [7:0] miso_buf [0:1][0:MAX_WORDS-1];
+
+task spi_frame;
+    input integer n;
+    integer j, b;
+    begin
+        spi_cs_n = 0;
+        repeat (CS_SETUP) @(posedge clk);
+        for (j = 0; j < n; j = j + 1) begin
+            for (b = 7; b >= 0; b = b - 1) begin
+                spi_mosi = b[0];
+                #(bit_half) spi_sclk = 1;
+                #(bit_half);
+                miso_buf[0][j][b] = spi_miso[0];
+                miso_buf[1][j][b] = spi_miso[1];
+                spi_sclk = 0;
+            end
+        end
+        #(bit_half);
+        spi_cs_n = 1;
+    end
+endtask
+
+// =========================================================================
+// One round: queue n words between frames, read them in the next frame
+// =========================================================================
+integer errors;
+integer k_init;
+
+task check_eq;
+    input integer eng;
+    input [255:0] what;
+    input integer got;
+    input integer expected;
+    begin
+        if (got !== expected) begin
+            $display("  engine %0d: %0s got %0d, expected %0d", eng, what, got, expected);
+            errors = errors + 1;
+        end
+    end
+endtask
+
+task run_round;
+    input integer base;
+    input integer n;
+    integer j, k;
+    integer count0, count1;
+    reg [7:0] expected;
+    begin
+        push_base = base;
+        push_n = n;
+        push_en = 1;
+        while (g_eng[0].pushed < n || g_eng[1].pushed < n) @(posedge clk);
+        push_en = 0;
+        
+        // Nothing may leave the TX FIFO while CS is high
+        repeat (8) @(posedge clk);
+        count0 = g_eng[0].tx_fifo_count;
+        count1 = g_eng[1].tx_fifo_count;
+        repeat (IDLE_WAIT) @(posedge clk);
+        check_eq(0, "TX FIFO count across CS high", g_eng[0].tx_fifo_count, count0);
+        check_eq(1, "TX FIFO count across CS high", g_eng[1].tx_fifo_count, count1);
+        
+        spi_frame(n + FILLER);
+        repeat (8) @(posedge clk);
+        
+        for (k = 0; k < 2; k = k + 1) begin
+            for (j = 0; j < n + FILLER; j = j + 1) begin
+                expected = (j < n) ? pat_tx(base + j) : 8'hFF;
+                if (miso_buf[k][j] !== expected) begin
+                    $display("  engine %0d: round at %0d, word %0d got 0x%02h, expected 0x%02h",
+                             k, base, j, miso_buf[k][j], expected);
+                    errors = errors + 1;
+                end
+            end
+        end
+        check_eq(0, "TX FIFO count after the frame", g_eng[0].tx_fifo_count, 0);
+        check_eq(1, "TX FIFO count after the frame", g_eng[1].tx_fifo_count, 0);
+        repeat (16) @(posedge clk);
+    end
+endtask
+
+initial begin
+    rst = 1;
+    push_en = 0;
+    push_base = 0;
+    push_n = 0;
+    spi_cs_n = 1;
+    spi_sclk = 0;
+    spi_mosi = 0;
+    errors = 0;
+    bit_half = CLK_PER_BIT * clk_half;
+    
+    #200;
+    repeat (4) @(posedge clk);
+    rst = 0;
+    repeat (4) @(posedge clk);
+    
+    $display("=== spi_slave_fifo TX frame timing (SCLK_DOMAIN 0 and 1) ===");
+    
+    // Empty FIFO: the frame is all filler
+    spi_frame(FILLER);
+    for (k_init = 0; k_init < FILLER; k_init = k_init + 1) begin
+        if (miso_buf[0][k_init] !== 8'hFF || miso_buf[1][k_init] !== 8'hFF) begin
+            $display("  empty frame: word %0d is not filler", k_init);
+            errors = errors + 1;
+        end
+    end
+    repeat (16) @(posedge clk);
+    
+    run_round(0, 8);
+    run_round(8, 1);
+    run_round(9, 24);
+    run_round(33, 8);
+    
+    $display("");
+    if (errors == 0) begin
+        $display("PASS: queued words come back intact from word 0 of the next frame");
+        $finish(0);
+    end else begin
+        $display("FAIL: %0d mismatches", errors);
+        $finish(1);
+    end
+end
+
+// Timeout
+initial begin
+    #5000000;
+    $display("FAIL: timeout");
+    $finish(1);
+end
+
+endmodule
@@ -0,0 +1,485 @@
+// Performance Testbench for the SPI Datapath
+// Drives spi_slave, spi_slave_fifo or spi_bram_controller with bursts at a
+// falling SCLK/sys-clock ratio and reports, per datapath:
+//   - minimum working sys-clocks per SPI bit
+//   - sustained throughput (CS setup and gap included)
+//   - FIFO peak occupancy (spi_slave_fifo)
+//   - first word and cycle where data was corrupted
+//
+// Parameters (override with iverilog -Ptb_perf_datapath.<NAME>=<value>):
+//   MODE          0: spi_slave echo, 1: spi_slave_fifo, 2: spi_bram_controller
+//   SCLK_DOMAIN   spi_slave shift engine (see spi_slave.v)
+//   BURST         Data words per frame (8-bit words)
+//   FIFO_DEPTH    spi_slave_fifo RX/TX depth (power of 2)
+//   BACKPRESSURE  Application side of spi_slave_fifo: 0 always ready,
+//                 1 every 2nd clock, 2 every 4th clock, 3 pseudo-random
+//   TX_PREFILL    Words in the TX FIFO before CS falls
+//   PREFETCH      spi_bram_controller look-ahead depth
+//   SCAN_SPLIT    MODE 2: send [0xFD][ADDR][0xFE] as its own frame and read
+//                 the data in the next one (PapilioBram::beginScan()); MISO
+//                 must then not lag at all
+//   SYS_MHZ       System clock used for the throughput figures
+//   RATIO_START/RATIO_STEP/RATIO_MIN  Sweep of sys clocks per SPI bit
+//
+// The first ratio must work (it also fixes how many words MISO lags the
+// expected stream); the sweep stops at the first ratio that fails.
+// tests/run_perf_bench.sh runs the standard matrix.
+`timescale 1ns/1ps
+
+module tb_perf_datapath;
+
+parameter MODE = 1;
+parameter SCLK_DOMAIN = 0;
+parameter BURST = 256;
+parameter FIFO_DEPTH = 64;
+parameter BACKPRESSURE = 0;
+parameter TX_PREFILL = 8;
+parameter PREFETCH = 0;
+parameter SCAN_SPLIT = 0;
+parameter real SYS_MHZ = 27.0;
+parameter real RATIO_START = 16.0;
+parameter real RATIO_STEP = 0.25;
+parameter real RATIO_MIN = 2.0;
+parameter CS_SETUP = 4;            // sys clocks from CS low to the first SCLK edge
+parameter CS_GAP = 16;             // sys clocks of CS high between frames
+
+localparam SPARE = 3;              // Extra words per frame, covers the MISO lag
+localparam MAX_LAG = 3;
+localparam BRAM_DEPTH = (BURST + SPARE > 256) ? 4096 : 256;
+localparam ADDR_BYTES = ($clog2(BRAM_DEPTH) + 7) / 8;
+localparam BUF_WORDS = BURST + SPARE + ADDR_BYTES + 2;
+
+// Clock and reset
+reg clk;
+reg rst;
+real clk_half;
+integer cycle;
+
+// SPI signals
+reg spi_sclk;
+reg spi_mosi;
+wire spi_miso;
+reg spi_cs_n;
+real bit_half;
+
+// Master buffers
+reg [7:0] mosi_buf [0:BUF_WORDS-1];
+reg [7:0] miso_buf [0:BUF_WORDS-1];
+integer miso_cycle [0:BUF_WORDS-1];
+reg [7:0] exp_buf [0:BUF_WORDS-1];
+
+// Application side of spi_slave_fifo
+reg app_en;
+integer tx_pushed;
+integer rx_popped;
+reg [7:0] app_rx [0:BUF_WORDS-1];
+integer app_rx_cycle [0:BUF_WORDS-1];
+
+initial begin
+    clk_half = 500.0 / SYS_MHZ;
+    clk = 0;
+    forever #(clk_half) clk = ~clk;
+end
+
+initial cycle = 0;
+always @(posedge clk) cycle <= cycle + 1;
+
+// Backpressure pattern
+reg [15:0] lfsr;
+initial lfsr = 16'hACE1;
+always @(posedge clk) lfsr <= {lfsr[14:0], lfsr[15] ^ lfsr[13] ^ lfsr[12] ^ lfsr[10]};
+
+wire bp_ok = (BACKPRESSURE == 0) ? 1'b1 :
+             (BACKPRESSURE == 1) ? cycle[0] :
+             (BACKPRESSURE == 2) ? (cycle[1:0] == 2'b00) : lfsr[0];
+
+// Test patterns (BRAM data avoids the 0xFD-0xFF commands)
+function [7:0] pat_mosi;
+    input integer j;
+    pat_mosi = (j * 37 + 11) & 8'hFF;
+endfunction
+
+function [7:0] pat_tx;
+    input integer j;
+    pat_tx = (j * 53 + 5) & 8'hFF;
+endfunction
+
+function [7:0] pat_bram;
+    input integer j;
+    pat_bram = (j * 37 + 11) % 253;
+endfunction
+
+// =========================================================================
+// Device under test
+// =========================================================================
+wire [15:0] stat_rx_overflows;
+wire [15:0] stat_tx_underflows;
+wire [$clog2(FIFO_DEPTH):0] stat_rx_peak;
+wire [$clog2(FIFO_DEPTH):0] stat_tx_peak;
+
+generate
+    if (MODE == 0) begin : g_slave
+        wire [7:0] rx_data;
+        wire rx_valid;
+        reg [7:0] echo;
+        
+        spi_slave #(
+            .TRANSFER_WIDTH(8),
+            .SCLK_DOMAIN(SCLK_DOMAIN)
+        ) dut (
+            .clk(clk), .rst(rst),
+            .spi_sclk(spi_sclk), .spi_mosi(spi_mosi),
+            .spi_miso(spi_miso), .spi_cs_n(spi_cs_n),
+            .rx_data(rx_data), .rx_valid(rx_valid), .rx_ready(1'b1),
+            .tx_data(echo), .tx_valid(1'b1), .tx_ready(),
+            .cs_active()
+        );
+        
+        always @(posedge clk) begin
+            if (rst) echo <= 8'h00;
+            else if (rx_valid) echo <= rx_data;
+        end
+        
+        assign stat_rx_overflows = 0;
+        assign stat_tx_underflows = 0;
+        assign stat_rx_peak = 0;
+        assign stat_tx_peak = 0;
+    end else if (MODE == 1) begin : g_fifo
+        wire [7:0] rx_fifo_data;
+        wire rx_fifo_valid;
+        wire rx_fifo_ready = app_en && bp_ok;
+        wire [7:0] tx_fifo_data = pat_tx(tx_pushed);
+        wire tx_fifo_valid = app_en && bp_ok && (tx_pushed < BURST + SPARE + 1);
+        wire tx_fifo_ready;
+        
+        spi_slave_fifo #(
+            .TRANSFER_WIDTH(8),
+            .RX_FIFO_DEPTH(FIFO_DEPTH),
+            .TX_FIFO_DEPTH(FIFO_DEPTH),
+            .SCLK_DOMAIN(SCLK_DOMAIN),
+            .STATS(1)
+        ) dut (
+            .clk(clk), .rst_n(!rst), .app_clk(clk),
+            .spi_sclk(spi_sclk), .spi_mosi(spi_mosi),
+            .spi_miso(spi_miso), .spi_cs_n(spi_cs_n),
+            .rx_fifo_data(rx_fifo_data), .rx_fifo_valid(rx_fifo_valid),
+            .rx_fifo_ready(rx_fifo_ready), .rx_fifo_empty(),
+            .rx_fifo_almost_full(), .rx_fifo_count(),
+            .tx_fifo_data(tx_fifo_data), .tx_fifo_valid(tx_fifo_valid),
+            .tx_fifo_ready(tx_fifo_ready), .tx_fifo_full(),
+            .tx_fifo_almost_empty(), .tx_fifo_count(),
+            .irq(),
+            .stats_clear(1'b0),
+            .stat_rx_overflows(stat_rx_overflows),
+            .stat_tx_underflows(stat_tx_underflows),
+            .stat_rx_peak(stat_rx_peak),
+            .stat_tx_peak(stat_tx_peak)
+        );
+        
+        always @(posedge clk) begin
+            if (rst) begin
+                tx_pushed <= 0;
+                rx_popped <= 0;
+            end else begin
+                if (tx_fifo_valid && tx_fifo_ready) begin
+                    tx_pushed <= tx_pushed + 1;
+                end
+                if (rx_fifo_valid && rx_fifo_ready) begin
+                    if (rx_popped < BUF_WORDS) begin
+                        app_rx[rx_popped] <= rx_fifo_data;
+                        app_rx_cycle[rx_popped] <= cycle;
+                    end
+                    rx_popped <= rx_popped + 1;
+                end
+            end
+        end
+    end else begin : g_bram
+        wire [7:0] rx_data;
+        wire rx_valid;
+        wire rx_ready;
+        wire [7:0] tx_data;
+        wire tx_valid;
+        wire tx_ready;
+        wire cs_active;
+        
+        spi_slave #(
+            .TRANSFER_WIDTH(8),
+            .SCLK_DOMAIN(SCLK_DOMAIN)
+        ) spi (
+            .clk(clk), .rst(rst),
+            .spi_sclk(spi_sclk), .spi_mosi(spi_mosi),
+            .spi_miso(spi_miso), .spi_cs_n(spi_cs_n),
+            .rx_data(rx_data), .rx_valid(rx_valid), .rx_ready(rx_ready),
+            .tx_data(tx_data), .tx_valid(tx_valid), .tx_ready(tx_ready),
+            .cs_active(cs_active)
+        );
+        
+        spi_bram_controller #(
+            .DATA_WIDTH(8),
+            .MEM_DEPTH(BRAM_DEPTH),
+            .PREFETCH(PREFETCH)
+        ) dut (
+            .clk(clk), .rst(rst),
+            .rx_data(rx_data), .rx_valid(rx_valid), .rx_ready(rx_ready),
+            .tx_data(tx_data), .tx_valid(tx_valid), .tx_ready(tx_ready),
+            .cs_active(cs_active)
+        );
+        
+        assign stat_rx_overflows = 0;
+        assign stat_tx_underflows = 0;
+        assign stat_rx_peak = 0;
+        assign stat_tx_peak = 0;
+    end
+endgenerate
+
+// =========================================================================
+// SPI master (Mode 0, MISO sampled at the end of the high phase)
+// =========================================================================
+task spi_frame;
+    input integer n;
+    integer j, b;
+    begin
+        spi_cs_n = 0;
+        repeat (CS_SETUP) @(posedge clk);
+        for (j = 0; j < n; j = j + 1) begin
+            for (b = 7; b >= 0; b = b - 1) begin
+                spi_mosi = mosi_buf[j][b];
+                #(bit_half) spi_sclk = 1;
+                #(bit_half) miso_buf[j][b] = spi_miso;
+                spi_sclk = 0;
+            end
+            miso_cycle[j] = cycle;
+        end
+        #(bit_half);
+        spi_cs_n = 1;
+        repeat (CS_GAP) @(posedge clk);
+    end
+endtask
+
+// =========================================================================
+// One burst at the current ratio
+// =========================================================================
+integer lag;
+integer run_start;
+integer bad_word;          // First corrupted word (-1 = none)
+integer bad_cycle;
+reg [7:0] bad_got;
+reg [7:0] bad_exp;
+real frame_ns;
+
+// First k where miso_buf[base + l + k] != exp_buf[k], or -1
+function integer first_mismatch;
+    input integer base;
+    input integer l;
+    integer k;
+    begin
+        first_mismatch = -1;
+        for (k = BURST - 1; k >= 0; k = k - 1) begin
+            if (miso_buf[base + l + k] !== exp_buf[k]) first_mismatch = k;
+        end
+    end
+endfunction
+
+task note_bad;
+    input integer word;
+    input integer at;
+    input [7:0] got;
+    input [7:0] expected;
+    begin
+        if (bad_word < 0 || at < bad_cycle) begin
+            bad_word = word;
+            bad_cycle = at;
+            bad_got = got;
+            bad_exp = expected;
+        end
+    end
+endtask
+
+task run_burst;
+    integer j, n, base, k, l, wait_cycles;
+    real t0;
+    begin
+        rst = 1;
+        app_en = 0;
+        repeat (4) @(posedge clk);
+        rst = 0;
+        repeat (4) @(posedge clk);
+        run_start = cycle;
+        bad_word = -1;
+        bad_cycle = 0;
+        
+        if (MODE == 2) begin
+            // Write the block
+            mosi_buf[0] = 8'hFD;
+            for (j = 0; j < ADDR_BYTES; j = j + 1) mosi_buf[1 + j] = 8'h00;
+            for (j = 0; j < BURST + SPARE; j = j + 1) begin
+                mosi_buf[1 + ADDR_BYTES + j] = pat_bram(j);
+                exp_buf[j] = pat_bram(j);
+            end
+            spi_frame(1 + ADDR_BYTES + BURST + SPARE);
+            
+            // Read it back
+            mosi_buf[1 + ADDR_BYTES] = 8'hFE;
+            if (SCAN_SPLIT) begin
+                // Header frame on its own, D0 is loaded while CS is high
+                spi_frame(2 + ADDR_BYTES);
+                for (j = 0; j < BURST + SPARE; j = j + 1) mosi_buf[j] = 8'h00;
+                base = 0;
+            end else begin
+                for (j = 0; j < BURST + SPARE; j = j + 1) mosi_buf[2 + ADDR_BYTES + j] = 8'h00;
+                base = 2 + ADDR_BYTES;
+            end
+            n = base + BURST + SPARE;
+        end else begin
+            for (j = 0; j < BURST + SPARE; j = j + 1) begin
+                mosi_buf[j] = pat_mosi(j);
+                exp_buf[j] = (MODE == 0) ? pat_mosi(j) : pat_tx(j);
+            end
+            base = 0;
+            n = BURST + SPARE;
+        end
+        
+        if (MODE == 1) begin
+            app_en = 1;
+            wait_cycles = 0;
+            while (tx_pushed < TX_PREFILL && wait_cycles < 64 * TX_PREFILL) begin
+                @(posedge clk);
+                wait_cycles = wait_cycles + 1;
+            end
+        end
+        
+        t0 = $realtime;
+        spi_frame(n);
+        frame_ns = $realtime - t0;
+        
+        if (MODE == 1) begin
+            // Let the application drain the RX FIFO
+            wait_cycles = 0;
+            while (rx_popped < BURST && wait_cycles < 32 * FIFO_DEPTH + 256) begin
+                @(posedge clk);
+                wait_cycles = wait_cycles + 1;
+            end
+            app_en = 0;
+        end
+        
+        // First ratio: find how many words MISO trails the expected stream
+        if (lag < 0) begin
+            for (l = (MODE == 2 && SCAN_SPLIT) ? 0 : MAX_LAG; l >= 0; l = l - 1) begin
+                if (first_mismatch(base, l) < 0) lag = l;
+            end
+        end
+        
+        k = first_mismatch(base, (lag < 0) ? 0 : lag);
+        if (lag < 0 || k >= 0) begin
+            if (k < 0) k = 0;
+            l = (lag < 0) ? 0 : lag;
+            note_bad(k, miso_cycle[base + l + k] - run_start, miso_buf[base + l + k], exp_buf[k]);
+        end
+        
+        // Receive direction through the RX FIFO
+        if (MODE == 1) begin
+            for (k = BURST - 1; k >= 0; k = k - 1) begin
+                if (k >= rx_popped) begin
+                    note_bad(k, cycle - run_start, 8'hxx, pat_mosi(k));
+                end else if (app_rx[k] !== pat_mosi(k)) begin
+                    note_bad(k, app_rx_cycle[k] - run_start, app_rx[k], pat_mosi(k));
+                end
+            end
+        end
+    end
+endtask
+
+// =========================================================================
+// Ratio sweep
+// =========================================================================
+real ratio;
+real min_ratio;
+real min_mbps;
+real mbps;
+integer peak_rx;
+integer peak_tx;
+integer done;
+
+initial begin
+    rst = 1;
+    app_en = 0;
+    spi_cs_n = 1;
+    spi_sclk = 0;
+    spi_mosi = 0;
+    lag = -1;
+    min_ratio = 0.0;
+    min_mbps = 0.0;
+    peak_rx = 0;
+    peak_tx = 0;
+    
+    #200;
+    
+    $display("=== Datapath Performance: %s, SCLK_DOMAIN=%0d, BURST=%0d ===",
+             (MODE == 0) ? "spi_slave" : (MODE == 1) ? "spi_slave_fifo" : "spi_bram_controller",
+             SCLK_DOMAIN, BURST);
+    if (MODE == 1) $display("FIFO_DEPTH=%0d BACKPRESSURE=%0d TX_PREFILL=%0d",
+                            FIFO_DEPTH, BACKPRESSURE, TX_PREFILL);
+    if (MODE == 2) $display("PREFETCH=%0d SCAN_SPLIT=%0d", PREFETCH, SCAN_SPLIT);
+    $display("");
+    $display("clk/bit  Mbit/s  result");
+    
+    done = 0;
+    ratio = RATIO_START;
+    while (!done && ratio >= RATIO_MIN - 0.001) begin
+        bit_half = ratio * clk_half;
+        run_burst;
+        mbps = BURST * 8.0 * 1000.0 / frame_ns;  // Simulated time runs at SYS_MHZ
+        
+        if (bad_word < 0) begin
+            $display("%7.2f  %6.2f  ok", ratio, mbps);
+            min_ratio = ratio;
+            min_mbps = mbps;
+            if (stat_rx_peak > peak_rx) peak_rx = stat_rx_peak;
+            if (stat_tx_peak > peak_tx) peak_tx = stat_tx_peak;
+            ratio = ratio - RATIO_STEP;
+        end else begin
+            $display("%7.2f  %6.2f  corrupted: word %0d at cycle %0d (got 0x%02h, expected 0x%02h)",
+                     ratio, mbps, bad_word, bad_cycle, bad_got, bad_exp);
+            if (MODE == 1) $display("                 rx overflows %0d, tx underflows %0d",
+                                    stat_rx_overflows, stat_tx_underflows);
+            done = 1;
+        end
+    end
+    
+    $display("");
+    $display("=== Results ===");
+    if (min_ratio > 0.0) begin
+        $display("Minimum working sys-clocks per SPI bit: %0.2f (MISO lag %0d words)", min_ratio, lag);
+        $display("Sustained throughput at minimum: %0.2f Mbit/s (%0.1f MHz sys clock)", min_mbps, SYS_MHZ);
+    end
+    if (MODE == 1) $display("Peak FIFO occupancy: RX %0d / TX %0d of %0d", peak_rx, peak_tx, FIFO_DEPTH);
+    if (done) $display("First corruption: word %0d, cycle %0d after reset at %0.2f clk/bit",
+                       bad_word, bad_cycle, ratio);
+    
+    if (min_ratio > 0.0) begin
+        $display("");
+        $display("PASS: Datapath works at %0.2f clk/bit", RATIO_START);
+        $finish(0);
+    end else begin
+        $display("");
+        $display("FAIL: Datapath not working at the starting ratio");
+        $finish(1);
+    end
+end
+
+// Timeout
+initial begin
+    #(2.0e9);
+    $display("TIMEOUT: Test exceeded time limit");
+    $finish(2);
+end
+
+// Optional VCD dump for debugging
+initial begin
+    if ($test$plusargs("vcd")) begin
+        $dumpfile("tb_perf_datapath.vcd");
+        $dumpvars(0, tb_perf_datapath);
+    end
+end
+
+endmodule